@@ -0,0 +1,134 @@
+///
+/// \file BinaryCache.h
+///
+
+#ifndef BINARY_CACHE_H_
+#define BINARY_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "Device.h"
+
+namespace executor {
+
+///
+/// \class BinaryCache
+///
+/// \brief A content addressed on-disk cache of OpenCL program binaries.
+///
+/// Programs are identified by a hash of their source code, the build options
+/// and the device, driver and platform they have been built for. On a hit the
+/// stored binary is loaded with clCreateProgramWithBinary instead of invoking
+/// the driver compiler on the source code again.
+///
+/// Files are written to a temporary name first and then renamed, so that
+/// concurrent writers (threads or processes sharing the directory) never
+/// expose a partially written binary. The total size of the directory is kept
+/// below a given limit by evicting the least recently used binaries. The
+/// directory is scanned once when the cache is enabled, afterwards the size
+/// and the order of use of the entries are tracked in memory.
+///
+class BinaryCache {
+public:
+  BinaryCache();
+
+  ///
+  /// \brief Enables the cache, storing binaries in the given directory
+  ///
+  /// \param directory      The directory to store binaries in. It is created
+  ///                       if it does not exist yet.
+  ///        maxSizeInBytes The maximal total size of all stored binaries.
+  ///                       0 disables the limit.
+  ///
+  void enable(const std::string& directory, size_t maxSizeInBytes);
+
+  void disable();
+
+  bool isEnabled() const;
+
+  ///
+  /// \brief Looks up the binary for the given source and build options on the
+  ///        given device and creates a program from it
+  ///
+  /// \return The program created from the binary (not built yet), or an
+  ///         invalid program if no binary is stored
+  ///
+  cl::Program load(const Device& device,
+                   const std::string& source,
+                   const std::string& buildOptions);
+
+  ///
+  /// \brief Stores the binary of a program which has been built from the
+  ///        given source and build options on the given device
+  ///
+  void store(const Device& device,
+             const std::string& source,
+             const std::string& buildOptions,
+             const cl::Program& program);
+
+  ///
+  /// \brief Records the time spent building a program, either from a cached
+  ///        binary or from source
+  ///
+  void recordBuildTime(bool fromBinary, double milliseconds);
+
+  unsigned long hits() const;
+
+  unsigned long misses() const;
+
+  ///
+  /// \brief Returns the total time in milliseconds spent building programs
+  ///        from cached binaries
+  ///
+  double hitBuildTime() const;
+
+  ///
+  /// \brief Returns the total time in milliseconds spent building programs
+  ///        from source
+  ///
+  double missBuildTime() const;
+
+  void resetStatistics();
+
+private:
+  std::string fileName(const Device& device,
+                       const std::string& source,
+                       const std::string& buildOptions) const;
+
+  void scan();
+
+  void touch(const std::string& path, size_t size);
+
+  void evict();
+
+  struct Entry {
+    size_t                          size;
+    std::list<std::string>::iterator use;
+  };
+
+  mutable std::mutex  _mutex;
+  bool                _enabled;
+  std::string         _directory;
+  size_t              _maxSizeInBytes;
+  size_t              _totalSize;
+  // paths of the entries, the least recently used one first
+  std::list<std::string>                  _uses;
+  std::unordered_map<std::string, Entry>  _entries;
+  unsigned long       _hits;
+  unsigned long       _misses;
+  double              _hitBuildTime;
+  double              _missBuildTime;
+};
+
+extern BinaryCache globalBinaryCache;
+
+} // namespace executor
+
+#endif // BINARY_CACHE_H_
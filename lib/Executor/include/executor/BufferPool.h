@@ -0,0 +1,106 @@
+///
+/// \file BufferPool.h
+///
+
+#ifndef BUFFER_POOL_H_
+#define BUFFER_POOL_H_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+namespace executor {
+
+///
+/// \class BufferPool
+///
+/// \brief Recycles OpenCL buffers of a single device.
+///
+/// Requested sizes are rounded up to a size class: powers of two for small
+/// and medium sized buffers and multiples of a fixed slab size for large
+/// buffers. Released buffers are kept in a free list per size class and
+/// memory flags and handed out again on the next request of the same class,
+/// avoiding a clCreateBuffer/clReleaseMemObject pair for every execution.
+///
+/// The total size of idle buffers kept alive by the pool is bounded by a
+/// configurable high-water mark; buffers released beyond it are freed.
+///
+class BufferPool {
+public:
+  struct Statistics {
+    /// Bytes of all buffers allocated through the pool which are still alive
+    unsigned long bytesReserved;
+    /// Bytes requested by the buffers which are currently handed out
+    unsigned long bytesInUse;
+    /// Fraction of requests served from the free lists
+    double        hitRate;
+    /// Fraction of the capacity of handed out buffers which is not used due
+    /// to the rounding to size classes
+    double        fragmentation;
+  };
+
+  BufferPool();
+
+  ///
+  /// \brief Returns a buffer with at least sizeInBytes bytes
+  ///
+  /// \param context          The context of the device the pool belongs to
+  ///        sizeInBytes      The number of bytes requested
+  ///        flags            The memory flags of the buffer
+  ///        maxMemAllocSize  The maximal size of a single allocation on the
+  ///                         device. Size classes are never rounded above it.
+  ///
+  cl::Buffer acquire(const cl::Context& context, size_t sizeInBytes,
+                     cl_mem_flags flags, size_t maxMemAllocSize);
+
+  ///
+  /// \brief Returns a buffer previously handed out by acquire to the pool
+  ///
+  /// \param buffer       The buffer to return. If the buffer is still
+  ///                     referenced elsewhere it is not recycled.
+  ///        sizeInBytes  The number of bytes which have been requested
+  ///        flags        The memory flags the buffer has been requested with
+  ///
+  void release(const cl::Buffer& buffer, size_t sizeInBytes,
+               cl_mem_flags flags);
+
+  ///
+  /// \brief Sets the maximal number of bytes of idle buffers kept alive
+  ///
+  void setHighWaterMark(size_t bytes);
+
+  ///
+  /// \brief Frees all idle buffers
+  ///
+  void trim();
+
+  Statistics statistics() const;
+
+  static size_t sizeClass(size_t sizeInBytes, size_t maxMemAllocSize);
+
+private:
+  // the flags as plain integer, the alignment attribute of cl_mem_flags would
+  // be ignored as a template argument
+  typedef std::pair<size_t, uint64_t> key_type;
+
+  void trimTo(size_t bytes);
+
+  mutable std::mutex                            _mutex;
+  std::map<key_type, std::vector<cl::Buffer>>   _free;
+  size_t                                        _highWaterMark;
+  size_t                                        _bytesIdle;
+  size_t                                        _bytesHandedOut;
+  size_t                                        _bytesInUse;
+  unsigned long                                 _hits;
+  unsigned long                                 _misses;
+};
+
+} // namespace executor
+
+#endif // BUFFER_POOL_H_
@@ -0,0 +1,72 @@
+///
+/// \file CompilePool.h
+///
+
+#ifndef COMPILE_POOL_H_
+#define COMPILE_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace executor {
+
+///
+/// \class CompilePool
+///
+/// \brief A pool of threads building OpenCL programs in the background.
+///
+/// OpenCL allows building different program objects concurrently, so the
+/// driver compiler can run on all cores of the host while the device executes
+/// previously built kernels. The threads are started on the first submitted
+/// task.
+///
+class CompilePool {
+public:
+  CompilePool();
+
+  ~CompilePool();
+
+  ///
+  /// \brief Enqueues a task, which is run by one of the threads of the pool
+  ///
+  void submit(std::function<void()> task);
+
+  ///
+  /// \brief Sets the number of threads used for subsequent tasks. Tasks which
+  ///        have already been submitted are finished first.
+  ///
+  /// \param numThreads The number of threads, or 0 for one thread per
+  ///                   hardware thread of the host
+  ///
+  void setNumThreads(size_t numThreads);
+
+  size_t numThreads() const;
+
+  ///
+  /// \brief Finishes all submitted tasks and stops the threads
+  ///
+  void shutdown();
+
+private:
+  CompilePool(const CompilePool&);// = delete;
+  CompilePool& operator=(const CompilePool&);// = delete;
+
+  void work();
+
+  mutable std::mutex                  _mutex;
+  std::condition_variable             _condition;
+  std::deque<std::function<void()>>   _tasks;
+  std::vector<std::thread>            _threads;
+  size_t                              _numThreads;
+  bool                                _stop;
+};
+
+extern CompilePool globalCompilePool;
+
+} // namespace executor
+
+#endif // COMPILE_POOL_H_
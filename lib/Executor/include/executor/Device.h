@@ -8,15 +8,21 @@
 #define DEVICE_H_
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #define __CL_ENABLE_EXCEPTIONS
 #include <CL/cl.hpp>
 #undef  __CL_ENABLE_EXCEPTIONS
 
+#include "BufferPool.h"
+#include "StagingRing.h"
+
 namespace executor {
 
 class DeviceBuffer;
@@ -79,6 +85,9 @@ public:
   ///               kernel execution
   ///        local  The number of OpenCL Work Items to form an OpenCL Work Group
   ///        offset An Offset to the global IDs of the OpenCL Work Items
+  ///        callback If given, invoked after the kernel has finished
+  ///        waitList Events (e.g. uploads of the arguments) which have to
+  ///                 complete before the kernel starts
   ///
   /// \return An OpenCL Event object which can be used to wait for the
   ///         operation to complete
@@ -87,7 +96,9 @@ public:
                     const cl::NDRange& global,
                     const cl::NDRange& local,
                     const cl::NDRange& offset = cl::NullRange,
-                    const std::function<void()> callback = nullptr) const;
+                    const std::function<void()> callback = nullptr,
+                    const std::vector<cl::Event>& waitList
+                      = std::vector<cl::Event>()) const;
 
   ///
   /// \brief Enqueues a memory operation to copy data to the devices memory
@@ -207,6 +218,33 @@ public:
                         size_t fromOffset = 0,
                         size_t toOffset = 0) const;
 
+  ///
+  /// \brief Enqueues setting all bytes of the buffer to zero on the device,
+  ///        without transferring any data from the host
+  ///
+  /// OpenCL 1.1 has no clEnqueueFillBuffer, therefore a small kernel is
+  /// built for every device on first use.
+  ///
+  /// \param buffer The Buffer on the device which should be cleared
+  ///
+  /// \return An OpenCL Event object which can be used to wait for the
+  ///         operation to complete
+  ///
+  cl::Event enqueueClear(const DeviceBuffer& buffer) const;
+
+  ///
+  /// \brief Registers a function to be invoked once the given operation has
+  ///        completed, without enqueueing anything which could delay other
+  ///        operations of the device
+  ///
+  /// \param event    An event returned by one of the enqueue functions
+  ///        callback The function is invoked from a thread of the OpenCL
+  ///                 implementation and must not call blocking OpenCL
+  ///                 functions.
+  ///
+  void setCallback(const cl::Event& event,
+                   const std::function<void()> callback) const;
+
   ///
   /// \brief Wait for all operations enqueued to finish
   ///
@@ -219,6 +257,13 @@ public:
   ///
   id_type id() const;
 
+  ///
+  /// \brief Returns an identifier which, unlike id(), is never reused within
+  ///        the process, not even after the device list has been cleared and
+  ///        initialized again
+  ///
+  unsigned long uid() const;
+
   bool isType(Type t) const;
 
   std::string typeAsString() const;
@@ -237,6 +282,13 @@ public:
   ///
   std::string vendorName() const;
 
+  ///
+  /// \brief Returns the version of the OpenCL driver of the device as a string
+  ///
+  /// \return The version of the OpenCL driver of the device as a string
+  ///
+  std::string driverVersion() const;
+
   ///
   /// \brief Returns the maximal clock frequency of the device
   ///
@@ -312,7 +364,75 @@ public:
 
   bool isLittleEndian() const;
 
+  ///
+  /// \brief Get access to the pool recycling OpenCL buffers of this device
+  ///
+  /// \return A reference to the buffer pool of the device
+  ///
+  BufferPool& bufferPool() const;
+
+  ///
+  /// \brief Stages all following transfers of at least chunkSize bytes
+  ///        through a ring of pinned host buffers, overlapping the host copy
+  ///        of one chunk with the DMA transfer of the previous one
+  ///
+  /// \param chunkSize The size of a single pinned chunk in bytes
+  ///        numChunks The number of pinned chunks in the ring
+  ///
+  /// Staged transfers in flight on other threads finish before the ring is
+  /// replaced.
+  ///
+  void enableStaging(size_t chunkSize, size_t numChunks);
+
+  ///
+  /// \brief Transfers data directly from and to pageable host memory again
+  ///
+  void disableStaging();
+
+  bool isStagingEnabled() const;
+
+  ///
+  /// \brief Returns the throughput of the most recent upload in GB/s
+  ///
+  /// Waits for the upload to finish. The throughput is measured with the
+  /// OpenCL profiling timestamps of the transfer commands.
+  ///
+  double lastUploadThroughput() const;
+
+  ///
+  /// \brief Returns the throughput of the most recent download in GB/s
+  ///
+  /// Waits for the download to finish. The throughput is measured with the
+  /// OpenCL profiling timestamps of the transfer commands.
+  ///
+  double lastDownloadThroughput() const;
+
 private:
+  struct TransferRecord {
+    std::vector<cl::Event>  events;
+    size_t                  bytes;
+  };
+
+  bool useStaging(size_t sizeInBytes) const;
+
+  void recordTransfer(TransferRecord& record,
+                      const std::vector<cl::Event>& events,
+                      size_t bytes) const;
+
+  ///
+  /// \brief Transfers through the staging ring, returns an invalid event if
+  ///        staging has been disabled concurrently
+  ///
+  cl::Event stagedWrite(const DeviceBuffer& buffer,
+                        size_t deviceOffset,
+                        size_t sizeInBytes,
+                        const void* hostPointer) const;
+
+  cl::Event stagedRead(const DeviceBuffer& buffer,
+                       size_t deviceOffset,
+                       size_t sizeInBytes,
+                       void* hostPointer) const;
+
   cl::NDRange checkLocalSize(const cl::Kernel& kernel, cl::NDRange local) const;
 
   ///
@@ -320,10 +440,28 @@ private:
   ///
   Device();// = delete;
 
-  cl::Device        _device;
-  cl::Context       _context;
-  cl::CommandQueue  _commandQueue;
-  id_type           _id;
+  cl::Device                    _device;
+  cl::Context                   _context;
+  // kernels, clears and copies between buffers
+  cl::CommandQueue              _commandQueue;
+  // transfers from host to device
+  cl::CommandQueue              _uploadQueue;
+  // transfers from device to host, so that the uploads of the next execution
+  // do not queue up behind downloads waiting for the running kernel
+  cl::CommandQueue              _downloadQueue;
+  id_type                       _id;
+  unsigned long                 _uid;
+  mutable BufferPool            _bufferPool;
+  std::unique_ptr<StagingRing>  _stagingRing;
+  // the chunk size of _stagingRing, 0 if staging is disabled
+  std::atomic<size_t>           _stagingChunkSize;
+  mutable TransferRecord        _lastUpload;
+  mutable TransferRecord        _lastDownload;
+  mutable cl::Kernel            _clearKernel;
+  // guards _lastUpload, _lastDownload and _clearKernel
+  mutable std::mutex            _mutex;
+  // serializes transfers through the staging ring and its replacement
+  mutable std::mutex            _stagingMutex;
 };
 
 std::istream& operator>>(std::istream& stream, Device::Type& type);
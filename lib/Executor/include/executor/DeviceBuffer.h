@@ -51,6 +51,15 @@ public:
 
   bool isValid() const;
 
+  ///
+  /// \brief Returns the event of the most recently enqueued operation
+  ///        accessing the buffer. Operations enqueued in a different command
+  ///        queue have to wait for it.
+  ///
+  const cl::Event& lastAccess() const;
+
+  void setLastAccess(const cl::Event& event) const;
+
 private:
   std::string getInfo() const;
 
@@ -59,6 +68,7 @@ private:
   size_type                       _elemSize;
   cl_mem_flags                    _flags; // TODO: Needed?
   cl::Buffer                      _buffer;
+  mutable cl::Event               _lastAccess;
 };
 
 } // namespace executor
@@ -9,6 +9,7 @@
 
 #include <initializer_list>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #define __CL_ENABLE_EXCEPTIONS
@@ -55,6 +56,12 @@ public:
 
   void init(PlatformID pID, DeviceID dID);
 
+  ///
+  /// \brief Appends the given device of the given platform to the list. Every
+  ///        device gets its own context and command queues.
+  ///
+  void add(PlatformID pID, DeviceID dID);
+
   void clear();
 
   void barrier() const;
@@ -79,8 +86,35 @@ public:
 
   const_reference back() const;
 
+  ///
+  /// \brief Returns a copy of the list of devices taken under the lock, so
+  ///        that it can be iterated while other threads initialize or clear
+  ///        the list
+  ///
+  std::vector<value_type> snapshot() const;
+
+  ///
+  /// \brief Returns the device selected by the calling thread with select(),
+  ///        the first device if the thread has not selected one
+  ///
+  /// The device is returned by value, so that it stays alive while it is
+  /// used even if another thread clears the list concurrently.
+  ///
+  value_type current() const;
+
+  ///
+  /// \brief Selects the device used by all following operations of the
+  ///        calling thread. Different threads can use different devices
+  ///        concurrently.
+  ///
+  void select(size_type n) const;
+
+  size_type selected() const;
+
 private:
-  vector_type _devices;
+  // guards _devices against concurrent initialization and termination
+  mutable std::mutex  _mutex;
+  vector_type         _devices;
 };
 
 extern DeviceList globalDeviceList;
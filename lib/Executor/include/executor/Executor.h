@@ -8,14 +8,22 @@
 #ifndef EXECUTOR_H_
 #define EXECUTOR_H_
 
+#include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "BinaryCache.h"
+#include "CompilePool.h"
 #include "Core.h"
 #include "Vector.h"
 #include "DeviceList.h"
 #include "KernelArg.h"
 #include "Kernel.h"
+#include "Profile.h"
+#include "ProgramCache.h"
+#include "Statistics.h"
+#include "WorkerPool.h"
 
 std::istream& operator>>(std::istream& stream, executor::KernelArg& arg);
 
@@ -25,8 +33,85 @@ void initExecutor(int platformId, int deviceId);
 
 void initExecutor(std::string deviceType = std::string("ANY"));
 
+///
+/// \brief Initializes the executor with several devices, the ith device is
+///        given by the ith platform and device id
+///
+void initExecutor(const std::vector<int>& platformIds,
+                  const std::vector<int>& deviceIds);
+
 void shutdownExecutor();
 
+///
+/// \brief Sets the number of threads building programs in the background,
+///        or 0 for one thread per hardware thread
+///
+void setCompileThreads(unsigned long numThreads);
+
+///
+/// \brief Lets executeInWorker run kernels in up to numWorkers processes of
+///        the executor-worker executable at workerPath, each using the given
+///        platform and device. Throws an executor::WorkerError on Windows,
+///        where worker processes are not supported.
+///
+void startWorkers(const std::string& workerPath, unsigned long numWorkers,
+                  int platformId, int deviceId);
+
+void stopWorkers();
+
+///
+/// \brief Starts recording a timeline of all executor activity, keeping at
+///        most eventsPerThread events per thread (see executor::Tracer)
+///
+/// Tracing is also enabled if the environment variable LIFT_EXECUTOR_TRACE
+/// is set; the trace is then written to the path it names at shutdown.
+///
+void enableTracing(unsigned long eventsPerThread);
+
+void disableTracing();
+
+///
+/// \brief Writes the recorded timeline as Chrome trace-event JSON to path
+///
+/// \return false if the file could not be written
+///
+bool dumpTrace(const std::string& path);
+
+///
+/// \brief Starts recording the metrics which need an OpenCL event callback
+///        per command, i.e. the transfer latencies. All other metrics are
+///        always recorded.
+///
+void enableMetrics();
+
+void disableMetrics();
+
+///
+/// \brief Returns the current value of every metric of the executor (see
+///        executor::MetricsRegistry), including the statistics of the
+///        program, binary and buffer caches
+///
+std::map<std::string, double> getMetrics();
+
+///
+/// \brief Appends the metrics as a JSON line to the file at path every
+///        intervalInSeconds seconds until stopMetricsDump or shutdownExecutor
+///        is called. Enables the metrics (see enableMetrics).
+///
+void startMetricsDump(const std::string& path, double intervalInSeconds);
+
+void stopMetricsDump();
+
+///
+/// \brief Selects the device used by all following calls of the calling
+///        thread, including the getters below
+///
+void selectDevice(unsigned long index);
+
+unsigned long getSelectedDevice();
+
+unsigned long getDeviceCount();
+
 std::string getPlatformName();
 
 unsigned long getDeviceLocalMemSize();
@@ -45,6 +130,38 @@ bool supportsDouble();
 
 bool isLittleEndian();
 
+void enableBinaryCache(std::string directory, unsigned long maxSizeInBytes);
+
+void disableBinaryCache();
+
+unsigned long getBinaryCacheHits();
+
+unsigned long getBinaryCacheMisses();
+
+double getBinaryCacheHitBuildTime();
+
+double getBinaryCacheMissBuildTime();
+
+void setProgramCacheCapacity(unsigned long maxPrograms);
+
+void purgeProgramCache();
+
+unsigned long getProgramCacheHits();
+
+unsigned long getProgramCacheMisses();
+
+void setBufferPoolHighWaterMark(unsigned long bytes);
+
+executor::BufferPool::Statistics getBufferPoolStatistics();
+
+void enableStagedTransfers(unsigned long chunkSize, unsigned long numChunks);
+
+void disableStagedTransfers();
+
+double getLastUploadThroughput();
+
+double getLastDownloadThroughput();
+
 double executeKernel(cl::Kernel kernel,
                      int localSize1, int localSize2, int localSize3,
                      int globalSize1, int globalSize2, int globalSize3,
@@ -55,6 +172,66 @@ double execute(const executor::Kernel& kernel,
                int globalSize1, int globalSize2, int globalSize3,
                const std::vector<executor::KernelArg*>& args);
 
+///
+/// \brief Executes the kernel like execute and returns the profiling
+///        information of the build, all transfers and the kernel
+///
+/// Outputs are downloaded to the host before returning, so that the profile
+/// covers the whole round trip.
+///
+executor::ExecutionProfile
+  executeProfiled(const executor::Kernel& kernel,
+                  int localSize1, int localSize2, int localSize3,
+                  int globalSize1, int globalSize2, int globalSize3,
+                  const std::vector<executor::KernelArg*>& args);
+
+///
+/// \brief Uploads the arguments and enqueues the kernel and the downloads of
+///        the outputs without waiting for them to finish
+///
+/// onComplete is invoked with the kernel runtime in milliseconds and
+/// CL_SUCCESS (or 0.0 and the error status of the kernel) from a thread of
+/// the OpenCL implementation once the kernel and all transfers enqueued
+/// behind it have finished. The arguments must stay alive until then. The
+/// status is passed as int, as the alignment attribute of cl_int would be
+/// dropped in the std::function signature.
+///
+void executeAsync(const executor::Kernel& kernel,
+                  int localSize1, int localSize2, int localSize3,
+                  int globalSize1, int globalSize2, int globalSize3,
+                  const std::vector<executor::KernelArg*>& args,
+                  std::function<void(double, int)> onComplete);
+
+///
+/// \brief Executes the kernel in a worker process started by startWorkers,
+///        so that a hanging or crashing kernel can not take down the calling
+///        process
+///
+/// If the worker does not answer within deadlineInMilliseconds (0 disables
+/// the deadline) it is killed and an executor::WorkerError is thrown. The
+/// outputs are copied back into the arguments on success.
+///
+double executeInWorker(const executor::Kernel& kernel,
+                       int localSize1, int localSize2, int localSize3,
+                       int globalSize1, int globalSize2, int globalSize3,
+                       const std::vector<executor::KernelArg*>& args,
+                       double deadlineInMilliseconds);
+
+///
+/// \brief Executes the kernels one after another on the current device
+///
+/// Arguments shared between kernels, e.g. the output of one kernel bound as
+/// input of the next, stay on the device and are not transferred in between.
+/// sizes holds the three local sizes followed by the three global sizes for
+/// every kernel.
+///
+/// \return The runtime of every kernel in milliseconds
+///
+std::vector<double>
+  executePipeline(const std::vector<const executor::Kernel*>& kernels,
+                  const std::vector<int>& sizes,
+                  const std::vector<std::vector<executor::KernelArg*>>& args);
+
 void benchmark(const executor::Kernel& kernel,
                int localSize1, int localSize2, int localSize3,
                int globalSize1, int globalSize2, int globalSize3,
@@ -62,10 +239,92 @@ void benchmark(const executor::Kernel& kernel,
                int iterations, double timeout,
                std::vector<double>& runtimes);
 
+///
+/// \brief Same as benchmark, but the kernel is built and the arguments are
+///        uploaded and bound only once, so that only the NDRange is enqueued
+///        in every iteration
+///
+/// If clearOutputs is set the outputs are set to zero on the device before
+/// every iteration, as done by benchmark.
+///
+void benchmarkResident(const executor::Kernel& kernel,
+                       int localSize1, int localSize2, int localSize3,
+                       int globalSize1, int globalSize2, int globalSize3,
+                       const std::vector<executor::KernelArg*>& args,
+                       int iterations, double timeout, bool clearOutputs,
+                       std::vector<double>& runtimes);
+
+///
+/// \brief Runs the kernel until the confidence interval of its mean runtime
+///        is narrow enough, as configured by options
+///
+/// The kernel is built and the arguments are bound once, as done by
+/// benchmarkResident. Warm-up runs are not measured; outliers are not
+/// considered by the summary statistics.
+///
+executor::BenchmarkSummary
+  benchmarkAdaptive(const executor::Kernel& kernel,
+                    int localSize1, int localSize2, int localSize3,
+                    int globalSize1, int globalSize2, int globalSize3,
+                    const std::vector<executor::KernelArg*>& args,
+                    const executor::BenchmarkOptions& options);
+
+///
+/// \brief Evaluates a candidate kernel, rejecting bad candidates early
+///
+/// If sizesInjected is set, i.e. the kernel has been generated with the
+/// local and global sizes as constants and does not loop over the NDRange
+/// it is launched with, the kernel is first timed on a slab of its
+/// work-groups (a reduced NDRange) and its full runtime is extrapolated from
+/// that. If the estimate exceeds timeout or, if positive, bestRuntime (the
+/// best runtime of the candidates evaluated so far) by more than 50% no full
+/// run is performed.
+///
+/// Otherwise there is no probe, as the work of the kernel may depend on the
+/// NDRange.
+///
+/// Then the kernel is run iterations times, stopping after a run exceeding
+/// timeout.
+///
+executor::EvaluationResult
+  evaluateWithEarlyAbort(const executor::Kernel& kernel,
+                         int localSize1, int localSize2, int localSize3,
+                         int globalSize1, int globalSize2, int globalSize3,
+                         const std::vector<executor::KernelArg*>& args,
+                         int iterations, double timeout, double bestRuntime,
+                         bool sizesInjected);
+
+///
+/// \brief Evaluates a candidate kernel with evaluateWithEarlyAbort, without
+///        assuming injected sizes
+///
+/// \return The median runtime in milliseconds, the runtime of the run
+///         exceeding timeout, or -1 if the local size is too large for the
+///         kernel
+///
 double evaluate(const executor::Kernel& kernel,
                 int localSize1, int localSize2, int localSize3,
                 int globalSize1, int globalSize2, int globalSize3,
                 const std::vector<executor::KernelArg*>& args,
                 int iterations, double timeout);
 
+///
+/// \brief Evaluates many candidate kernels on the same arguments
+///
+/// The arguments are uploaded once and shared by all candidates. The
+/// candidates are built on the globalCompilePool while previously built ones
+/// are launched back-to-back on the current device. sizes holds the three
+/// local sizes followed by the three global sizes for every candidate.
+///
+/// \return For every candidate the median runtime of iterations many runs
+///         in milliseconds, the runtime of the first run exceeding timeout,
+///         or -1 if the candidate could not be built or launched with its
+///         local size
+///
+std::vector<double>
+  evaluateBatch(const std::vector<const executor::Kernel*>& kernels,
+                const std::vector<int>& sizes,
+                const std::vector<executor::KernelArg*>& args,
+                int iterations, double timeout);
+
 #endif // EXECUTOR_H_
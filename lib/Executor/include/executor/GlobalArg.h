@@ -8,6 +8,8 @@
 #ifndef GLOBAL_ARG_H_
 #define GLOBAL_ARG_H_
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "Core.h"
@@ -16,25 +18,133 @@
 
 namespace executor {
 
+class MappedFile;
+
 class GlobalArg : public KernelArg {
 public:
   static KernelArg* create(void* data, size_t sizeInBytes,
                            bool isOutput = false);
   static KernelArg* create(size_t sizeInBytes, bool isOutput = false);
 
+  ///
+  /// \brief Creates a GlobalArg transferring directly from and to memory
+  ///        owned by the caller (e.g. a direct java.nio.ByteBuffer) without
+  ///        copying it into a host vector first. The memory has to stay valid
+  ///        until the GlobalArg is destroyed.
+  ///
+  static KernelArg* createExternal(void* data, size_t sizeInBytes,
+                                   bool isOutput = false);
+
+  ///
+  /// \brief Creates an input which is uploaded straight from a memory
+  ///        mapping of length bytes of the file at path, starting at offset,
+  ///        or of the rest of the file if length is 0
+  ///
+  /// The file is read in by the page cache while it is uploaded; with staged
+  /// transfers enabled the upload is split into chunks, so that reading the
+  /// file overlaps with the transfer. Throws std::runtime_error if the file
+  /// cannot be mapped, and always on Windows.
+  ///
+  static KernelArg* createInputFromFile(const std::string& path,
+                                        size_t offset = 0, size_t length = 0);
+
+  ///
+  /// \brief Creates an output of sizeInBytes bytes, which is downloaded
+  ///        straight into a shared memory mapping of the file at path. The
+  ///        file is created or truncated and initially holds zeros.
+  ///
+  /// Throws std::runtime_error if the file cannot be mapped, and always on
+  /// Windows.
+  ///
+  static KernelArg* createOutputToFile(const std::string& path,
+                                       size_t sizeInBytes);
+
+  ///
+  /// \brief Waits for pending transfers from and into external memory
+  ///
+  ~GlobalArg();
+
   void setAsKernelArg(cl::Kernel kernel, int i);
   void upload();
+
+  ///
+  /// \brief Marks the data of an output as modified on the device. The data
+  ///        is only transferred to the host once it is accessed through
+  ///        data(), hostData() or read(). External memory is read by its
+  ///        owner directly, therefore its download is enqueued right away;
+  ///        it has finished once all enqueued operations of the device have.
+  ///
   void download();
 
   const executor::Vector<char>& data() const;
 
+  ///
+  /// \brief Returns a pointer to the up to date data on the host, regardless
+  ///        of whether the memory is owned by the GlobalArg or external
+  ///
+  const char* hostData() const;
+
+  size_t sizeInBytes() const;
+
+  ///
+  /// \brief Copies size bytes starting at offset into destination. If the
+  ///        data on the host is outdated only the requested range is
+  ///        transferred from the device.
+  ///
+  void read(size_t offset, size_t size, void* destination) const;
+
+  ///
+  /// \brief Overwrites size bytes starting at offset with the bytes from
+  ///        source. Only the written range is uploaded again, e.g. when a
+  ///        few rows are updated between launches; if the data on the host
+  ///        is outdated the range is written to the device directly.
+  ///
+  void write(size_t offset, size_t size, const void* source);
+
+  ///
+  /// \brief Replaces the whole data on the host with sizeInBytes() bytes
+  ///        from source, e.g. with results computed by another process. The
+  ///        copy on the device is uploaded again on its next use.
+  ///
+  void assign(const void* source);
+
+  bool producesOutput() const;
+
+  ///
+  /// \brief Sets an output to zero on the device, host memory is not touched
+  ///
   void clear();
+
+  void appendWaitList(std::vector<cl::Event>& waitList) const;
+
+  void accessedBy(const cl::Event& kernel);
   
 private:
   GlobalArg(executor::Vector<char>&& vectorP, bool isOutputP);
 
+  GlobalArg(char* externalDataP, size_t externalSizeP, bool isOutputP);
+
+  bool isExternal() const;
+
+  const DeviceBuffer& deviceBuffer() const;
+
+  void createDeviceBuffer();
+
+  bool hostIsUpToDate() const;
+
   executor::Vector<char> vector;
   bool isOutput;
+  // memory owned by the creator which is transferred from and to directly;
+  // vector stays empty in this case
+  char* externalData;
+  size_t externalSize;
+  executor::DeviceBuffer externalBuffer;
+  bool externalUploaded;
+  mutable bool externalHostUpToDate;
+  // pending download into the external memory
+  mutable cl::Event externalDownload;
+  // the file mapping providing the external memory, if any
+  std::unique_ptr<MappedFile> mappedFile;
 };
 
 }
@@ -7,12 +7,17 @@
 #ifndef KERNEL_H_
 #define KERNEL_H_
 
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #define __CL_ENABLE_EXCEPTIONS
 #include <CL/cl.hpp>
 #undef  __CL_ENABLE_EXCEPTIONS
 
+#include "Device.h"
 #include "JNIHandle.h"
 
 namespace executor {
@@ -23,16 +28,45 @@ public:
 
   Kernel(std::string kernelSource, std::string kernelName, std::string buildOptions);
 
+  ///
+  /// \brief Builds the kernel for the device selected by the calling thread.
+  ///        The built program is shared with all other Kernel objects with
+  ///        the same source and build options via the globalProgramCache,
+  ///        which holds separate programs for every device.
+  ///
+  /// Every call returns a new kernel object, so that threads executing the
+  /// same kernel concurrently do not overwrite each others arguments. If
+  /// the program can not be built every call throws a cl::Error by value.
+  ///
   cl::Kernel build() const;
+
+  ///
+  /// \brief Starts building the program for the device selected by the
+  ///        calling thread on the globalCompilePool and returns right away
+  ///
+  /// A later call of build() only waits for this program to be built.
+  ///
+  std::shared_future<cl::Program> buildAsync() const;
+
   std::string getSource() const;
   std::string getName() const;
   std::string getBuildOptions() const;
 
 private:
+  std::shared_future<cl::Program> program(bool inBackground) const;
+
   std::string kernelSource;
   std::string kernelName;
   std::string buildOptions;
-  mutable cl::Kernel kernel;
+  struct DeviceProgram {
+    std::weak_ptr<Device>           device;
+    std::shared_future<cl::Program> program;
+  };
+
+  // programs which are built or being built, for every device by its uid, as
+  // device ids are reused after the executor has been shut down
+  mutable std::map<unsigned long, DeviceProgram> programs;
+  mutable std::mutex programsMutex;
 };
 
 }
@@ -8,6 +8,8 @@
 #ifndef KERNEL_ARG_H_
 #define KERNEL_ARG_H_
 
+#include <vector>
+
 #include "Core.h"
 #include "JNIHandle.h"
 
@@ -19,6 +21,18 @@ public:
   virtual void upload() = 0;
   virtual void download() = 0;
   virtual void clear();
+
+  ///
+  /// \brief Appends the events a kernel using this argument has to wait for,
+  ///        e.g. the upload of its data
+  ///
+  virtual void appendWaitList(std::vector<cl::Event>& waitList) const;
+
+  ///
+  /// \brief Records the event of a kernel using this argument, later
+  ///        transfers of the argument wait for it
+  ///
+  virtual void accessedBy(const cl::Event& kernel);
 };
 
 }
@@ -21,6 +21,8 @@ public:
   void upload();
   void download();
 
+  size_t sizeInBytes() const;
+
 private:
   LocalArg(size_t sizeP);
 
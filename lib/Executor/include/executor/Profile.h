@@ -0,0 +1,99 @@
+///
+/// \file Profile.h
+///
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+namespace executor {
+
+///
+/// \brief The profiling information of a single command (or of all chunks of
+///        a staged transfer) executed on the device
+///
+struct CommandProfile {
+  enum Kind {
+    Upload   = 0,
+    Kernel   = 1,
+    Download = 2
+  };
+
+  Kind      kind;
+  /// Bytes transferred, 0 for kernels
+  size_t    bytes;
+  /// CL_PROFILING_COMMAND_* timestamps of the device in nanoseconds
+  cl_ulong  queued;
+  cl_ulong  submit;
+  cl_ulong  start;
+  cl_ulong  end;
+  /// Time in milliseconds the device was idle between the end of the
+  /// previous command and the start of this one; negative if they overlapped
+  double    gapBefore;
+};
+
+///
+/// \brief The breakdown of a single execution
+///
+struct ExecutionProfile {
+  /// Host time in milliseconds spent building (or looking up) the kernel
+  double                      buildTime;
+  /// Host time in milliseconds of the whole execution
+  double                      hostTime;
+  /// All commands of the execution ordered by their start on the device
+  std::vector<CommandProfile> commands;
+};
+
+///
+/// \class ProfileRecorder
+///
+/// \brief Records all transfers enqueued by the calling thread while it is
+///        alive, together with the kernels passed to recordKernel.
+///
+/// Recorders are thread local and can be nested; only the innermost one
+/// records.
+///
+class ProfileRecorder {
+public:
+  ProfileRecorder();
+
+  ~ProfileRecorder();
+
+  ///
+  /// \brief Invoked by the Device for every transfer. Does nothing if no
+  ///        recorder is active on the calling thread.
+  ///
+  static void recordTransfer(CommandProfile::Kind kind,
+                             const std::vector<cl::Event>& events,
+                             size_t bytes);
+
+  void recordKernel(const cl::Event& event);
+
+  ///
+  /// \brief Waits for all recorded commands and returns their profiles
+  ///        ordered by their start on the device
+  ///
+  std::vector<CommandProfile> commands() const;
+
+private:
+  struct Record {
+    CommandProfile::Kind    kind;
+    std::vector<cl::Event>  events;
+    size_t                  bytes;
+  };
+
+  ProfileRecorder(const ProfileRecorder&);// = delete;
+  ProfileRecorder& operator=(const ProfileRecorder&);// = delete;
+
+  std::vector<Record> _records;
+  ProfileRecorder*    _enclosing;
+};
+
+} // namespace executor
+
+#endif // PROFILE_H_
@@ -0,0 +1,105 @@
+///
+/// \file ProgramCache.h
+///
+
+#ifndef PROGRAM_CACHE_H_
+#define PROGRAM_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "Device.h"
+
+namespace executor {
+
+///
+/// \class ProgramCache
+///
+/// \brief A process wide, thread safe cache of built OpenCL programs.
+///
+/// Programs are identified by their source code, build options and the device
+/// they are built for. Every Kernel object (and therefore every JNI handle)
+/// shares the same cache, so that building the same source over and over
+/// again only invokes the driver compiler once. The number of cached programs
+/// is bounded; the least recently used program is released first.
+///
+class ProgramCache {
+public:
+  ProgramCache();
+
+  ///
+  /// \brief Sets the maximal number of programs kept alive by the cache.
+  ///        Programs exceeding the new capacity are released immediately.
+  ///
+  void setCapacity(size_t maxPrograms);
+
+  size_t capacity() const;
+
+  ///
+  /// \brief Returns the built program for the given source and build options
+  ///        on the given device
+  ///
+  /// \return The built program, or an invalid program if the program is not
+  ///         cached
+  ///
+  cl::Program lookup(const Device& device,
+                     const std::string& source,
+                     const std::string& buildOptions);
+
+  ///
+  /// \brief Inserts a program which has been built from the given source and
+  ///        build options on the given device
+  ///
+  void insert(const Device& device,
+              const std::string& source,
+              const std::string& buildOptions,
+              const cl::Program& program);
+
+  ///
+  /// \brief Releases all cached programs. Has to be called before the devices
+  ///        the programs are built for are destroyed.
+  ///
+  void purge();
+
+  size_t size() const;
+
+  unsigned long hits() const;
+
+  unsigned long misses() const;
+
+private:
+  struct Entry {
+    std::string key;
+    std::string source;
+    std::string buildOptions;
+    cl::Program program;
+  };
+
+  typedef std::list<Entry> list_type;
+
+  static std::string makeKey(const Device& device,
+                             const std::string& source,
+                             const std::string& buildOptions);
+
+  void shrink();
+
+  mutable std::mutex                                      _mutex;
+  size_t                                                  _capacity;
+  // most recently used entry at the front
+  list_type                                               _entries;
+  std::unordered_map<std::string, list_type::iterator>    _index;
+  unsigned long                                           _hits;
+  unsigned long                                           _misses;
+};
+
+extern ProgramCache globalProgramCache;
+
+} // namespace executor
+
+#endif // PROGRAM_CACHE_H_
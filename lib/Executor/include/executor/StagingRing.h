@@ -0,0 +1,88 @@
+///
+/// \file StagingRing.h
+///
+
+#ifndef STAGING_RING_H_
+#define STAGING_RING_H_
+
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+namespace executor {
+
+///
+/// \class StagingRing
+///
+/// \brief A ring of pinned (page-locked) host buffers used to stage transfers
+///        between pageable host memory and device buffers.
+///
+/// The chunks are allocated with CL_MEM_ALLOC_HOST_PTR and stay mapped for
+/// the lifetime of the ring, so that drivers can DMA directly from and to
+/// them. Large transfers are split into chunks; the host copy into (or out
+/// of) one chunk overlaps with the DMA transfer of the previous chunk.
+///
+class StagingRing {
+public:
+  ///
+  /// \param context        The context of the device
+  ///        uploadQueue    The command queue writes are enqueued in
+  ///        downloadQueue  The command queue reads are enqueued in
+  ///        chunkSize      The size of a single pinned chunk in bytes
+  ///        numChunks      The number of chunks in the ring (at least 2 for
+  ///                       overlapping)
+  ///
+  StagingRing(const cl::Context& context,
+              const cl::CommandQueue& uploadQueue,
+              const cl::CommandQueue& downloadQueue,
+              size_t chunkSize, size_t numChunks);
+
+  ~StagingRing();
+
+  ///
+  /// \brief Copies size bytes from hostPointer into buffer at deviceOffset
+  ///
+  /// The host memory can be reused as soon as this function returns. The
+  /// first chunk waits for the events in waitList.
+  ///
+  /// \return The events of all enqueued chunk transfers
+  ///
+  std::vector<cl::Event> write(const cl::Buffer& buffer, size_t deviceOffset,
+                               size_t size, const void* hostPointer,
+                               const std::vector<cl::Event>& waitList);
+
+  ///
+  /// \brief Copies size bytes from buffer at deviceOffset into hostPointer
+  ///
+  /// This function blocks until all data has arrived in host memory. The
+  /// first chunk waits for the events in waitList.
+  ///
+  /// \return The events of all enqueued chunk transfers
+  ///
+  std::vector<cl::Event> read(const cl::Buffer& buffer, size_t deviceOffset,
+                              size_t size, void* hostPointer,
+                              const std::vector<cl::Event>& waitList);
+
+  size_t chunkSize() const;
+
+private:
+  struct Chunk {
+    cl::Buffer  buffer;
+    void*       hostPointer;
+    cl::Event   lastUse;
+  };
+
+  StagingRing(const StagingRing&);// = delete;
+  StagingRing& operator=(const StagingRing&);// = delete;
+
+  cl::CommandQueue    _uploadQueue;
+  cl::CommandQueue    _downloadQueue;
+  size_t              _chunkSize;
+  std::vector<Chunk>  _chunks;
+};
+
+} // namespace executor
+
+#endif // STAGING_RING_H_
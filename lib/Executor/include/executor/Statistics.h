@@ -0,0 +1,94 @@
+///
+/// \file Statistics.h
+///
+
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace executor {
+
+///
+/// \brief Controls how often a kernel is run by an adaptive benchmark
+///
+struct BenchmarkOptions {
+  /// Runs performed before measuring, e.g. to warm up caches and clocks
+  int     warmupIterations;
+  /// Measured runs performed before checking for convergence
+  int     minIterations;
+  /// Upper bound of measured runs, even if the results did not converge
+  int     maxIterations;
+  /// The benchmark stops once the half width of the confidence interval of
+  /// the mean is at most this fraction of the mean
+  double  targetRelativeError;
+  /// Confidence level of the interval, e.g. 0.95
+  double  confidenceLevel;
+  /// Runs with a modified z-score (based on the median absolute deviation)
+  /// above this threshold are rejected as outliers; 0 disables rejection
+  double  outlierThreshold;
+  /// A single run taking at least this many milliseconds stops the
+  /// benchmark; 0 disables the check
+  double  timeout;
+  /// Sets the outputs to zero on the device before every run
+  bool    clearOutputs;
+
+  BenchmarkOptions();
+};
+
+///
+/// \brief Summary statistics of the runtimes of a benchmark in milliseconds,
+///        computed over all runs which are not outliers
+///
+struct BenchmarkSummary {
+  std::vector<double> runtimes;   ///< all measured runtimes in order
+  size_t  outliers;
+  double  mean;
+  double  median;
+  double  p5;
+  double  p95;
+  double  stdDev;
+  double  ciLow;                  ///< confidence interval of the mean,
+  double  ciHigh;                 ///< unbounded for less than two runs
+  bool    converged;              ///< the target relative error was reached
+
+  BenchmarkSummary();
+};
+
+///
+/// \brief The outcome of evaluating a candidate kernel with an early abort
+///
+struct EvaluationResult {
+  enum Status {
+    Completed,            ///< all runs were performed
+    Aborted,              ///< the estimate exceeded the limit, no full run
+    TimedOut,             ///< a full run exceeded the timeout
+    InvalidWorkGroupSize  ///< the local size is too large for the kernel
+  };
+
+  Status  status;
+  /// The median of all runs if completed, the runtime of the run exceeding
+  /// the timeout, or the estimate if aborted (in milliseconds)
+  double  runtime;
+  /// The full runtime extrapolated from the probe on a reduced NDRange, 0 if
+  /// the sizes are not injected and there is no probe
+  double  estimate;
+  /// The fraction of all work-groups run by the probe, 0 without a probe
+  double  probeFraction;
+  /// CL_KERNEL_PRIVATE_MEM_SIZE of the kernel in bytes
+  size_t  privateMemory;
+  std::vector<double> runtimes;   ///< all full runs in order
+
+  EvaluationResult();
+};
+
+///
+/// \brief Computes the summary statistics of the given runtimes
+///
+BenchmarkSummary summarize(const std::vector<double>& runtimes,
+                           double confidenceLevel, double outlierThreshold);
+
+} // namespace executor
+
+#endif // STATISTICS_H_
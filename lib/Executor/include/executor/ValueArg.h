@@ -23,6 +23,8 @@ public:
   void upload();
   void download();
 
+  const std::vector<char>& data() const;
+
 private:
   ValueArg(std::vector<char>&& valueP);
 
@@ -10,6 +10,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #define __CL_ENABLE_EXCEPTIONS
@@ -487,6 +488,10 @@ public:
 
   /// \brief Create buffers on the devices involved in the current distribution.
   ///
+  /// The elements reside on the device selected by the calling thread. If the
+  /// buffers have been created for a different device, the elements are
+  /// moved to the selected device through the host.
+  ///
   /// This function is a no-op if the buffers are already created. If you want
   /// to force the creation, e.g. replace existing buffers, use
   /// forceCreateDeviceBuffers()
@@ -563,6 +568,33 @@ public:
   /// \b Complexity Constant
   void dataOnHostModified() const;
 
+  /// \brief Marks the elements in the range <tt>[first, first + count)</tt>
+  ///        as modified on the host.
+  ///
+  /// The elements on the host have to be up to date. As long as the rest of
+  /// the elements on the device is up to date, the next upload only
+  /// transfers the modified ranges. If too many disjoint
+  /// ranges are marked, all elements are uploaded instead.
+  ///
+  /// \b Complexity Linear in the number of modified ranges (at most 32)
+  /// \param first Position of the first modified element
+  /// \param count Number of modified elements
+  void markDirty(size_type first, size_type count) const;
+
+  /// \brief Copies the elements in the range <tt>[first, last)</tt> to the
+  ///        Vector, starting at position \c pos, and marks them as modified
+  ///        on the host, so that only they are uploaded again.
+  ///
+  /// If the data on the host is not up to date this function will block until
+  /// the elements of the Vector are transfered from the devices to the host.
+  ///
+  /// \b Complexity Linear in distance between \c first and \c last
+  /// \param pos   Position of the first element to overwrite
+  /// \param first Begin of the range to copy the elements from
+  /// \param last  End of the range to copy the elements from
+  template <class InputIterator>
+  void update(size_type pos, InputIterator first, InputIterator last);
+
   /// \brief Returns if the elements stored on the host are up to date, or if
   ///        the elements are outdated because the elements on the devices have
   ///        been modified more recently.
@@ -603,6 +635,13 @@ public:
   ///         given device
   DeviceBuffer& deviceBuffer(const Device& device);
 
+  /// \brief Returns the buffer of the device the elements currently reside
+  ///        on. The device buffers have to be already created.
+  ///
+  /// \b Complexity Constant
+  /// \return A reference to the buffer object storing the elements
+  const DeviceBuffer& deviceBuffer() const;
+
   /// \brief Returns a reference to the underlying object storing the elements
   ///        on the host
   ///
@@ -628,6 +667,9 @@ private:
   size_type                                            _size;
   mutable bool                                        _hostBufferUpToDate;
   mutable bool                                        _deviceBuffersUpToDate;
+  // ranges [begin, end) of elements modified on the host, sorted and
+  // disjoint; empty while the devices are outdated => upload everything
+  mutable std::vector<std::pair<size_type, size_type>> _dirtyRanges;
   mutable host_buffer_type                            _hostBuffer;
   // _deviceBuffers empty => buffers not created yet
   mutable std::map<Device::id_type, DeviceBuffer>     _deviceBuffers;
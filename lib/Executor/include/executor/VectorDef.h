@@ -41,6 +41,7 @@ Vector<T>::Vector()
   : _size(0),
     _hostBufferUpToDate(true),
     _deviceBuffersUpToDate(true),
+    _dirtyRanges(),
     _hostBuffer(),
     _deviceBuffers()
 {
@@ -56,6 +57,7 @@ Vector<T>::Vector(const size_type size, const value_type& value)
   : _size(size),
     _hostBufferUpToDate(true),
     _deviceBuffersUpToDate(false),
+    _dirtyRanges(),
     _hostBuffer(size, value),
     _deviceBuffers()
 {
@@ -70,6 +72,7 @@ Vector<T>::Vector(InputIterator first, InputIterator last)
   : _size(std::distance(first, last)),
     _hostBufferUpToDate(true),
     _deviceBuffersUpToDate(false),
+    _dirtyRanges(),
     _hostBuffer(first, last),
     _deviceBuffers()
 {
@@ -83,6 +86,7 @@ Vector<T>::Vector(const Vector<T>& rhs)
   : _size(rhs._size),
     _hostBufferUpToDate(rhs._hostBufferUpToDate),
     _deviceBuffersUpToDate(rhs._deviceBuffersUpToDate),
+    _dirtyRanges(rhs._dirtyRanges),
     _hostBuffer(rhs._hostBuffer),
     _deviceBuffers(rhs._deviceBuffers)
 {
@@ -96,6 +100,7 @@ Vector<T>::Vector(Vector<T>&& rhs)
   : _size(std::move(rhs._size)),
     _hostBufferUpToDate(std::move(rhs._hostBufferUpToDate)),
     _deviceBuffersUpToDate(std::move(rhs._deviceBuffersUpToDate)),
+    _dirtyRanges(std::move(rhs._dirtyRanges)),
     _hostBuffer(std::move(rhs._hostBuffer)),
     _deviceBuffers(std::move(rhs._deviceBuffers))
 {
@@ -114,6 +119,7 @@ Vector<T>& Vector<T>::operator=(const Vector<T>& rhs)
   _size                   = rhs._size;
   _hostBufferUpToDate     = rhs._hostBufferUpToDate;
   _deviceBuffersUpToDate  = rhs._deviceBuffersUpToDate;
+  _dirtyRanges            = rhs._dirtyRanges;
   _hostBuffer             = rhs._hostBuffer;
   _deviceBuffers          = rhs._deviceBuffers;
   LOG_DEBUG_INFO("Assignment to Vector object (", this, ") now with ",
@@ -127,6 +133,7 @@ Vector<T>& Vector<T>::operator=(Vector<T>&& rhs)
   _size                   = std::move(rhs._size);
   _hostBufferUpToDate     = std::move(rhs._hostBufferUpToDate);
   _deviceBuffersUpToDate  = std::move(rhs._deviceBuffersUpToDate);
+  _dirtyRanges            = std::move(rhs._dirtyRanges);
   _hostBuffer             = std::move(rhs._hostBuffer);
   _deviceBuffers          = std::move(rhs._deviceBuffers);
   rhs._size = 0;
@@ -233,6 +240,7 @@ void Vector<T>::resize( typename Vector<T>::size_type sz, T c )
   if (_hostBufferUpToDate) {
     _hostBuffer.resize(sz, c);
     _deviceBuffersUpToDate = false;
+    _dirtyRanges.clear();
     _deviceBuffers.clear();
   }
   LOG_DEBUG_INFO("Vector object (", this, ") resized, now with ",
@@ -328,6 +336,18 @@ void Vector<T>::assign( typename Vector<T>::size_type n, const T& u )
   _hostBuffer.assign(n, u);
 }
 
+template <typename T>
+template <class InputIterator>
+void Vector<T>::update( typename Vector<T>::size_type pos,
+                        InputIterator first, InputIterator last )
+{
+  copyDataToHost();
+  auto count = static_cast<size_type>(std::distance(first, last));
+  ASSERT(pos + count <= _size);
+  std::copy(first, last, _hostBuffer.begin() + pos);
+  markDirty(pos, count);
+}
+
 template <typename T>
 void Vector<T>::push_back( const T& x )
 {
@@ -407,6 +427,17 @@ void Vector<T>::createDeviceBuffers() const
   // create device buffers only if none have been created so far
   if (_deviceBuffers.empty()) {
     forceCreateDeviceBuffers();
+    return;
+  }
+
+  // the vector is used on a different device than before, take the data
+  // along through the host
+  auto devicePtr = globalDeviceList.current();
+  if (_deviceBuffers.count(devicePtr->id()) == 0) {
+    copyDataToHost();
+    forceCreateDeviceBuffers();
+    _deviceBuffersUpToDate = false;
+    LOG_DEBUG_INFO("Moved to device ", devicePtr->id(), " (", getInfo(), ")");
   }
 }
 
@@ -416,8 +447,10 @@ void Vector<T>::forceCreateDeviceBuffers() const
   ASSERT(_size > 0);
 
   _deviceBuffers.clear();
+  // the new buffer has to be uploaded as a whole
+  _dirtyRanges.clear();
 
-  auto& devicePtr = globalDeviceList.front();
+  auto devicePtr = globalDeviceList.current();
   _deviceBuffers.insert(
       { devicePtr->id(), 
         DeviceBuffer(devicePtr, _size, sizeof(T)) });
@@ -433,14 +466,25 @@ Event Vector<T>::startUpload() const
 
   if (_deviceBuffersUpToDate) return events;
 
-  auto& devicePtr = globalDeviceList.front();
-  auto event = devicePtr->enqueueWrite(this->deviceBuffer(*devicePtr),
-                                       _hostBuffer.begin());
-  events.insert(event);
+  auto& buffer = this->deviceBuffer();
+  if (_dirtyRanges.empty()) {
+    auto event = buffer.devicePtr()->enqueueWrite(buffer, _hostBuffer.begin());
+    events.insert(event);
+  } else {
+    // only the elements modified since the last upload
+    for (auto& range : _dirtyRanges) {
+      auto event = buffer.devicePtr()->enqueueWrite(buffer, _hostBuffer.begin(),
+                                                    range.second - range.first,
+                                                    range.first, range.first);
+      events.insert(event);
+    }
+  }
 
-  _deviceBuffersUpToDate = true;
+  LOG_DEBUG_INFO("Started data upload to 1 device (", getInfo(),
+                 ", ranges: ", _dirtyRanges.size(), ")");
 
-  LOG_DEBUG_INFO("Started data upload to 1 device (", getInfo(), ")");
+  _deviceBuffersUpToDate = true;
+  _dirtyRanges.clear();
 
   return events;
 }
@@ -465,9 +509,8 @@ Event Vector<T>::startDownload() const
 
   _hostBuffer.resize(_size); // make enough room to store data
 
-  auto& devicePtr = globalDeviceList.front();
-  auto event = devicePtr->enqueueRead(this->deviceBuffer(*devicePtr),
-                                      _hostBuffer.begin());
+  auto& buffer = this->deviceBuffer();
+  auto event = buffer.devicePtr()->enqueueRead(buffer, _hostBuffer.begin());
   events.insert(event);
 
   _hostBufferUpToDate = true;
@@ -490,6 +533,7 @@ void Vector<T>::dataOnDeviceModified() const
 {
   _hostBufferUpToDate     = false;
   _deviceBuffersUpToDate  = true;
+  _dirtyRanges.clear();
   LOG_DEBUG_INFO("Data on devices marked as modified");
 }
 
@@ -498,9 +542,67 @@ void Vector<T>::dataOnHostModified() const
 {
   _hostBufferUpToDate     = true;
   _deviceBuffersUpToDate  = false;
+  _dirtyRanges.clear();
   LOG_DEBUG_INFO("Data on host marked as modified");
 }
 
+template <typename T>
+void Vector<T>::markDirty(typename Vector<T>::size_type first,
+                          typename Vector<T>::size_type count) const
+{
+  // more ranges are uploaded as a whole, as every transfer has a fixed cost
+  const size_type maxDirtyRanges = 32;
+
+  ASSERT(_hostBufferUpToDate);
+  ASSERT(first + count <= _size);
+  if (count == 0) return;
+
+  if (_deviceBuffers.empty()) {
+    // nothing on the device yet, the first upload transfers everything
+    _deviceBuffersUpToDate = false;
+    return;
+  }
+  if (_deviceBuffersUpToDate) {
+    _deviceBuffersUpToDate = false;
+    _dirtyRanges.assign(1, { first, first + count });
+    LOG_DEBUG_INFO("Elements ", first, " to ", first + count,
+                   " on host marked as modified");
+    return;
+  }
+  // all elements are uploaded anyway
+  if (_dirtyRanges.empty()) return;
+
+  // insert the range and merge it with all ranges it overlaps or touches
+  std::pair<size_type, size_type> range(first, first + count);
+  auto it = std::lower_bound(_dirtyRanges.begin(), _dirtyRanges.end(), range);
+  if (it != _dirtyRanges.begin() && std::prev(it)->second >= range.first) --it;
+  auto last = it;
+  while (last != _dirtyRanges.end() && last->first <= range.second) {
+    range.first  = std::min(range.first, last->first);
+    range.second = std::max(range.second, last->second);
+    ++last;
+  }
+  it = _dirtyRanges.erase(it, last);
+  _dirtyRanges.insert(it, range);
+
+  if (_dirtyRanges.size() > maxDirtyRanges) _dirtyRanges.clear();
+  LOG_DEBUG_INFO("Elements ", first, " to ", first + count,
+                 " on host marked as modified (", _dirtyRanges.size(),
+                 " ranges)");
+}
+
+template <typename T>
+bool Vector<T>::hostIsUpToDate() const
+{
+  return _hostBufferUpToDate;
+}
+
+template <typename T>
+bool Vector<T>::devicesAreUpToDate() const
+{
+  return _deviceBuffersUpToDate;
+}
+
 template <typename T>
 const DeviceBuffer&
   Vector<T>::deviceBuffer(const Device& device) const
@@ -514,6 +616,13 @@ DeviceBuffer& Vector<T>::deviceBuffer(const Device& device)
   return _deviceBuffers[device.id()];
 }
 
+template <typename T>
+const DeviceBuffer& Vector<T>::deviceBuffer() const
+{
+  ASSERT(!_deviceBuffers.empty());
+  return _deviceBuffers.begin()->second;
+}
+
 template <typename T>
 typename Vector<T>::host_buffer_type& Vector<T>::hostBuffer() const
 {
@@ -555,6 +664,7 @@ std::string Vector<T>::getDebugInfo() const
     << ", deviceBuffersCreated: "  << (!_deviceBuffers.empty())
     << ", hostBufferUpToDate: "    << _hostBufferUpToDate
     << ", deviceBuffersUpToDate: " << _deviceBuffersUpToDate
+    << ", dirtyRanges: "           << _dirtyRanges.size()
     << ", hostBuffer: "            << _hostBuffer.data();
   return s.str();
 }
@@ -0,0 +1,136 @@
+///
+/// \file WorkerPool.h
+///
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+#include "Kernel.h"
+#include "KernelArg.h"
+
+namespace executor {
+
+///
+/// \class WorkerError
+///
+/// \brief Thrown if a job could not be finished by a worker process, either
+///        because it exceeded its deadline or because the worker crashed,
+///        and on platforms without worker processes
+///
+class WorkerError : public std::runtime_error {
+public:
+  WorkerError(const std::string& what, bool timedOut)
+    : std::runtime_error(what), _timedOut(timedOut) {}
+
+  bool timedOut() const { return _timedOut; }
+
+private:
+  bool _timedOut;
+};
+
+#ifndef _WIN32
+
+///
+/// \class WorkerPool
+///
+/// \brief Executes kernels in separate executor-worker processes.
+///
+/// A kernel which hangs or crashes the OpenCL driver takes down the whole
+/// process it runs in. Running it in a worker process instead allows
+/// enforcing a hard deadline: a worker which does not answer in time is
+/// killed with SIGKILL and replaced by a fresh one when it is needed next.
+///
+/// Arguments are copied into a shared memory segment and outputs are copied
+/// back into the GlobalArgs once the worker has finished. The pool can be
+/// used from multiple threads; every job occupies one worker.
+///
+class WorkerPool {
+public:
+  WorkerPool();
+
+  ~WorkerPool();
+
+  ///
+  /// \brief Starts using the given worker executable. Workers are spawned on
+  ///        demand, up to numWorkers at a time.
+  ///
+  /// \param workerPath  Path of the executor-worker executable
+  ///        numWorkers  The maximal number of concurrently running workers
+  ///        platformId  The platform the workers use
+  ///        deviceId    The device the workers use
+  ///
+  void start(const std::string& workerPath, size_t numWorkers,
+             int platformId, int deviceId);
+
+  ///
+  /// \brief Terminates all idle workers. Workers which are busy with a job
+  ///        are terminated once they have finished it.
+  ///
+  void stop();
+
+  ///
+  /// \brief Executes kernel in a worker and returns the runtime measured
+  ///        there in milliseconds
+  ///
+  /// \param deadlineInMilliseconds  Wall clock time the job may take,
+  ///                                including starting a new worker and
+  ///                                building the kernel, or 0 for no
+  ///                                deadline
+  ///
+  /// Throws a WorkerError if the deadline is exceeded or the worker crashes
+  /// and a cl::Error if the kernel failed in the worker.
+  ///
+  double execute(const Kernel& kernel,
+                 int localSize1, int localSize2, int localSize3,
+                 int globalSize1, int globalSize2, int globalSize3,
+                 const std::vector<KernelArg*>& args,
+                 double deadlineInMilliseconds);
+
+  ///
+  /// \brief Returns how many workers have been killed or have died
+  ///
+  unsigned long numLostWorkers() const;
+
+private:
+  struct Worker {
+    pid_t pid;
+    int   socket;
+  };
+
+  WorkerPool(const WorkerPool&);// = delete;
+  WorkerPool& operator=(const WorkerPool&);// = delete;
+
+  Worker acquire();
+  void release(const Worker& worker);
+  // kills and reaps a worker which can not be used anymore
+  void discard(const Worker& worker);
+  Worker spawn() const;
+
+  mutable std::mutex        _mutex;
+  std::condition_variable   _condition;
+  std::vector<Worker>       _idle;
+  std::string               _workerPath;
+  size_t                    _numWorkers;
+  size_t                    _numAlive;
+  int                       _platformId;
+  int                       _deviceId;
+  unsigned long             _numLost;
+};
+
+extern WorkerPool globalWorkerPool;
+
+#endif // _WIN32
+
+} // namespace executor
+
+#endif // WORKER_POOL_H_
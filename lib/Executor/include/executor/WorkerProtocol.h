@@ -0,0 +1,85 @@
+///
+/// \file WorkerProtocol.h
+///
+/// Messages exchanged between the WorkerPool and the executor-worker
+/// processes over a stream socket. Argument data is not sent over the socket
+/// but placed in a POSIX shared memory segment named in the job.
+///
+
+#ifndef WORKER_PROTOCOL_H_
+#define WORKER_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace executor {
+
+namespace worker {
+
+const uint32_t jobMagic = 0x4c494654; // "LIFT"
+
+enum ArgKind : uint32_t {
+  ArgInput  = 0,
+  ArgOutput = 1,
+  ArgLocal  = 2,
+  ArgValue  = 3
+};
+
+///
+/// \brief Sent first for every job, followed by sourceLength bytes of kernel
+///        source, nameLength bytes of kernel name, optionsLength bytes of
+///        build options and numArgs ArgDescriptors
+///
+struct JobHeader {
+  uint32_t  magic;
+  uint32_t  sourceLength;
+  uint32_t  nameLength;
+  uint32_t  optionsLength;
+  int32_t   localSize[3];
+  int32_t   globalSize[3];
+  uint32_t  numArgs;
+  uint32_t  padding;
+  uint64_t  sharedMemorySize;
+  char      sharedMemoryName[64];
+};
+
+///
+/// \brief Describes one kernel argument. For global and value arguments the
+///        data is stored at offset in the shared memory; outputs are written
+///        back to the same location. Local arguments only have a size.
+///
+struct ArgDescriptor {
+  uint32_t  kind;
+  uint32_t  padding;
+  uint64_t  offset;
+  uint64_t  size;
+};
+
+///
+/// \brief Sent by the worker once the job has finished. status is 0 on
+///        success, otherwise the OpenCL error code.
+///
+struct JobReply {
+  int32_t   status;
+  uint32_t  padding;
+  double    runtime;
+};
+
+///
+/// \brief Reads exactly size bytes, retrying interrupted and partial reads
+///
+/// \return false if the other end has been closed or an error occurred
+///
+bool readFully(int fd, void* data, size_t size);
+
+///
+/// \brief Writes exactly size bytes, retrying interrupted and partial writes.
+///        A closed other end is reported as an error instead of SIGPIPE.
+///
+bool writeFully(int fd, const void* data, size_t size);
+
+} // namespace worker
+
+} // namespace executor
+
+#endif // WORKER_PROTOCOL_H_
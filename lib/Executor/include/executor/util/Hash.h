@@ -0,0 +1,40 @@
+///
+/// \file Hash.h
+///
+
+#ifndef HASH_H_
+#define HASH_H_
+
+#include <cstdint>
+#include <string>
+
+namespace executor {
+
+namespace util {
+
+///
+/// \brief Computes the 64 bit FNV-1a hash of the given bytes. The hash is
+///        stable across processes and platforms, which makes it suitable for
+///        naming files in an on-disk cache.
+///
+/// \param data   Pointer to the first byte to hash
+///        size   Number of bytes to hash
+///        seed   Value to start hashing with. Pass the result of a previous
+///               call to hash several pieces of data in sequence.
+///
+uint64_t hash(const void* data, size_t size,
+              uint64_t seed = 14695981039346656037ULL);
+
+uint64_t hash(const std::string& s,
+              uint64_t seed = 14695981039346656037ULL);
+
+///
+/// \brief Returns the given hash as a fixed width hexadecimal string
+///
+std::string hashToString(uint64_t hash);
+
+} // namespace util
+
+} // namespace executor
+
+#endif // HASH_H_
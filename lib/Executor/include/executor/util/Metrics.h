@@ -0,0 +1,151 @@
+///
+/// \file Metrics.h
+///
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace executor {
+
+///
+/// \class Counter
+///
+/// \brief A monotonically increasing, lock-free counter
+///
+class Counter {
+public:
+  Counter() : _value(0) {}
+
+  void add(uint64_t n = 1) { _value.fetch_add(n, std::memory_order_relaxed); }
+
+  uint64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> _value;
+};
+
+///
+/// \class Histogram
+///
+/// \brief A lock-free histogram of non-negative values with a bounded
+///        relative error, in the style of HdrHistogram.
+///
+/// Values below 16 are counted exactly. Larger values are counted in 16
+/// linear sub-buckets per power of two, so that percentiles are accurate to
+/// within about 6%.
+///
+class Histogram {
+public:
+  Histogram();
+
+  void record(uint64_t value);
+
+  uint64_t count() const;
+
+  double mean() const;
+
+  uint64_t max() const;
+
+  ///
+  /// \brief Returns the value below which the given fraction (in [0, 1]) of
+  ///        all recorded values lie
+  ///
+  double percentile(double fraction) const;
+
+private:
+  static const size_t numBuckets = 1024;
+
+  static size_t bucketOf(uint64_t value);
+  static double midpointOf(size_t bucket);
+
+  std::array<std::atomic<uint64_t>, numBuckets> _buckets;
+  std::atomic<uint64_t>                         _count;
+  std::atomic<uint64_t>                         _sum;
+  std::atomic<uint64_t>                         _max;
+};
+
+///
+/// \class MetricsRegistry
+///
+/// \brief Owns all counters, histograms and gauges of the executor.
+///
+/// Looking up a metric by name takes a lock, therefore instrumented code
+/// looks its metrics up once, e.g. into a function local static reference;
+/// updating a metric afterwards is lock-free. Gauges are functions which are
+/// evaluated when a snapshot is taken, e.g. to report the statistics of the
+/// caches.
+///
+/// Metrics which need an OpenCL event callback per command, e.g. transfer
+/// latencies, are only recorded while the registry is enabled.
+///
+class MetricsRegistry {
+public:
+  MetricsRegistry();
+
+  ~MetricsRegistry();
+
+  Counter& counter(const std::string& name);
+
+  Histogram& histogram(const std::string& name);
+
+  void gauge(const std::string& name, std::function<double()> function);
+
+  void enable() { _enabled = true; }
+
+  void disable() { _enabled = false; }
+
+  bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+  ///
+  /// \brief Returns the current value of every metric. Histograms are
+  ///        reported as <name>.count, .mean, .p50, .p90, .p99 and .max.
+  ///
+  std::map<std::string, double> snapshot() const;
+
+  ///
+  /// \brief Writes the snapshot as a single line JSON object
+  ///
+  void write(std::ostream& output) const;
+
+  ///
+  /// \brief Appends a snapshot to the file at path every intervalInSeconds
+  ///        seconds from a background thread, until stopPeriodicDump is
+  ///        called. Enables the registry.
+  ///
+  void startPeriodicDump(const std::string& path, double intervalInSeconds);
+
+  void stopPeriodicDump();
+
+private:
+  MetricsRegistry(const MetricsRegistry&);// = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&);// = delete;
+
+  mutable std::mutex                                    _mutex;
+  std::map<std::string, std::unique_ptr<Counter>>       _counters;
+  std::map<std::string, std::unique_ptr<Histogram>>     _histograms;
+  std::map<std::string, std::function<double()>>        _gauges;
+  std::atomic<bool>                                     _enabled;
+
+  std::mutex                                            _dumpMutex;
+  std::condition_variable                               _dumpCondition;
+  std::thread                                           _dumpThread;
+  bool                                                  _stopDump;
+};
+
+extern MetricsRegistry globalMetrics;
+
+} // namespace executor
+
+#endif // METRICS_H_
@@ -0,0 +1,181 @@
+///
+/// \file Trace.h
+///
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+namespace executor {
+
+///
+/// \class Tracer
+///
+/// \brief Records a timeline of host spans (compilation, buffer creation,
+///        JNI calls, ...) and device commands (uploads, kernels, downloads)
+///        which can be written as Chrome trace-event JSON, viewable in
+///        chrome://tracing or Perfetto.
+///
+/// Every thread records into its own ring buffer, so recording does not
+/// contend with other threads; once a ring is full the oldest events are
+/// overwritten. The ring of a thread is released together with its events
+/// when the thread exits. While tracing is disabled recording costs a single
+/// atomic load.
+///
+/// Device commands are recorded with their OpenCL events. Once the commands
+/// have completed, their profiling timestamps are read and the events are
+/// released; the timestamps are mapped onto the host clock by correlating the
+/// CL_PROFILING_COMMAND_QUEUED timestamp with the host time the command was
+/// enqueued at.
+///
+class Tracer {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  Tracer();
+
+  ///
+  /// \brief Starts recording, discarding previously recorded events
+  ///
+  /// \param eventsPerThread The capacity of the ring buffer of every thread
+  ///
+  void enable(size_t eventsPerThread = 65536);
+
+  void disable();
+
+  bool isEnabled() const
+  {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+
+  void recordSpan(const std::string& name, const char* category,
+                  clock::time_point begin, clock::time_point end,
+                  size_t bytes = 0);
+
+  ///
+  /// \brief Records a command spanning from the start of the first to the
+  ///        end of the last of events, which have been enqueued on device
+  ///        deviceId at the host time enqueued
+  ///
+  void recordCommand(const std::string& name, const char* category,
+                     const std::vector<cl::Event>& events,
+                     clock::time_point enqueued, unsigned deviceId,
+                     size_t bytes = 0);
+
+  ///
+  /// \brief Writes all recorded events as Chrome trace-event JSON. Device
+  ///        commands which have not finished yet are left out.
+  ///
+  void write(std::ostream& output) const;
+
+  ///
+  /// \brief Writes the trace to the file at path
+  ///
+  /// \return false if the file could not be written
+  ///
+  bool write(const std::string& path) const;
+
+private:
+  struct Event {
+    std::string             name;
+    const char*             category;
+    // host times in nanoseconds since the tracer has been constructed
+    long long               begin;
+    long long               end;
+    size_t                  bytes;
+    // device commands only, the events are released once the command has
+    // completed and begin and end hold its device times
+    std::vector<cl::Event>  deviceEvents;
+    unsigned                deviceId;
+    bool                    device;
+    // set if the profiling information of the command could not be read
+    bool                    failed;
+  };
+
+  struct ThreadBuffer {
+    std::mutex          mutex;
+    std::vector<Event>  ring;
+    size_t              next;
+    size_t              count;
+    unsigned            threadId;
+    // device commands which have not completed yet, oldest first, as their
+    // position in ring and the number of events pushed before them
+    std::deque<std::pair<size_t, unsigned long long>> pending;
+    unsigned long long  pushed;
+  };
+
+  Tracer(const Tracer&);// = delete;
+  Tracer& operator=(const Tracer&);// = delete;
+
+  ThreadBuffer& threadBuffer();
+  void push(Event&& event);
+  static void resolvePending(ThreadBuffer& buffer);
+  static bool resolve(Event& event);
+  long long sinceStart(clock::time_point time) const;
+
+  std::atomic<bool>                         _enabled;
+  size_t                                    _capacity;
+  clock::time_point                         _start;
+  mutable std::mutex                        _mutex;
+  // the rings are owned by their threads and released when these exit
+  std::vector<std::weak_ptr<ThreadBuffer>>  _buffers;
+  unsigned                                  _nextThreadId;
+};
+
+extern Tracer globalTracer;
+
+///
+/// \class TraceSpan
+///
+/// \brief Records a host span from its construction to its destruction
+///
+class TraceSpan {
+public:
+  TraceSpan(const char* name, const char* category, size_t bytes = 0)
+    : _name(name), _category(category), _bytes(bytes),
+      _active(globalTracer.isEnabled()),
+      _begin(_active ? Tracer::clock::now() : Tracer::clock::time_point())
+  {
+  }
+
+  ~TraceSpan()
+  {
+    if (_active) {
+      globalTracer.recordSpan(_name, _category, _begin, Tracer::clock::now(),
+                              _bytes);
+    }
+  }
+
+private:
+  TraceSpan(const TraceSpan&);// = delete;
+  TraceSpan& operator=(const TraceSpan&);// = delete;
+
+  const char*               _name;
+  const char*               _category;
+  size_t                    _bytes;
+  bool                      _active;
+  Tracer::clock::time_point _begin;
+};
+
+} // namespace executor
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#define TRACE_SPAN(name, category)\
+  executor::TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name, category)
+
+#endif // TRACE_H_
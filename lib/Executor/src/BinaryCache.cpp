@@ -0,0 +1,399 @@
+///
+/// \file BinaryCache.cpp
+///
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "util/Hash.h"
+#include "util/Logger.h"
+
+#include "BinaryCache.h"
+#include "Device.h"
+
+namespace {
+
+const char     magic[8]   = { 'L', 'I', 'F', 'T', 'B', 'I', 'N', '1' };
+const uint64_t checkSeed  = 0x9e3779b97f4a7c15ULL;
+const char*    suffix     = ".bin";
+
+uint64_t hashKey(const executor::Device& device,
+                 const std::string& source,
+                 const std::string& buildOptions,
+                 uint64_t seed)
+{
+  using executor::util::hash;
+  auto platform = device.clPlatform();
+  auto h = hash(source, seed);
+  h = hash(buildOptions, h);
+  h = hash(device.name(), h);
+  h = hash(device.driverVersion(), h);
+  h = hash(platform.getInfo<CL_PLATFORM_NAME>(), h);
+  h = hash(platform.getInfo<CL_PLATFORM_VERSION>(), h);
+  return h;
+}
+
+#ifndef _WIN32
+
+bool makeDirectories(const std::string& path)
+{
+  size_t pos = 0;
+  do {
+    pos = path.find('/', pos + 1);
+    auto prefix = path.substr(0, pos);
+    if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) return false;
+  } while (pos != std::string::npos);
+  return true;
+}
+
+struct CacheEntry {
+  std::string path;
+  size_t      size;
+  time_t      lastUse;
+};
+
+// temporary files older than this are left behind by crashed writers
+const time_t staleTmpAgeInSeconds = 10 * 60;
+
+std::vector<CacheEntry> listEntries(const std::string& directory)
+{
+  std::vector<CacheEntry> entries;
+  auto dir = opendir(directory.c_str());
+  if (dir == nullptr) return entries;
+
+  const size_t suffixLength = std::strlen(suffix);
+  const auto now = time(nullptr);
+  while (auto entry = readdir(dir)) {
+    std::string name(entry->d_name);
+    auto path = directory + "/" + name;
+    bool isTmp = name.find(".tmp.") != std::string::npos;
+    if (!isTmp
+        && (name.size() <= suffixLength
+            || name.compare(name.size() - suffixLength, suffixLength,
+                            suffix) != 0)) {
+      continue;
+    }
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) continue; // removed concurrently
+    if (isTmp) {
+      // recent ones might still be written by a concurrent writer
+      if (now - info.st_mtime > staleTmpAgeInSeconds) {
+        std::remove(path.c_str());
+      }
+      continue;
+    }
+    entries.push_back({ path, static_cast<size_t>(info.st_size),
+                        info.st_mtime });
+  }
+  closedir(dir);
+  return entries;
+}
+
+#endif // _WIN32
+
+} // namespace
+
+namespace executor {
+
+BinaryCache globalBinaryCache;
+
+BinaryCache::BinaryCache()
+  : _mutex(), _enabled(false), _directory(), _maxSizeInBytes(0),
+    _totalSize(0), _uses(), _entries(), _hits(0), _misses(0), _hitBuildTime(0.0), _missBuildTime(0.0)
+{
+}
+
+void BinaryCache::enable(const std::string& directory, size_t maxSizeInBytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+#ifdef _WIN32
+  (void)directory; (void)maxSizeInBytes;
+  LOG_WARNING("The program binary cache is not supported on this platform");
+#else
+  if (!::makeDirectories(directory)) {
+    LOG_WARNING("Could not create binary cache directory `", directory,
+                "': ", std::strerror(errno));
+    return;
+  }
+  _enabled        = true;
+  _directory      = directory;
+  _maxSizeInBytes = maxSizeInBytes;
+  scan();
+  LOG_INFO("Using program binary cache in `", _directory, "' (",
+           _entries.size(), " binaries, ", _totalSize, " bytes, limit: ",
+           _maxSizeInBytes, " bytes)");
+  evict();
+#endif
+}
+
+void BinaryCache::disable()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _enabled = false;
+}
+
+bool BinaryCache::isEnabled() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _enabled;
+}
+
+std::string BinaryCache::fileName(const Device& device,
+                                  const std::string& source,
+                                  const std::string& buildOptions) const
+{
+  auto h = ::hashKey(device, source, buildOptions,
+                     14695981039346656037ULL);
+  return _directory + "/" + util::hashToString(h) + suffix;
+}
+
+cl::Program BinaryCache::load(const Device& device,
+                              const std::string& source,
+                              const std::string& buildOptions)
+{
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_enabled) return cl::Program();
+    path = fileName(device, source, buildOptions);
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return cl::Program();
+
+  char     fileMagic[sizeof(magic)];
+  uint64_t check = 0;
+  uint64_t size  = 0;
+  file.read(fileMagic, sizeof(fileMagic));
+  file.read(reinterpret_cast<char*>(&check), sizeof(check));
+  file.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (!file || std::memcmp(fileMagic, magic, sizeof(magic)) != 0
+      || check != ::hashKey(device, source, buildOptions, checkSeed)) {
+    LOG_WARNING("Ignoring invalid or colliding binary cache entry `", path,
+                "'");
+    return cl::Program();
+  }
+
+  std::vector<char> binary(size);
+  file.read(binary.data(), static_cast<std::streamsize>(size));
+  if (!file) {
+    LOG_WARNING("Ignoring truncated binary cache entry `", path, "'");
+    return cl::Program();
+  }
+
+#ifndef _WIN32
+  // mark as recently used for the LRU eviction, also for other processes
+  utime(path.c_str(), nullptr);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_enabled && path.compare(0, _directory.size(), _directory) == 0) {
+      touch(path, static_cast<size_t>(file.tellg()));
+    }
+  }
+#endif
+
+  try {
+    cl::Program::Binaries binaries(1, std::make_pair(
+        static_cast<const void*>(binary.data()), binary.size()));
+    return cl::Program(device.clContext(),
+                       std::vector<cl::Device>(1, device.clDevice()),
+                       binaries);
+  } catch (cl::Error& err) {
+    // e.g. the driver has been updated without changing its version string
+    LOG_WARNING("Could not create program from cached binary `", path, "' (",
+                err, ")");
+    std::remove(path.c_str());
+    return cl::Program();
+  }
+}
+
+void BinaryCache::store(const Device& device,
+                        const std::string& source,
+                        const std::string& buildOptions,
+                        const cl::Program& program)
+{
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_enabled) return;
+    path = fileName(device, source, buildOptions);
+  }
+
+  // the program is built for a single device, so there is a single binary
+  size_t size = 0;
+  auto err = clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES,
+                              sizeof(size), &size, nullptr);
+  if (err != CL_SUCCESS || size == 0) {
+    LOG_WARNING("Could not query program binary size (",
+                logger_impl::getErrorString(err), ")");
+    return;
+  }
+  std::vector<char> binary(size);
+  auto binaryPtr = binary.data();
+  err = clGetProgramInfo(program(), CL_PROGRAM_BINARIES,
+                         sizeof(binaryPtr), &binaryPtr, nullptr);
+  if (err != CL_SUCCESS) {
+    LOG_WARNING("Could not query program binary (",
+                logger_impl::getErrorString(err), ")");
+    return;
+  }
+
+#ifndef _WIN32
+  // write into a file only visible to this writer and publish it atomically
+  static std::atomic<unsigned long> counter(0);
+  std::ostringstream tmpPath;
+  tmpPath << path << ".tmp." << getpid() << "." << counter++;
+
+  {
+    std::ofstream file(tmpPath.str(), std::ios::binary | std::ios::trunc);
+    uint64_t check = ::hashKey(device, source, buildOptions, checkSeed);
+    uint64_t binarySize = size;
+    file.write(magic, sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&check), sizeof(check));
+    file.write(reinterpret_cast<const char*>(&binarySize),
+               sizeof(binarySize));
+    file.write(binary.data(), static_cast<std::streamsize>(size));
+    if (!file) {
+      LOG_WARNING("Could not write binary cache entry `", tmpPath.str(), "'");
+      file.close();
+      std::remove(tmpPath.str().c_str());
+      return;
+    }
+  }
+
+  if (std::rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+    LOG_WARNING("Could not publish binary cache entry `", path, "': ",
+                std::strerror(errno));
+    std::remove(tmpPath.str().c_str());
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_enabled || path.compare(0, _directory.size(), _directory) != 0) {
+    return; // disabled or moved to another directory in the meantime
+  }
+  touch(path, sizeof(magic) + 2 * sizeof(uint64_t) + size);
+  evict();
+#endif
+}
+
+void BinaryCache::scan()
+{
+#ifndef _WIN32
+  _totalSize = 0;
+  _uses.clear();
+  _entries.clear();
+
+  auto entries = ::listEntries(_directory);
+  std::sort(entries.begin(), entries.end(),
+            [](const CacheEntry& lhs, const CacheEntry& rhs) {
+              return lhs.lastUse < rhs.lastUse;
+            });
+  for (auto& e : entries) touch(e.path, e.size);
+#endif
+}
+
+void BinaryCache::touch(const std::string& path, size_t size)
+{
+  auto it = _entries.find(path);
+  if (it == _entries.end()) {
+    _uses.push_back(path);
+    _entries.insert({ path, Entry{ size, std::prev(_uses.end()) } });
+  } else {
+    // the entry might have been replaced by another writer
+    _totalSize -= it->second.size;
+    it->second.size = size;
+    _uses.splice(_uses.end(), _uses, it->second.use);
+  }
+  _totalSize += size;
+}
+
+void BinaryCache::evict()
+{
+#ifndef _WIN32
+  if (_maxSizeInBytes == 0) return;
+
+  size_t evicted = 0;
+  while (_totalSize > _maxSizeInBytes && !_uses.empty()) {
+    auto it = _entries.find(_uses.front());
+    // another process might have evicted the entry already, which is fine
+    std::remove(it->first.c_str());
+    _totalSize -= it->second.size;
+    _entries.erase(it);
+    _uses.pop_front();
+    ++evicted;
+  }
+  if (evicted > 0) {
+    LOG_DEBUG_INFO("Evicted ", evicted, " program binaries from the cache");
+  }
+#endif
+}
+
+void BinaryCache::recordBuildTime(bool fromBinary, double milliseconds)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (fromBinary) {
+    ++_hits;
+    _hitBuildTime += milliseconds;
+  } else {
+    ++_misses;
+    _missBuildTime += milliseconds;
+  }
+}
+
+unsigned long BinaryCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _hits;
+}
+
+unsigned long BinaryCache::misses() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _misses;
+}
+
+double BinaryCache::hitBuildTime() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _hitBuildTime;
+}
+
+double BinaryCache::missBuildTime() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _missBuildTime;
+}
+
+void BinaryCache::resetStatistics()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _hits           = 0;
+  _misses         = 0;
+  _hitBuildTime   = 0.0;
+  _missBuildTime  = 0.0;
+}
+
+} // namespace executor
@@ -0,0 +1,157 @@
+///
+/// \file BufferPool.cpp
+///
+
+#include <mutex>
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "util/Logger.h"
+#include "util/Metrics.h"
+#include "util/Trace.h"
+
+#include "BufferPool.h"
+
+namespace {
+
+// smallest size class handed out
+const size_t minSize  = 256;
+// sizes up to this are rounded to the next power of two, larger sizes to a
+// multiple of it
+const size_t slabSize = 16 * 1024 * 1024;
+
+} // namespace
+
+namespace executor {
+
+BufferPool::BufferPool()
+  : _mutex(), _free(), _highWaterMark(256 * 1024 * 1024), _bytesIdle(0),
+    _bytesHandedOut(0), _bytesInUse(0), _hits(0), _misses(0)
+{
+}
+
+size_t BufferPool::sizeClass(size_t sizeInBytes, size_t maxMemAllocSize)
+{
+  size_t size;
+  if (sizeInBytes <= slabSize) {
+    size = minSize;
+    while (size < sizeInBytes) size <<= 1;
+  } else {
+    size = ((sizeInBytes + slabSize - 1) / slabSize) * slabSize;
+  }
+  // never round a valid request into an invalid allocation
+  if (size > maxMemAllocSize) size = sizeInBytes;
+  return size;
+}
+
+cl::Buffer BufferPool::acquire(const cl::Context& context, size_t sizeInBytes,
+                               cl_mem_flags flags, size_t maxMemAllocSize)
+{
+  auto size = sizeClass(sizeInBytes, maxMemAllocSize);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _free.find(key_type(size, flags));
+    if (it != _free.end() && !it->second.empty()) {
+      auto buffer = std::move(it->second.back());
+      it->second.pop_back();
+      _bytesIdle      -= size;
+      _bytesHandedOut += size;
+      _bytesInUse     += sizeInBytes;
+      ++_hits;
+      return buffer;
+    }
+    ++_misses;
+  }
+
+  static auto& allocations = globalMetrics.counter("buffer.allocations");
+  static auto& allocatedBytes = globalMetrics.counter("buffer.allocation.bytes");
+  allocations.add();
+  allocatedBytes.add(size);
+
+  TraceSpan span("buffer create", "memory", size);
+  cl::Buffer buffer;
+  try {
+    buffer = cl::Buffer(context, flags, size);
+  } catch (cl::Error& err) {
+    // the device might run out of memory because of idle buffers
+    if (err.err() != CL_MEM_OBJECT_ALLOCATION_FAILURE
+        && err.err() != CL_OUT_OF_RESOURCES) {
+      throw;
+    }
+    LOG_WARNING("Allocation of ", size, " bytes failed, releasing idle "
+                "buffers and retrying");
+    trim();
+    buffer = cl::Buffer(context, flags, size);
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _bytesHandedOut += size;
+  _bytesInUse     += sizeInBytes;
+  return buffer;
+}
+
+void BufferPool::release(const cl::Buffer& buffer, size_t sizeInBytes,
+                         cl_mem_flags flags)
+{
+  auto size     = buffer.getInfo<CL_MEM_SIZE>();
+  auto refCount = buffer.getInfo<CL_MEM_REFERENCE_COUNT>();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _bytesHandedOut -= size;
+  _bytesInUse     -= sizeInBytes;
+
+  // still referenced elsewhere (e.g. by a copy of the cl::Buffer object), so
+  // the memory can not be handed out again
+  if (refCount > 1) return;
+
+  if (size > _highWaterMark) return;
+  trimTo(_highWaterMark - size);
+
+  _free[key_type(size, flags)].push_back(buffer);
+  _bytesIdle += size;
+}
+
+void BufferPool::setHighWaterMark(size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _highWaterMark = bytes;
+  trimTo(_highWaterMark);
+}
+
+void BufferPool::trim()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  trimTo(0);
+}
+
+void BufferPool::trimTo(size_t bytes)
+{
+  // free the largest buffers first, they are the least likely to be reused
+  auto it = _free.end();
+  while (_bytesIdle > bytes && it != _free.begin()) {
+    --it;
+    auto& buffers = it->second;
+    while (_bytesIdle > bytes && !buffers.empty()) {
+      buffers.pop_back();
+      _bytesIdle -= it->first.first;
+    }
+  }
+}
+
+BufferPool::Statistics BufferPool::statistics() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  Statistics s;
+  s.bytesReserved = _bytesIdle + _bytesHandedOut;
+  s.bytesInUse    = _bytesInUse;
+  s.hitRate       = (_hits + _misses) == 0
+                  ? 0.0 : static_cast<double>(_hits) / (_hits + _misses);
+  s.fragmentation = _bytesHandedOut == 0
+                  ? 0.0 : 1.0 - static_cast<double>(_bytesInUse) / _bytesHandedOut;
+  return s;
+}
+
+} // namespace executor
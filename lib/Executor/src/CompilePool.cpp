@@ -0,0 +1,90 @@
+///
+/// \file CompilePool.cpp
+///
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util/Logger.h"
+
+#include "CompilePool.h"
+
+namespace executor {
+
+CompilePool globalCompilePool;
+
+CompilePool::CompilePool()
+  : _mutex(), _condition(), _tasks(), _threads(), _numThreads(0),
+    _stop(false)
+{
+}
+
+CompilePool::~CompilePool()
+{
+  shutdown();
+}
+
+void CompilePool::submit(std::function<void()> task)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_threads.empty()) {
+    auto n = _numThreads != 0
+           ? _numThreads
+           : std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < n; ++i) {
+      _threads.emplace_back(&CompilePool::work, this);
+    }
+    LOG_DEBUG_INFO("Started ", n, " compile threads");
+  }
+  _tasks.push_back(std::move(task));
+  _condition.notify_one();
+}
+
+void CompilePool::setNumThreads(size_t numThreads)
+{
+  shutdown();
+  std::lock_guard<std::mutex> lock(_mutex);
+  _numThreads = numThreads;
+}
+
+size_t CompilePool::numThreads() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _numThreads;
+}
+
+void CompilePool::shutdown()
+{
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+    threads.swap(_threads);
+  }
+  _condition.notify_all();
+  for (auto& thread : threads) thread.join();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _stop = false;
+}
+
+void CompilePool::work()
+{
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] { return _stop || !_tasks.empty(); });
+      // the remaining tasks are finished before stopping
+      if (_tasks.empty()) return;
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+    task();
+  }
+}
+
+} // namespace executor
@@ -4,11 +4,17 @@
 /// \author Michel Steuwer <michel.steuwer@ed.ac.uk>
 ///
 
+#include <cstdlib>
+
 #include "util/Logger.h"
+#include "util/Metrics.h"
+#include "util/Trace.h"
 
 #include "Core.h"
 
 #include "DeviceList.h"
+#include "CompilePool.h"
+#include "ProgramCache.h"
 #include "DeviceProperties.h"
 #include "PlatformID.h"
 #include "DeviceID.h"
@@ -47,6 +53,17 @@ DeviceID device(size_t dID)
 
 void terminate()
 {
+  // the dump reads the statistics of the devices which are released below
+  globalMetrics.stopPeriodicDump();
+  // finish background builds before their programs and contexts are released
+  globalCompilePool.shutdown();
+  // cached programs must not outlive the contexts they are built in
+  globalProgramCache.purge();
+  // events of a trace requested via the environment have to be resolved
+  // while their devices are still alive
+  if (auto tracePath = std::getenv("LIFT_EXECUTOR_TRACE")) {
+    globalTracer.write(tracePath);
+  }
   globalDeviceList.clear();
   LOG_INFO("Executor terminating. Freeing all resources.");
 }
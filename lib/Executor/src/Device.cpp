@@ -4,11 +4,18 @@
 /// \author Michel Steuwer <michel.steuwer@ed.ac.uk>
 ///
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <stdexcept>
 #include <algorithm>
 #include <sstream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #define __CL_ENABLE_EXCEPTIONS
 #include <CL/cl.hpp>
@@ -16,8 +23,12 @@
 
 #include "util/Assert.h"
 #include "util/Logger.h"
+#include "util/Metrics.h"
+#include "util/Trace.h"
 #include "Device.h"
 #include "DeviceBuffer.h"
+#include "Profile.h"
+#include "StagingRing.h"
 
 namespace {
 
@@ -36,6 +47,33 @@ std::string printNDRange(const cl::NDRange& range)
   return s.str();
 }
 
+// A transfer, possibly split into several commands, whose latency is
+// recorded once its last command has completed
+struct TransferLatency {
+  executor::Histogram*  histogram;
+  cl::Event             first;
+};
+
+// Records the latency from enqueueing the first command of a transfer until
+// completion of its last command (event) into the histogram of the
+// TransferLatency given as user data
+void recordLatency(cl_event event, cl_int status, void* userData)
+{
+  std::unique_ptr<TransferLatency> transfer(
+                                    static_cast<TransferLatency*>(userData));
+  if (status != CL_COMPLETE) return;
+  cl_ulong queued;
+  cl_ulong end;
+  if (clGetEventProfilingInfo(transfer->first(), CL_PROFILING_COMMAND_QUEUED,
+                              sizeof(queued), &queued, NULL) != CL_SUCCESS
+      || clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END,
+                                 sizeof(end), &end, NULL) != CL_SUCCESS
+      || end < queued) {
+    return;
+  }
+  transfer->histogram->record((end - queued) / 1000);
+}
+
 void invokeCallback(cl_event /*event*/, cl_int status, void * userData)
 {
   auto callback = static_cast<std::function<void()>*>(userData);
@@ -47,6 +85,56 @@ void invokeCallback(cl_event /*event*/, cl_int status, void * userData)
   }
 }
 
+// Returns the throughput in GB/s of a transfer of bytes split into the given
+// commands, measured from the start of the first to the end of the last one
+double throughput(const std::vector<cl::Event>& events, size_t bytes)
+{
+  if (events.empty()) return 0.0;
+  try {
+    // plain integers, std::min<cl_ulong> would drop its alignment attribute
+    uint64_t start = std::numeric_limits<uint64_t>::max();
+    uint64_t end   = 0;
+    for (auto& event : events) {
+      event.wait();
+      start = std::min<uint64_t>(start,
+                event.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+      end   = std::max<uint64_t>(end,
+                event.getProfilingInfo<CL_PROFILING_COMMAND_END>());
+    }
+    if (end <= start) return 0.0;
+    return static_cast<double>(bytes) / static_cast<double>(end - start);
+  } catch (cl::Error& err) {
+    LOG_ERROR(err);
+    return 0.0;
+  }
+}
+
+// Every work item clears 16 bytes, the last one handles the remaining bytes
+// if the size is not a multiple of 16
+const char* clearKernelSource = R"(
+__kernel void executor_clear(__global uchar* buffer, ulong size)
+{
+  ulong i = get_global_id(0) * 16;
+  if (i + 16 <= size) {
+    vstore4((uint4)(0), 0, (__global uint*)(buffer + i));
+  } else {
+    for (; i < size; ++i) buffer[i] = 0;
+  }
+}
+)";
+
+// source of Device::uid()
+std::atomic<unsigned long> nextUid(0);
+
+// Operations on a buffer have to wait for the previous access, which might
+// have been enqueued in a different command queue
+std::vector<cl::Event> waitListFor(const executor::DeviceBuffer& buffer)
+{
+  std::vector<cl::Event> waitList;
+  if (buffer.lastAccess()() != nullptr) waitList.push_back(buffer.lastAccess());
+  return waitList;
+}
+
 } // namespace
 
 namespace executor {
@@ -54,7 +142,11 @@ namespace executor {
 Device::Device(const cl::Device& device,
                const cl::Platform& platform,
                const Device::id_type id)
-  : _device(device), _context(), _commandQueue(), _id(id)
+  : _device(device), _context(), _commandQueue(), _uploadQueue(),
+    _downloadQueue(), _id(id), _uid(::nextUid++),
+    _bufferPool(),
+    _stagingRing(), _stagingChunkSize(0), _lastUpload(), _lastDownload(), _clearKernel(),
+    _mutex(), _stagingMutex()
 {
   try {
     VECTOR_CLASS<cl::Device> devices(1, _device);
@@ -70,6 +162,14 @@ Device::Device(const cl::Device& device,
     // create command queue for every device
     _commandQueue = cl::CommandQueue(_context, _device,
                                      CL_QUEUE_PROFILING_ENABLE);
+
+    // transfers in either direction are enqueued separately, so that the
+    // uploads and downloads of one execution can overlap with the kernel of
+    // another
+    _uploadQueue = cl::CommandQueue(_context, _device,
+                                    CL_QUEUE_PROFILING_ENABLE);
+    _downloadQueue = cl::CommandQueue(_context, _device,
+                                      CL_QUEUE_PROFILING_ENABLE);
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
@@ -106,7 +206,8 @@ cl::Event Device::enqueue(const cl::Kernel& kernel,
                           const cl::NDRange& global,
                           const cl::NDRange& local,
                           const cl::NDRange& offset,
-                          const std::function<void()> callback) const
+                          const std::function<void()> callback,
+                          const std::vector<cl::Event>& waitList) const
 {
   ASSERT(global.dimensions() == local.dimensions());
 #pragma GCC diagnostic push
@@ -123,24 +224,31 @@ cl::Event Device::enqueue(const cl::Kernel& kernel,
 #pragma GCC diagnostic pop
   ASSERT(globalSizeIsDivisiableByLocalSize());
 
+  static auto& launches = globalMetrics.counter("kernel.launches");
+  static auto& enqueueTime = globalMetrics.histogram("kernel.enqueue_us");
+
   cl::Event event;
+  auto enqueued = Tracer::clock::now();
   try {
     _commandQueue.enqueueNDRangeKernel(kernel, offset,
                                        global, checkLocalSize(kernel, local),
-                                       NULL, &event);
+                                       &waitList, &event);
     _commandQueue.flush(); // always start calculation right away
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
+  launches.add();
+  enqueueTime.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                       Tracer::clock::now() - enqueued).count());
+  if (globalTracer.isEnabled()) {
+    globalTracer.recordCommand(kernel.getInfo<CL_KERNEL_FUNCTION_NAME>(),
+                               "kernel", std::vector<cl::Event>(1, event),
+                               enqueued, _id);
+  }
 
   // if callback is given, register the function to be called after the kernel
   // has finished
-  if (callback != nullptr) {
-    // copy function object to be used as user data
-    // the pointer is deleted inside the invokeCallback wrapper function
-    auto userData = static_cast<void*>(new std::function<void()>(callback));
-    event.setCallback(CL_COMPLETE, ::invokeCallback, userData);
-  }
+  if (callback != nullptr) setCallback(event, callback);
 
   LOG_DEBUG_INFO("Kernel for device ", _id, " enqueued with global range: ",
                  ::printNDRange(global), ", local: ", ::printNDRange(local),
@@ -152,19 +260,29 @@ cl::Event Device::enqueueWrite(const  DeviceBuffer& buffer,
                                const void* hostPointer,
                                size_t hostOffset) const
 {
+  if (useStaging(buffer.sizeInBytes())) {
+    auto staged = stagedWrite(buffer, 0, buffer.sizeInBytes(),
+                              static_cast<const char*>(hostPointer)
+                              + (hostOffset * buffer.elemSize()));
+    // the ring might have been disabled in the meantime
+    if (staged() != nullptr) return staged;
+  }
+
   cl::Event event;
+  auto waitList = ::waitListFor(buffer);
   try {
-    _commandQueue.enqueueWriteBuffer(buffer.clBuffer(),
-                                     CL_FALSE,
-                                     0,
-                                     buffer.sizeInBytes(),
-                                     static_cast<const void*>(
-                                       static_cast<const char*>(
-                                         hostPointer)
-                                       +(hostOffset * buffer.elemSize() ) ),
-                                     NULL,
-                                     &event);
-    _commandQueue.flush(); // always start operation right away
+    _uploadQueue.enqueueWriteBuffer(buffer.clBuffer(),
+                                   CL_FALSE,
+                                   0,
+                                   buffer.sizeInBytes(),
+                                   static_cast<const void*>(
+                                     static_cast<const char*>(
+                                       hostPointer)
+                                     +(hostOffset * buffer.elemSize() ) ),
+                                   &waitList,
+                                   &event);
+    _uploadQueue.flush(); // always start operation right away
+    buffer.setLastAccess(event);
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
@@ -177,6 +295,8 @@ cl::Event Device::enqueueWrite(const  DeviceBuffer& buffer,
                                        static_cast<const char*>(hostPointer)
                                      + (hostOffset * buffer.elemSize()) ),
                  ", hostOffset: ", hostOffset*buffer.elemSize() ,")");
+  recordTransfer(_lastUpload, std::vector<cl::Event>(1, event),
+                 buffer.sizeInBytes());
   return event;
 }
 
@@ -186,19 +306,30 @@ cl::Event Device::enqueueWrite(const  DeviceBuffer& buffer,
                                size_t deviceOffset,
                                size_t hostOffset) const
 {
+  if (useStaging(size * buffer.elemSize())) {
+    auto staged = stagedWrite(buffer, deviceOffset * buffer.elemSize(),
+                              size * buffer.elemSize(),
+                              static_cast<const char*>(hostPointer)
+                              + (hostOffset * buffer.elemSize()));
+    // the ring might have been disabled in the meantime
+    if (staged() != nullptr) return staged;
+  }
+
   cl::Event event;
+  auto waitList = ::waitListFor(buffer);
   try {
-    _commandQueue.enqueueWriteBuffer(buffer.clBuffer(),
-                                     CL_FALSE,
-                                     (deviceOffset * buffer.elemSize()),
-                                     size * buffer.elemSize(),
-                                     static_cast<void*const>(
-                                       static_cast<char*const>(
-                                         hostPointer)
-                                       +(hostOffset * buffer.elemSize() ) ),
-                                     NULL,
-                                     &event);
-    _commandQueue.flush(); // always start operation right away
+    _uploadQueue.enqueueWriteBuffer(buffer.clBuffer(),
+                                   CL_FALSE,
+                                   (deviceOffset * buffer.elemSize()),
+                                   size * buffer.elemSize(),
+                                   static_cast<void*const>(
+                                     static_cast<char*const>(
+                                       hostPointer)
+                                     +(hostOffset * buffer.elemSize() ) ),
+                                   &waitList,
+                                   &event);
+    _uploadQueue.flush(); // always start operation right away
+    buffer.setLastAccess(event);
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
@@ -211,6 +342,8 @@ cl::Event Device::enqueueWrite(const  DeviceBuffer& buffer,
                                        static_cast<char*const>(hostPointer)
                                      + (hostOffset * buffer.elemSize()) ),
                  ", hostOffset: ", hostOffset*buffer.elemSize() ,")");
+  recordTransfer(_lastUpload, std::vector<cl::Event>(1, event),
+                 size * buffer.elemSize());
   return event;
 }
 
@@ -218,9 +351,18 @@ cl::Event Device::enqueueRead(const DeviceBuffer& buffer,
                               void* hostPointer,
                               size_t hostOffset) const
 {
+  if (useStaging(buffer.sizeInBytes())) {
+    auto staged = stagedRead(buffer, 0, buffer.sizeInBytes(),
+                             static_cast<char*>(hostPointer)
+                             + (hostOffset * buffer.elemSize()));
+    // the ring might have been disabled in the meantime
+    if (staged() != nullptr) return staged;
+  }
+
   cl::Event event;
+  auto waitList = ::waitListFor(buffer);
   try {
-    _commandQueue.enqueueReadBuffer(buffer.clBuffer(),
+    _downloadQueue.enqueueReadBuffer(buffer.clBuffer(),
                                     CL_FALSE,
                                     0,
                                     buffer.sizeInBytes(),
@@ -228,9 +370,10 @@ cl::Event Device::enqueueRead(const DeviceBuffer& buffer,
                                       static_cast<char*>(
                                         hostPointer)
                                       +(hostOffset * buffer.elemSize()) ),
-                                    NULL,
+                                    &waitList,
                                     &event);
-    _commandQueue.flush(); // always start operation right away
+    _downloadQueue.flush(); // always start operation right away
+    buffer.setLastAccess(event);
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
@@ -243,6 +386,8 @@ cl::Event Device::enqueueRead(const DeviceBuffer& buffer,
                                        static_cast<char*const>(hostPointer)
                                      + (hostOffset * buffer.elemSize()) ),
                  ", hostOffset: ", hostOffset * buffer.elemSize() ,")");
+  recordTransfer(_lastDownload, std::vector<cl::Event>(1, event),
+                 buffer.sizeInBytes());
   return event;
 }
 
@@ -252,9 +397,19 @@ cl::Event Device::enqueueRead(const DeviceBuffer& buffer,
                               size_t deviceOffset,
                               size_t hostOffset) const
 {
+  if (useStaging(size * buffer.elemSize())) {
+    auto staged = stagedRead(buffer, deviceOffset * buffer.elemSize(),
+                             size * buffer.elemSize(),
+                             static_cast<char*>(hostPointer)
+                             + (hostOffset * buffer.elemSize()));
+    // the ring might have been disabled in the meantime
+    if (staged() != nullptr) return staged;
+  }
+
   cl::Event event;
+  auto waitList = ::waitListFor(buffer);
   try {
-    _commandQueue.enqueueReadBuffer(buffer.clBuffer(),
+    _downloadQueue.enqueueReadBuffer(buffer.clBuffer(),
                                     CL_FALSE,
                                     deviceOffset * buffer.elemSize(),
                                     size * buffer.elemSize(),
@@ -262,9 +417,10 @@ cl::Event Device::enqueueRead(const DeviceBuffer& buffer,
                                       static_cast<char*const>(
                                         hostPointer)
                                       +(hostOffset * buffer.elemSize()) ),
-                                    NULL,
+                                    &waitList,
                                     &event);
-    _commandQueue.flush(); // always start operation right away
+    _downloadQueue.flush(); // always start operation right away
+    buffer.setLastAccess(event);
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
@@ -277,9 +433,144 @@ cl::Event Device::enqueueRead(const DeviceBuffer& buffer,
                                        static_cast<char*const>(hostPointer)
                                      + (hostOffset * buffer.elemSize()) ),
                  ", hostOffset: ", hostOffset * buffer.elemSize() ,")");
+  recordTransfer(_lastDownload, std::vector<cl::Event>(1, event),
+                 size * buffer.elemSize());
   return event;
 }
 
+void Device::enableStaging(size_t chunkSize, size_t numChunks)
+{
+  // waits for staged transfers in flight, which use the previous ring
+  std::lock_guard<std::mutex> lock(_stagingMutex);
+  _stagingChunkSize = 0;
+  _stagingRing.reset(); // unmap the chunks of the previous ring first
+  _stagingRing.reset(new StagingRing(_context, _uploadQueue, _downloadQueue,
+                                     chunkSize, numChunks));
+  _stagingChunkSize = chunkSize;
+  LOG_INFO("Staging transfers of at least ", chunkSize, " bytes through ",
+           numChunks, " pinned chunks for device ", _id);
+}
+
+void Device::disableStaging()
+{
+  std::lock_guard<std::mutex> lock(_stagingMutex);
+  _stagingChunkSize = 0;
+  _stagingRing.reset();
+}
+
+bool Device::isStagingEnabled() const
+{
+  return _stagingChunkSize != 0;
+}
+
+double Device::lastUploadThroughput() const
+{
+  TransferRecord lastUpload;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    lastUpload = _lastUpload;
+  }
+  return ::throughput(lastUpload.events, lastUpload.bytes);
+}
+
+double Device::lastDownloadThroughput() const
+{
+  TransferRecord lastDownload;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    lastDownload = _lastDownload;
+  }
+  return ::throughput(lastDownload.events, lastDownload.bytes);
+}
+
+void Device::recordTransfer(TransferRecord& record,
+                            const std::vector<cl::Event>& events,
+                            size_t bytes) const
+{
+  bool isUpload = (&record == &_lastUpload);
+  ProfileRecorder::recordTransfer(isUpload ? CommandProfile::Upload
+                                           : CommandProfile::Download,
+                                  events, bytes);
+  // transfers are recorded right after they have been enqueued
+  globalTracer.recordCommand(isUpload ? "upload" : "download", "transfer",
+                             events, Tracer::clock::now(), _id, bytes);
+
+  static auto& uploads         = globalMetrics.counter("transfer.upload.count");
+  static auto& uploadBytes     = globalMetrics.counter("transfer.upload.bytes");
+  static auto& uploadLatency   = globalMetrics.histogram("transfer.upload.latency_us");
+  static auto& downloads       = globalMetrics.counter("transfer.download.count");
+  static auto& downloadBytes   = globalMetrics.counter("transfer.download.bytes");
+  static auto& downloadLatency = globalMetrics.histogram("transfer.download.latency_us");
+  (isUpload ? uploads : downloads).add();
+  (isUpload ? uploadBytes : downloadBytes).add(bytes);
+  if (!events.empty() && globalMetrics.isEnabled()) {
+    // the last chunk of a staged transfer completes last
+    auto transfer = new TransferLatency{
+                      isUpload ? &uploadLatency : &downloadLatency,
+                      events.front() };
+    try {
+      auto last = events.back();
+      last.setCallback(CL_COMPLETE, ::recordLatency, transfer);
+    } catch (cl::Error& err) {
+      delete transfer;
+      ABORT_WITH_ERROR(err);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  record.events = events;
+  record.bytes  = bytes;
+}
+
+bool Device::useStaging(size_t sizeInBytes) const
+{
+  // only a hint without the lock, stagedWrite and stagedRead check again
+  size_t chunkSize = _stagingChunkSize;
+  return chunkSize != 0 && sizeInBytes >= chunkSize;
+}
+
+cl::Event Device::stagedWrite(const DeviceBuffer& buffer,
+                              size_t deviceOffset,
+                              size_t sizeInBytes,
+                              const void* hostPointer) const
+{
+  // the chunks of the ring can only be used by one transfer at a time
+  std::lock_guard<std::mutex> lock(_stagingMutex);
+  if (_stagingRing == nullptr) return cl::Event();
+  auto events = _stagingRing->write(buffer.clBuffer(), deviceOffset,
+                                    sizeInBytes, hostPointer,
+                                    ::waitListFor(buffer));
+  buffer.setLastAccess(events.back());
+  LOG_DEBUG_INFO("Enqueued staged write buffer for device ", _id,
+                 " (size: ", sizeInBytes,
+                 ", clBuffer: ", buffer.clBuffer()(),
+                 ", deviceOffset: ", deviceOffset,
+                 ", chunks: ", events.size(), ")");
+  recordTransfer(_lastUpload, events, sizeInBytes);
+  // the queue is in order, so the last chunk completes last
+  return events.back();
+}
+
+cl::Event Device::stagedRead(const DeviceBuffer& buffer,
+                             size_t deviceOffset,
+                             size_t sizeInBytes,
+                             void* hostPointer) const
+{
+  std::lock_guard<std::mutex> lock(_stagingMutex);
+  if (_stagingRing == nullptr) return cl::Event();
+  auto events = _stagingRing->read(buffer.clBuffer(), deviceOffset,
+                                   sizeInBytes, hostPointer,
+                                   ::waitListFor(buffer));
+  buffer.setLastAccess(events.back());
+  LOG_DEBUG_INFO("Finished staged read buffer for device ", _id,
+                 " (size: ", sizeInBytes,
+                 ", clBuffer: ", buffer.clBuffer()(),
+                 ", deviceOffset: ", deviceOffset,
+                 ", chunks: ", events.size(), ")");
+  recordTransfer(_lastDownload, events, sizeInBytes);
+  return events.back();
+}
+
 cl::Event Device::enqueueCopy(const DeviceBuffer& from,
                               const DeviceBuffer& to,
                               size_t fromOffset,
@@ -288,15 +579,19 @@ cl::Event Device::enqueueCopy(const DeviceBuffer& from,
   ASSERT(    (from.sizeInBytes() - fromOffset)
           <= (to.sizeInBytes() - toOffset) );
   cl::Event event;
+  auto waitList = ::waitListFor(from);
+  if (to.lastAccess()() != nullptr) waitList.push_back(to.lastAccess());
   try {
     _commandQueue.enqueueCopyBuffer(from.clBuffer(),
                                     to.clBuffer(),
                                     fromOffset,
                                     toOffset,
                                     from.sizeInBytes() - fromOffset,
-                                    NULL,
+                                    &waitList,
                                     &event);
     _commandQueue.flush(); // always start operation right away
+    from.setLastAccess(event);
+    to.setLastAccess(event);
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
@@ -311,11 +606,69 @@ cl::Event Device::enqueueCopy(const DeviceBuffer& from,
   return event;
 }
 
+cl::Event Device::enqueueClear(const DeviceBuffer& buffer) const
+{
+  cl::Event event;
+  if (buffer.sizeInBytes() == 0) return event;
+  try {
+    // the kernel object is shared, so building it and setting its arguments
+    // must not be interleaved with another clear
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_clearKernel() == nullptr) {
+      cl::Program program(_context,
+                          cl::Program::Sources(1, std::make_pair(
+                            clearKernelSource,
+                            std::char_traits<char>::length(clearKernelSource))));
+      program.build(VECTOR_CLASS<cl::Device>(1, _device));
+      _clearKernel = cl::Kernel(program, "executor_clear");
+    }
+
+    auto size = buffer.sizeInBytes();
+    auto waitList = ::waitListFor(buffer);
+    auto enqueued = Tracer::clock::now();
+    _clearKernel.setArg(0, buffer.clBuffer());
+    _clearKernel.setArg(1, static_cast<cl_ulong>(size));
+    _commandQueue.enqueueNDRangeKernel(_clearKernel, cl::NullRange,
+                                       cl::NDRange((size + 15) / 16),
+                                       cl::NullRange, &waitList, &event);
+    _commandQueue.flush(); // always start operation right away
+    buffer.setLastAccess(event);
+    globalTracer.recordCommand("clear", "kernel",
+                               std::vector<cl::Event>(1, event), enqueued,
+                               _id, size);
+  } catch (cl::Error& err) {
+    ABORT_WITH_ERROR(err);
+  }
+
+  LOG_DEBUG_INFO("Enqueued clear buffer for device ", _id,
+                 " (size: ", buffer.sizeInBytes(),
+                 ", clBuffer: ", buffer.clBuffer()(), ")");
+
+  return event;
+}
+
+void Device::setCallback(const cl::Event& event,
+                         const std::function<void()> callback) const
+{
+  // copy function object to be used as user data
+  // the pointer is deleted inside the invokeCallback wrapper function
+  auto userData = static_cast<void*>(new std::function<void()>(callback));
+  try {
+    cl::Event handle = event; // setCallback is not const
+    handle.setCallback(CL_COMPLETE, ::invokeCallback, userData);
+  } catch (cl::Error& err) {
+    delete static_cast<std::function<void()>*>(userData);
+    ABORT_WITH_ERROR(err);
+  }
+}
+
 void Device::wait() const
 {
   LOG_DEBUG_INFO("Start waiting for device with id: ", _id);
   try {
+    _uploadQueue.finish();
     _commandQueue.finish();
+    _downloadQueue.finish();
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
@@ -327,6 +680,11 @@ Device::id_type Device::id() const
   return _id;
 }
 
+unsigned long Device::uid() const
+{
+  return _uid;
+}
+
 bool Device::isType(Type t) const
 {
   return _device.getInfo<CL_DEVICE_TYPE>() == t;
@@ -349,6 +707,11 @@ std::string Device::vendorName() const
   return _device.getInfo<CL_DEVICE_VENDOR>();
 }
 
+std::string Device::driverVersion() const
+{
+  return _device.getInfo<CL_DRIVER_VERSION>();
+}
+
 unsigned int Device::maxClockFrequency() const
 {
   return _device.getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>();
@@ -411,6 +774,11 @@ bool Device::isLittleEndian() const
   return _device.getInfo<CL_DEVICE_ENDIAN_LITTLE>();
 }
 
+BufferPool& Device::bufferPool() const
+{
+  return _bufferPool;
+}
+
 std::istream& operator>>(std::istream& stream, Device::Type& type)
 {
   std::string s;
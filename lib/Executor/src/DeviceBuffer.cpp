@@ -30,19 +30,37 @@ cl::Buffer createCLBuffer(const std::shared_ptr<Device>& devicePtr,
                           cl_mem_flags flags) {
   cl::Buffer buffer;
   try {
-    buffer = cl::Buffer(devicePtr->clContext(), flags, size * elemSize);
+    buffer = devicePtr->bufferPool().acquire(devicePtr->clContext(),
+                                             size * elemSize, flags,
+                                             devicePtr->maxMemAllocSize());
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
   return buffer;
 }
 
+void releaseCLBuffer(const std::shared_ptr<Device>& devicePtr,
+                     const cl::Buffer& buffer,
+                     const cl::Event& lastAccess,
+                     const size_t size,
+                     const size_t elemSize,
+                     cl_mem_flags flags) {
+  if (buffer() == nullptr) return;
+  try {
+    // the next owner might access the buffer from a different command queue
+    if (lastAccess() != nullptr) lastAccess.wait();
+    devicePtr->bufferPool().release(buffer, size * elemSize, flags);
+  } catch (cl::Error& err) {
+    LOG_ERROR(err);
+  }
+}
+
 } // namespace
 
 namespace executor {
 
 DeviceBuffer::DeviceBuffer()
-  : _device(), _size(), _elemSize(), _flags(), _buffer()
+  : _device(), _size(), _elemSize(), _flags(), _buffer(), _lastAccess()
 {
 }
 
@@ -54,7 +72,8 @@ DeviceBuffer::DeviceBuffer(const std::shared_ptr<Device>& devicePtr,
     _size(size),
     _elemSize(elemSize),
     _flags(flags),
-    _buffer(::createCLBuffer(_device, _size, _elemSize, _flags))
+    _buffer(::createCLBuffer(_device, _size, _elemSize, _flags)),
+    _lastAccess()
 {
   LOG_DEBUG_INFO("Created new DeviceBuffer object (", this, ") with ",
                  getInfo());
@@ -65,7 +84,8 @@ DeviceBuffer::DeviceBuffer(const DeviceBuffer& rhs)
     _size(rhs._size),
     _elemSize(rhs._elemSize),
     _flags(rhs._flags),
-    _buffer()
+    _buffer(),
+    _lastAccess()
 {
   // make deep copy of the rhs buffer
   _buffer = ::createCLBuffer(_device, _size, _elemSize, _flags);
@@ -80,11 +100,13 @@ DeviceBuffer::DeviceBuffer(DeviceBuffer&& rhs)
     _size(std::move(rhs._size)),
     _elemSize(std::move(rhs._elemSize)),
     _flags(std::move(rhs._flags)),
-    _buffer(std::move(rhs._buffer)) // only wrapper object (pointer) is copied
+    _buffer(std::move(rhs._buffer)), // only wrapper object (pointer) is copied
+    _lastAccess(std::move(rhs._lastAccess))
 {
   rhs._size     = 0;
   rhs._elemSize = 0;
   rhs._buffer   = cl::Buffer();
+  rhs._lastAccess = cl::Event();
   LOG_DEBUG_INFO("Created new DeviceBuffer object (", this, ") by moving with ",
                  getInfo());
 }
@@ -92,12 +114,14 @@ DeviceBuffer::DeviceBuffer(DeviceBuffer&& rhs)
 DeviceBuffer& DeviceBuffer::operator=(const DeviceBuffer& rhs)
 {
   if (this == &rhs) return *this; // handle self assignement
+  ::releaseCLBuffer(_device, _buffer, _lastAccess, _size, _elemSize, _flags);
   _device   = rhs._device;
   _size     = rhs._size;
   _elemSize = rhs._elemSize;
   _flags    = rhs._flags;
   // make deep copy of the rhs buffer
   _buffer   = ::createCLBuffer(_device, _size, _elemSize, _flags);
+  _lastAccess = cl::Event();
   _device->enqueueCopy(rhs, *this);
 
   LOG_DEBUG_INFO("Assignement to DeviceBuffer object (", this, ") now with ",
@@ -108,15 +132,18 @@ DeviceBuffer& DeviceBuffer::operator=(const DeviceBuffer& rhs)
 DeviceBuffer& DeviceBuffer::operator=(DeviceBuffer&& rhs)
 {
   if (this == &rhs) return *this;
+  ::releaseCLBuffer(_device, _buffer, _lastAccess, _size, _elemSize, _flags);
   _device   = std::move(rhs._device);
   _size     = std::move(rhs._size);
   _elemSize = std::move(rhs._elemSize);
   _flags    = std::move(rhs._flags);
   _buffer   = std::move(rhs._buffer); // copy only wrapper object (pointer)
+  _lastAccess = std::move(rhs._lastAccess);
 
   rhs._size     = 0;
   rhs._elemSize = 0;
   rhs._buffer   = cl::Buffer();
+  rhs._lastAccess = cl::Event();
   LOG_DEBUG_INFO("Move assignment to DeviceBuffer object (", this,
                  ") now with ", getInfo());
   return *this;
@@ -135,6 +162,8 @@ DeviceBuffer::~DeviceBuffer()
       LOG_DEBUG_INFO("OpenCL Buffer object remains alive (Ref count ",
                      refCount, ")");
     }
+    // hand the buffer back for reuse by the next DeviceBuffer of this size
+    ::releaseCLBuffer(_device, _buffer, _lastAccess, _size, _elemSize, _flags);
   }
 }
 
@@ -168,6 +197,16 @@ bool DeviceBuffer::isValid() const
   return (_buffer() != NULL);
 }
 
+const cl::Event& DeviceBuffer::lastAccess() const
+{
+  return _lastAccess;
+}
+
+void DeviceBuffer::setLastAccess(const cl::Event& event) const
+{
+  _lastAccess = event;
+}
+
 std::string DeviceBuffer::getInfo() const
 {
   std::stringstream s;
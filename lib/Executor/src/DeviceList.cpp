@@ -27,13 +27,20 @@ namespace executor {
 
 DeviceList globalDeviceList;
 
+namespace {
+
+// index of the device used by the calling thread
+thread_local DeviceList::size_type selectedDevice = 0;
+
+} // namespace
+
 DeviceList::DeviceList()
-  : _devices()
+  : _mutex(), _devices()
 {
 }
 
 DeviceList::DeviceList(std::initializer_list<std::shared_ptr<Device>> list)
-  : _devices(list.begin(), list.end())
+  : _mutex(), _devices(list.begin(), list.end())
 {
 }
 
@@ -44,6 +51,7 @@ bool DeviceList::operator==(const DeviceList& rhs) const
 
 void DeviceList::init(DeviceProperties properties)
 {
+  std::lock_guard<std::mutex> lock(_mutex);
   ASSERT(_devices.empty()); // call only once
   try {
     std::vector<cl::Platform> platforms;
@@ -87,7 +95,13 @@ void DeviceList::init(DeviceProperties properties)
 
 void DeviceList::init(PlatformID pID, DeviceID dID)
 {
-  ASSERT(_devices.empty()); // call only once
+  ASSERT(empty()); // call only once
+  add(pID, dID);
+}
+
+void DeviceList::add(PlatformID pID, DeviceID dID)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
   try {
     std::vector<cl::Platform> platforms;
     cl::Platform::get(&platforms);
@@ -107,7 +121,7 @@ void DeviceList::init(PlatformID pID, DeviceID dID)
 
     _devices.push_back( std::make_shared<Device>(device,
                                                  platform,
-                                                 0)
+                                                 _devices.size())
                       );
 
   } catch (cl::Error& err) {
@@ -121,18 +135,20 @@ void DeviceList::init(PlatformID pID, DeviceID dID)
 
 void DeviceList::clear()
 {
+  std::lock_guard<std::mutex> lock(_mutex);
   _devices.clear();
 }
 
 void DeviceList::barrier() const
 {
+  auto devices = snapshot();
   try {
-    std::for_each( _devices.begin(), _devices.end(),
+    std::for_each( devices.begin(), devices.end(),
                    std::mem_fn(&Device::wait) );
   } catch (cl::Error& err) {
     ABORT_WITH_ERROR(err);
   }
-  LOG_DEBUG_INFO("Finished waiting for ", _devices.size(), " devices");
+  LOG_DEBUG_INFO("Finished waiting for ", devices.size(), " devices");
 }
 
 DeviceList::const_iterator DeviceList::begin() const
@@ -157,11 +173,13 @@ DeviceList::const_reverse_iterator DeviceList::rend() const
 
 DeviceList::size_type DeviceList::size() const
 {
+  std::lock_guard<std::mutex> lock(_mutex);
   return _devices.size();
 }
 
 bool DeviceList::empty() const
 {
+  std::lock_guard<std::mutex> lock(_mutex);
   return _devices.empty();
 }
 
@@ -185,5 +203,30 @@ DeviceList::const_reference DeviceList::back() const
   return _devices.back();
 }
 
+std::vector<DeviceList::value_type> DeviceList::snapshot() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _devices;
+}
+
+DeviceList::value_type DeviceList::current() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _devices.at(selectedDevice);
+}
+
+void DeviceList::select(size_type n) const
+{
+  if (n >= size()) {
+    throw std::out_of_range("Invalid device index");
+  }
+  selectedDevice = n;
+}
+
+DeviceList::size_type DeviceList::selected() const
+{
+  return selectedDevice;
+}
+
 } // namespace executor
 
@@ -1,17 +1,23 @@
 #include "Executor.h"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+
+#include "GlobalArg.h"
+#include "util/Metrics.h"
+#include "util/Trace.h"
 
 namespace {
  
-double getRuntimeInMilliseconds(cl::Event event)
+// Returns the runtime of a command which has already completed
+double getProfiledRuntimeInMilliseconds(const cl::Event& event)
 {
   cl_ulong start;
   cl_ulong end;
   cl_int err;
 
-  event.wait();
-
   err = clGetEventProfilingInfo(event(), CL_PROFILING_COMMAND_START,
                                 sizeof(start), &start, NULL);
   ASSERT(err == CL_SUCCESS);
@@ -23,6 +29,158 @@ double getRuntimeInMilliseconds(cl::Event event)
   return (end - start) * 1.0e-06;
 }
 
+double getRuntimeInMilliseconds(cl::Event event)
+{
+  event.wait();
+  return getProfiledRuntimeInMilliseconds(event);
+}
+
+// Reports the statistics the caches keep themselves as gauges
+void registerCacheGauges()
+{
+  static std::once_flag registered;
+  std::call_once(registered, [] {
+    auto& metrics = executor::globalMetrics;
+    metrics.gauge("cache.program.hits", [] {
+      return executor::globalProgramCache.hits();
+    });
+    metrics.gauge("cache.program.misses", [] {
+      return executor::globalProgramCache.misses();
+    });
+    metrics.gauge("cache.binary.hits", [] {
+      return executor::globalBinaryCache.hits();
+    });
+    metrics.gauge("cache.binary.misses", [] {
+      return executor::globalBinaryCache.misses();
+    });
+
+    auto bufferPools = [] (std::function<double(
+                             const executor::BufferPool::Statistics&)> f) {
+      double sum = 0.0;
+      for (auto& devicePtr : executor::globalDeviceList.snapshot()) {
+        sum += f(devicePtr->bufferPool().statistics());
+      }
+      return sum;
+    };
+    metrics.gauge("buffer.bytes.reserved", [bufferPools] {
+      return bufferPools([] (const executor::BufferPool::Statistics& s) {
+        return s.bytesReserved;
+      });
+    });
+    metrics.gauge("buffer.bytes.in_use", [bufferPools] {
+      return bufferPools([] (const executor::BufferPool::Statistics& s) {
+        return s.bytesInUse;
+      });
+    });
+  });
+}
+
+double median(std::vector<double> runtimes)
+{
+  std::sort(std::begin(runtimes), std::end(runtimes));
+  auto n = runtimes.size();
+  if (n % 2 == 0) return (runtimes[n/2] + runtimes[n/2 - 1]) / 2.0;
+  return runtimes[n/2];
+}
+
+// Enqueues the kernel behind the pending transfers of its arguments, which
+// are enqueued in a separate command queue
+cl::Event enqueueKernel(const cl::Kernel& kernel,
+                        const cl::NDRange& global, const cl::NDRange& local,
+                        const std::vector<executor::KernelArg*>& args)
+{
+  auto devPtr = executor::globalDeviceList.current();
+
+  std::vector<cl::Event> waitList;
+  for (auto& arg : args) arg->appendWaitList(waitList);
+
+  auto event = devPtr->enqueue(kernel, global, local, cl::NullRange, nullptr,
+                               waitList);
+
+  for (auto& arg : args) arg->accessedBy(event);
+  return event;
+}
+
+// Uploads the arguments, enqueues the kernel and the downloads of the outputs
+// without waiting for any of them to finish
+cl::Event launchKernel(cl::Kernel kernel,
+                       int localSize1, int localSize2, int localSize3,
+                       int globalSize1, int globalSize2, int globalSize3,
+                       const std::vector<executor::KernelArg*>& args)
+{
+  cl_uint clLocalSize1 = localSize1;
+  cl_uint clGlobalSize1 = globalSize1;
+  cl_uint clLocalSize2 = localSize2;
+  cl_uint clGlobalSize2 = globalSize2;
+  cl_uint clLocalSize3 = localSize3;
+  cl_uint clGlobalSize3 = globalSize3;
+
+  int i = 0;
+  for (auto& arg : args) {
+    arg->upload();
+    arg->setAsKernelArg(kernel, i);
+    ++i;
+  }
+
+  auto event = enqueueKernel(kernel,
+                             cl::NDRange(clGlobalSize1,
+                                         clGlobalSize2, clGlobalSize3),
+                             cl::NDRange(clLocalSize1,
+                                         clLocalSize2, clLocalSize3),
+                             args);
+
+  for (auto& arg : args) arg->download();
+
+  return event;
+}
+
+// Returns the event of the kernel or of the last download of an output
+// enqueued behind it, whichever completes last. Downloads are enqueued in an
+// in-order queue of their own, so the one enqueued last completes last.
+cl::Event lastCommandOf(const cl::Event& kernel,
+                        const std::vector<executor::KernelArg*>& args)
+{
+  auto last = kernel;
+  for (auto& arg : args) {
+    std::vector<cl::Event> accesses;
+    arg->appendWaitList(accesses);
+    if (!accesses.empty() && accesses.back()() != kernel()) {
+      last = accesses.back();
+    }
+  }
+  return last;
+}
+
+// A probe runs about this fraction of the work-groups of a candidate
+const size_t probeDivisor = 16;
+
+// Candidates are only aborted if their estimate exceeds the best runtime seen
+// so far by this factor, as the launch overhead is extrapolated as well
+const double bestRuntimeSlack = 1.5;
+
+// Shrinks global to a slab of the first work-groups along the dimension with
+// the most work-groups, so that the slab holds 1/probeDivisor of all
+// work-groups but at least minGroups, e.g. enough to occupy every compute
+// unit. Returns the fraction of all work-groups in the slab.
+double probeRange(const size_t local[3], size_t global[3], size_t minGroups)
+{
+  size_t groups[3];
+  size_t total = 1;
+  int widest = 0;
+  for (int d = 0; d < 3; ++d) {
+    ASSERT(local[d] > 0);
+    groups[d] = std::max<size_t>(global[d] / local[d], 1);
+    total *= groups[d];
+    if (groups[d] > groups[widest]) widest = d;
+  }
+
+  auto target = std::max((total + probeDivisor - 1) / probeDivisor, minGroups);
+  auto perSlice = total / groups[widest];
+  auto slices = std::min(groups[widest], (target + perSlice - 1) / perSlice);
+  global[widest] = slices * local[widest];
+  return static_cast<double>(slices) / groups[widest];
+}
+
 }
 
 void initExecutor(int platformId, int deviceId)
@@ -37,95 +195,266 @@ void initExecutor(std::string deviceTypeString)
   executor::init(executor::nDevices(1).deviceType(deviceType));
 }
 
+void initExecutor(const std::vector<int>& platformIds,
+                  const std::vector<int>& deviceIds)
+{
+  ASSERT(platformIds.size() == deviceIds.size());
+  ASSERT(executor::globalDeviceList.empty());
+  for (size_t i = 0; i < platformIds.size(); ++i) {
+    executor::globalDeviceList.add(executor::platform(platformIds[i]),
+                                   executor::device(deviceIds[i]));
+  }
+}
+
 void shutdownExecutor()
 {
+#ifndef _WIN32
+  executor::globalWorkerPool.stop();
+#endif
   executor::terminate();
 }
 
+void setCompileThreads(unsigned long numThreads)
+{
+  executor::globalCompilePool.setNumThreads(numThreads);
+}
+
+void startWorkers(const std::string& workerPath, unsigned long numWorkers,
+                  int platformId, int deviceId)
+{
+#ifdef _WIN32
+  (void)workerPath; (void)numWorkers; (void)platformId; (void)deviceId;
+  throw executor::WorkerError(
+      "worker processes are not supported on this platform", false);
+#else
+  executor::globalWorkerPool.start(workerPath, numWorkers, platformId,
+                                   deviceId);
+#endif
+}
+
+void stopWorkers()
+{
+#ifndef _WIN32
+  executor::globalWorkerPool.stop();
+#endif
+}
+
+void enableTracing(unsigned long eventsPerThread)
+{
+  executor::globalTracer.enable(eventsPerThread);
+}
+
+void disableTracing()
+{
+  executor::globalTracer.disable();
+}
+
+bool dumpTrace(const std::string& path)
+{
+  return executor::globalTracer.write(path);
+}
+
+void enableMetrics()
+{
+  executor::globalMetrics.enable();
+}
+
+void disableMetrics()
+{
+  executor::globalMetrics.disable();
+}
+
+std::map<std::string, double> getMetrics()
+{
+  registerCacheGauges();
+  return executor::globalMetrics.snapshot();
+}
+
+void startMetricsDump(const std::string& path, double intervalInSeconds)
+{
+  registerCacheGauges();
+  executor::globalMetrics.startPeriodicDump(path, intervalInSeconds);
+}
+
+void stopMetricsDump()
+{
+  executor::globalMetrics.stopPeriodicDump();
+}
+
+void selectDevice(unsigned long index)
+{
+  executor::globalDeviceList.select(index);
+}
+
+unsigned long getSelectedDevice()
+{
+  return executor::globalDeviceList.selected();
+}
+
+unsigned long getDeviceCount()
+{
+  return executor::globalDeviceList.size();
+}
+
 std::string getPlatformName()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->clPlatform().getInfo<CL_PLATFORM_NAME>();
 }
 
 unsigned long getDeviceLocalMemSize()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->localMemSize();
 }
 
 unsigned long getDeviceGlobalMemSize()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->globalMemSize();
 }
 
 unsigned long getDeviceMaxMemAllocSize()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->maxMemAllocSize();
 }
 
 unsigned long getDeviceMaxWorkGroupSize()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->maxWorkGroupSize();
 }
 
 std::string getDeviceName()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->name();
 }
 
 std::string getDeviceType()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->typeAsString();
 }
 
 bool supportsDouble()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->supportsDouble();
 }
 
 bool isLittleEndian()
 {
-  auto& devicePtr = executor::globalDeviceList.front();
+  auto devicePtr = executor::globalDeviceList.current();
   return devicePtr->isLittleEndian();
 }
 
-double executeKernel(cl::Kernel kernel,
-                     int localSize1, int localSize2, int localSize3,
-                     int globalSize1, int globalSize2, int globalSize3,
-                     const std::vector<executor::KernelArg*>& args)
+void enableBinaryCache(std::string directory, unsigned long maxSizeInBytes)
 {
-  auto& devPtr = executor::globalDeviceList.front();
+  executor::globalBinaryCache.enable(directory, maxSizeInBytes);
+}
 
-  cl_uint clLocalSize1 = localSize1;
-  cl_uint clGlobalSize1 = globalSize1;
-  cl_uint clLocalSize2 = localSize2;
-  cl_uint clGlobalSize2 = globalSize2;
-  cl_uint clLocalSize3 = localSize3;
-  cl_uint clGlobalSize3 = globalSize3;
+void disableBinaryCache()
+{
+  executor::globalBinaryCache.disable();
+}
 
-  int i = 0;
-  for (auto& arg : args) {
-    arg->upload();
-    arg->setAsKernelArg(kernel, i);
-    ++i;
+unsigned long getBinaryCacheHits()
+{
+  return executor::globalBinaryCache.hits();
+}
+
+unsigned long getBinaryCacheMisses()
+{
+  return executor::globalBinaryCache.misses();
+}
+
+double getBinaryCacheHitBuildTime()
+{
+  return executor::globalBinaryCache.hitBuildTime();
+}
+
+double getBinaryCacheMissBuildTime()
+{
+  return executor::globalBinaryCache.missBuildTime();
+}
+
+void setProgramCacheCapacity(unsigned long maxPrograms)
+{
+  executor::globalProgramCache.setCapacity(maxPrograms);
+}
+
+void purgeProgramCache()
+{
+  executor::globalProgramCache.purge();
+}
+
+unsigned long getProgramCacheHits()
+{
+  return executor::globalProgramCache.hits();
+}
+
+unsigned long getProgramCacheMisses()
+{
+  return executor::globalProgramCache.misses();
+}
+
+void setBufferPoolHighWaterMark(unsigned long bytes)
+{
+  for (auto& devicePtr : executor::globalDeviceList.snapshot()) {
+    devicePtr->bufferPool().setHighWaterMark(bytes);
   }
+}
 
-  auto event = devPtr->enqueue(kernel,
-                               cl::NDRange(clGlobalSize1,
-                                           clGlobalSize2, clGlobalSize3),
-                               cl::NDRange(clLocalSize1,
-                                           clLocalSize2, clLocalSize3));
+executor::BufferPool::Statistics getBufferPoolStatistics()
+{
+  auto devicePtr = executor::globalDeviceList.current();
+  return devicePtr->bufferPool().statistics();
+}
 
-  for (auto& arg : args) arg->download();
+void enableStagedTransfers(unsigned long chunkSize, unsigned long numChunks)
+{
+  for (auto& devicePtr : executor::globalDeviceList.snapshot()) {
+    devicePtr->enableStaging(chunkSize, numChunks);
+  }
+}
+
+void disableStagedTransfers()
+{
+  for (auto& devicePtr : executor::globalDeviceList.snapshot()) {
+    devicePtr->disableStaging();
+  }
+}
 
-  return getRuntimeInMilliseconds(event);
+double getLastUploadThroughput()
+{
+  auto devicePtr = executor::globalDeviceList.current();
+  return devicePtr->lastUploadThroughput();
+}
+
+double getLastDownloadThroughput()
+{
+  auto devicePtr = executor::globalDeviceList.current();
+  return devicePtr->lastDownloadThroughput();
+}
+
+double executeKernel(cl::Kernel kernel,
+                     int localSize1, int localSize2, int localSize3,
+                     int globalSize1, int globalSize2, int globalSize3,
+                     const std::vector<executor::KernelArg*>& args)
+{
+  auto event = launchKernel(kernel, localSize1, localSize2, localSize3,
+                            globalSize1, globalSize2, globalSize3, args);
+  auto runtime = getRuntimeInMilliseconds(event);
+
+  // wait for downloads which have been started right away; only the
+  // arguments are waited for, as other threads might share the device
+  std::vector<cl::Event> pending;
+  for (auto& arg : args) arg->appendWaitList(pending);
+  if (!pending.empty()) cl::Event::waitForEvents(pending);
+
+  return runtime;
 }
 
 double execute(const executor::Kernel& kernel,
@@ -137,6 +466,126 @@ double execute(const executor::Kernel& kernel,
                        globalSize1, globalSize2, globalSize3, args);
 }
 
+executor::ExecutionProfile
+  executeProfiled(const executor::Kernel& kernel,
+                  int localSize1, int localSize2, int localSize3,
+                  int globalSize1, int globalSize2, int globalSize3,
+                  const std::vector<executor::KernelArg*>& args)
+{
+  using clock = std::chrono::steady_clock;
+  auto milliseconds = [](clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  executor::ExecutionProfile profile;
+  executor::ProfileRecorder recorder;
+
+  auto begin = clock::now();
+  auto openclKernel = kernel.build();
+  profile.buildTime = milliseconds(clock::now() - begin);
+
+  auto event = launchKernel(openclKernel, localSize1, localSize2, localSize3,
+                            globalSize1, globalSize2, globalSize3, args);
+  recorder.recordKernel(event);
+
+  // downloads of outputs owned by a GlobalArg are deferred until the host
+  // accesses them, they are part of the round trip nonetheless
+  for (auto& arg : args) {
+    auto globalArg = dynamic_cast<executor::GlobalArg*>(arg);
+    if (globalArg != nullptr && globalArg->producesOutput()) {
+      globalArg->hostData();
+    }
+  }
+  std::vector<cl::Event> pending;
+  for (auto& arg : args) arg->appendWaitList(pending);
+  if (!pending.empty()) cl::Event::waitForEvents(pending);
+
+  profile.commands = recorder.commands();
+  profile.hostTime = milliseconds(clock::now() - begin);
+  return profile;
+}
+
+void executeAsync(const executor::Kernel& kernel,
+                  int localSize1, int localSize2, int localSize3,
+                  int globalSize1, int globalSize2, int globalSize3,
+                  const std::vector<executor::KernelArg*>& args,
+                  std::function<void(double, int)> onComplete)
+{
+  auto devPtr = executor::globalDeviceList.current();
+
+  auto event = launchKernel(kernel.build(), localSize1, localSize2, localSize3,
+                            globalSize1, globalSize2, globalSize3, args);
+
+  // no marker is enqueued, as it would hold back the transfers of later
+  // executions until this one has finished
+  auto last = lastCommandOf(event, args);
+  devPtr->setCallback(last, [event, last, onComplete] () {
+    // cl.hpp reports the status as cl_uint, errors are negative cl_ints
+    auto status = static_cast<cl_int>(
+                    event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>());
+    if (status >= 0) {
+      status = static_cast<cl_int>(
+                 last.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>());
+    }
+    if (status < 0) {
+      onComplete(0.0, status);
+    } else {
+      onComplete(getProfiledRuntimeInMilliseconds(event), CL_SUCCESS);
+    }
+  });
+}
+
+double executeInWorker(const executor::Kernel& kernel,
+                       int localSize1, int localSize2, int localSize3,
+                       int globalSize1, int globalSize2, int globalSize3,
+                       const std::vector<executor::KernelArg*>& args,
+                       double deadlineInMilliseconds)
+{
+#ifdef _WIN32
+  (void)kernel; (void)args; (void)deadlineInMilliseconds;
+  (void)localSize1; (void)localSize2; (void)localSize3;
+  (void)globalSize1; (void)globalSize2; (void)globalSize3;
+  throw executor::WorkerError(
+      "worker processes are not supported on this platform", false);
+#else
+  return executor::globalWorkerPool.execute(kernel,
+                                            localSize1, localSize2, localSize3,
+                                            globalSize1, globalSize2, globalSize3,
+                                            args, deadlineInMilliseconds);
+#endif
+}
+
+std::vector<double>
+  executePipeline(const std::vector<const executor::Kernel*>& kernels,
+                  const std::vector<int>& sizes,
+                  const std::vector<std::vector<executor::KernelArg*>>& args)
+{
+  ASSERT(kernels.size() == args.size());
+  ASSERT(sizes.size() == 6 * kernels.size());
+
+  // outputs are only marked as modified on the device, so the next kernel
+  // reads them without a round trip through the host
+  std::vector<cl::Event> events;
+  for (size_t i = 0; i < kernels.size(); ++i) {
+    auto s = sizes.begin() + 6 * i;
+    events.push_back(launchKernel(kernels[i]->build(), s[0], s[1], s[2],
+                                  s[3], s[4], s[5], args[i]));
+  }
+
+  std::vector<double> runtimes;
+  for (auto& event : events) {
+    runtimes.push_back(getRuntimeInMilliseconds(event));
+  }
+
+  std::vector<cl::Event> pending;
+  for (auto& stageArgs : args) {
+    for (auto& arg : stageArgs) arg->appendWaitList(pending);
+  }
+  if (!pending.empty()) cl::Event::waitForEvents(pending);
+
+  return runtimes;
+}
+
 void benchmark(const executor::Kernel& kernel,
                int localSize1, int localSize2, int localSize3,
                int globalSize1, int globalSize2, int globalSize3,
@@ -144,6 +593,7 @@ void benchmark(const executor::Kernel& kernel,
                int iterations, double timeout,
                std::vector<double>& runtimes)
 {
+  auto openclKernel = kernel.build();
   for (int i = 0; i < iterations; i++) {
     //std::cout << "Iteration: " << i << '\n';
 
@@ -151,7 +601,7 @@ void benchmark(const executor::Kernel& kernel,
       arg->clear();
     }
 
-    double runtime = executeKernel(kernel.build(), localSize1, localSize2, localSize3,
+    double runtime = executeKernel(openclKernel, localSize1, localSize2, localSize3,
                        globalSize1, globalSize2, globalSize3, args);
 
     runtimes.push_back(runtime);
@@ -162,111 +612,269 @@ void benchmark(const executor::Kernel& kernel,
   }
 }
 
-double evaluate(const executor::Kernel& kernel,
-                int localSize1, int localSize2, int localSize3,
-                int globalSize1, int globalSize2, int globalSize3,
-                const std::vector<executor::KernelArg*>& args,
-                int iterations, double timeout)
+void benchmarkResident(const executor::Kernel& kernel,
+                       int localSize1, int localSize2, int localSize3,
+                       int globalSize1, int globalSize2, int globalSize3,
+                       const std::vector<executor::KernelArg*>& args,
+                       int iterations, double timeout, bool clearOutputs,
+                       std::vector<double>& runtimes)
 {
-  auto& devPtr = executor::globalDeviceList.front();
-  cl_uint clLocalSize1 = localSize1;
-  cl_uint clGlobalSize1 = globalSize1;
-  cl_uint clLocalSize2 = localSize2;
-  cl_uint clGlobalSize2 = globalSize2;
-  cl_uint clLocalSize3 = localSize3;
-  cl_uint clGlobalSize3 = globalSize3;
+  cl::NDRange global(globalSize1, globalSize2, globalSize3);
+  cl::NDRange local(localSize1, localSize2, localSize3);
 
-  cl_int err = CL_SUCCESS;
-
-  // Copy the buffers only once
+  // build, upload and bind only once
+  auto openclKernel = kernel.build();
+  int i = 0;
   for (auto& arg : args) {
     arg->upload();
+    arg->setAsKernelArg(openclKernel, i);
+    ++i;
   }
 
-  { // run a single workgroup on dummy data
-    auto k = executor::Kernel(
-        std::string{"#define WORKGROUP_GUARD {for(int i = 0; i < get_work_dim(); ++i) if(get_group_id(i)!=0) return;}\n"} + kernel.getSource(),
-           kernel.getName(), kernel.getBuildOptions()
-        );
+  for (int it = 0; it < iterations; ++it) {
+    if (clearOutputs) {
+      for (auto& arg : args) arg->clear();
+    }
 
-    auto openclKernel = k.build();
+    auto runtime = getRuntimeInMilliseconds(
+                     enqueueKernel(openclKernel, global, local, args));
+    runtimes.push_back(runtime);
 
-    auto wg_size = -1;
-    err = openclKernel.getWorkGroupInfo(devPtr->clDevice(), CL_KERNEL_WORK_GROUP_SIZE ,&wg_size);
-    if(err != CL_SUCCESS) {
-      std::cerr << "ERROR " << err << std::endl;
-      return -1;
-    }
+    if (timeout != 0.0 && runtime >= timeout) break;
+  }
 
-    cl_ulong private_mem = -1;
-    err = openclKernel.getWorkGroupInfo(devPtr->clDevice(), CL_KERNEL_PRIVATE_MEM_SIZE, &private_mem);
-    if(err != CL_SUCCESS) {
-      std::cerr << "ERROR " << err << std::endl;
-      return -1;
-    }
+  for (auto& arg : args) arg->download();
 
-   std::cout << "Amount of private memory: " << private_mem << std::endl;
+  std::vector<cl::Event> pending;
+  for (auto& arg : args) arg->appendWaitList(pending);
+  if (!pending.empty()) cl::Event::waitForEvents(pending);
+}
 
-    
+executor::BenchmarkSummary
+  benchmarkAdaptive(const executor::Kernel& kernel,
+                    int localSize1, int localSize2, int localSize3,
+                    int globalSize1, int globalSize2, int globalSize3,
+                    const std::vector<executor::KernelArg*>& args,
+                    const executor::BenchmarkOptions& options)
+{
+  ASSERT(options.minIterations > 0);
+  ASSERT(options.maxIterations >= options.minIterations);
+  cl::NDRange global(globalSize1, globalSize2, globalSize3);
+  cl::NDRange local(localSize1, localSize2, localSize3);
 
-    if(wg_size < localSize1 * localSize2 * localSize3) {
-      return -1;
+  auto openclKernel = kernel.build();
+  int i = 0;
+  for (auto& arg : args) {
+    arg->upload();
+    arg->setAsKernelArg(openclKernel, i);
+    ++i;
+  }
+
+  auto run = [&] () {
+    if (options.clearOutputs) {
+      for (auto& arg : args) arg->clear();
     }
-    
-    int i = 0;
-    for (auto& arg : args) {
-      arg->setAsKernelArg(openclKernel, i);
-      ++i;
+    return getRuntimeInMilliseconds(
+             enqueueKernel(openclKernel, global, local, args));
+  };
+
+  for (int it = 0; it < options.warmupIterations; ++it) run();
+
+  std::vector<double> runtimes;
+  executor::BenchmarkSummary summary;
+  for (int it = 0; it < options.maxIterations; ++it) {
+    auto runtime = run();
+    runtimes.push_back(runtime);
+    if (options.timeout != 0.0 && runtime >= options.timeout) break;
+
+    if (it + 1 >= options.minIterations) {
+      summary = executor::summarize(runtimes, options.confidenceLevel,
+                                    options.outlierThreshold);
+      // the spread can only be estimated from at least two runs
+      auto n = summary.runtimes.size() - summary.outliers;
+      auto halfWidth = (summary.ciHigh - summary.ciLow) / 2.0;
+      if (n >= 2 && halfWidth <= options.targetRelativeError * summary.mean) {
+        summary.converged = true;
+        break;
+      }
     }
+  }
+  if (summary.runtimes.size() != runtimes.size()) {
+    summary = executor::summarize(runtimes, options.confidenceLevel,
+                                  options.outlierThreshold);
+  }
+
+  for (auto& arg : args) arg->download();
 
-    auto event = devPtr->enqueue(openclKernel,
-                                 cl::NDRange(clGlobalSize1,
-                                             clGlobalSize2, clGlobalSize3),
-                                 cl::NDRange(clLocalSize1,
-                                             clLocalSize2, clLocalSize3));
+  std::vector<cl::Event> pending;
+  for (auto& arg : args) arg->appendWaitList(pending);
+  if (!pending.empty()) cl::Event::waitForEvents(pending);
 
-    auto time = getRuntimeInMilliseconds(event);
-    std::cout << "Single workgroup: " << time << std::endl;
-    if (time > timeout) return -time;
+  return summary;
+}
+
+executor::EvaluationResult
+  evaluateWithEarlyAbort(const executor::Kernel& kernel,
+                         int localSize1, int localSize2, int localSize3,
+                         int globalSize1, int globalSize2, int globalSize3,
+                         const std::vector<executor::KernelArg*>& args,
+                         int iterations, double timeout, double bestRuntime,
+                         bool sizesInjected)
+{
+  ASSERT(iterations > 0);
+  executor::EvaluationResult result;
+  auto devPtr = executor::globalDeviceList.current();
+  size_t local[3]  = { static_cast<size_t>(localSize1),
+                       static_cast<size_t>(localSize2),
+                       static_cast<size_t>(localSize3) };
+  size_t global[3] = { static_cast<size_t>(globalSize1),
+                       static_cast<size_t>(globalSize2),
+                       static_cast<size_t>(globalSize3) };
+  cl::NDRange localRange(local[0], local[1], local[2]);
+  cl::NDRange globalRange(global[0], global[1], global[2]);
+
+  // Copy the buffers only once
+  for (auto& arg : args) {
+    arg->upload();
   }
 
+  auto openclKernel = kernel.build();
+  auto wgSize = openclKernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(
+                  devPtr->clDevice());
+  result.privateMemory =
+    openclKernel.getWorkGroupInfo<CL_KERNEL_PRIVATE_MEM_SIZE>(
+      devPtr->clDevice());
+  if (wgSize < local[0] * local[1] * local[2]) {
+    result.status  = executor::EvaluationResult::InvalidWorkGroupSize;
+    result.runtime = -1;
+    return result;
+  }
 
-  { // actual run
-    std::vector<double> allRuntimes;
-    allRuntimes.resize(iterations);
+  int i = 0;
+  for (auto& arg : args) {
+    arg->setAsKernelArg(openclKernel, i);
+    ++i;
+  }
 
-    auto openclKernel = kernel.build();
-    int i = 0;
-    for (auto& arg : args) {
-      arg->setAsKernelArg(openclKernel, i);
-      ++i;
+  if (sizesInjected) {
+    // the kernel does not depend on the size of the NDRange, so it is timed
+    // on a slab of its work-groups and the full runtime is extrapolated
+    size_t probe[3] = { global[0], global[1], global[2] };
+    result.probeFraction = probeRange(local, probe, devPtr->maxComputeUnits());
+    auto probeRuntime = getRuntimeInMilliseconds(
+                          enqueueKernel(openclKernel,
+                                        cl::NDRange(probe[0], probe[1], probe[2]),
+                                        localRange, args));
+    result.estimate = probeRuntime / result.probeFraction;
+
+    auto limit = timeout;
+    if (bestRuntime > 0.0) limit = std::min(limit, bestRuntime * bestRuntimeSlack);
+    if (result.estimate > limit) {
+      result.status  = executor::EvaluationResult::Aborted;
+      result.runtime = result.estimate;
+      return result;
     }
 
-    for (int i = 0; i < iterations; i++) {
-      auto event = devPtr->enqueue(openclKernel,
-                                   cl::NDRange(clGlobalSize1,
-                                               clGlobalSize2, clGlobalSize3),
-                                   cl::NDRange(clLocalSize1,
-                                               clLocalSize2, clLocalSize3));
-      auto runtime = getRuntimeInMilliseconds(event);
-      if(runtime > timeout) {
-        for (auto& arg : args) arg->download();
-        return runtime;
-      }
-      allRuntimes[i] = runtime;
+    // a probe of the whole NDRange is the first full run
+    if (result.probeFraction == 1.0) result.runtimes.push_back(probeRuntime);
+  }
+
+  while (result.runtimes.size() < static_cast<size_t>(iterations)) {
+    auto runtime = getRuntimeInMilliseconds(
+                     enqueueKernel(openclKernel, globalRange, localRange, args));
+    result.runtimes.push_back(runtime);
+    if (runtime > timeout) {
+      result.status  = executor::EvaluationResult::TimedOut;
+      result.runtime = runtime;
+      for (auto& arg : args) arg->download();
+      return result;
     }
-  
-    for (auto& arg : args) arg->download();
+  }
 
-    std::sort(std::begin(allRuntimes), std::end(allRuntimes));
+  for (auto& arg : args) arg->download();
 
-    double median;
+  result.runtime = median(result.runtimes);
+  return result;
+}
 
-    if (iterations % 2 == 0)
-      median = (allRuntimes[iterations/2] + allRuntimes[iterations/2 - 1]) / 2.0;
-    else 
-      median = allRuntimes[iterations/2];
+double evaluate(const executor::Kernel& kernel,
+                int localSize1, int localSize2, int localSize3,
+                int globalSize1, int globalSize2, int globalSize3,
+                const std::vector<executor::KernelArg*>& args,
+                int iterations, double timeout)
+{
+  auto result = evaluateWithEarlyAbort(kernel,
+                                       localSize1, localSize2, localSize3,
+                                       globalSize1, globalSize2, globalSize3,
+                                       args, iterations, timeout, 0.0, false);
+  if (result.status == executor::EvaluationResult::InvalidWorkGroupSize) {
+    return -1;
+  }
+  return result.runtime;
+}
 
-    return median;
+std::vector<double>
+  evaluateBatch(const std::vector<const executor::Kernel*>& kernels,
+                const std::vector<int>& sizes,
+                const std::vector<executor::KernelArg*>& args,
+                int iterations, double timeout)
+{
+  ASSERT(sizes.size() == 6 * kernels.size());
+  ASSERT(iterations > 0);
+  auto devPtr = executor::globalDeviceList.current();
+
+  // the inputs are shared by all candidates, so they are uploaded only once
+  for (auto& arg : args) arg->upload();
+
+  // build all candidates in the background, in the order they are launched
+  for (auto& kernel : kernels) kernel->buildAsync();
+
+  std::vector<double> results;
+  for (size_t i = 0; i < kernels.size(); ++i) {
+    auto s = sizes.begin() + 6 * i;
+    cl::NDRange local(s[0], s[1], s[2]);
+    cl::NDRange global(s[3], s[4], s[5]);
+
+    double result = -1;
+    try {
+      // only waits for the program of this candidate
+      auto openclKernel = kernels[i]->build();
+
+      auto wgSize = openclKernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(
+                      devPtr->clDevice());
+      if (wgSize >= static_cast<size_t>(s[0] * s[1] * s[2])) {
+        int j = 0;
+        for (auto& arg : args) {
+          arg->setAsKernelArg(openclKernel, j);
+          ++j;
+        }
+
+        std::vector<double> runtimes;
+        for (int it = 0; it < iterations; ++it) {
+          auto runtime = getRuntimeInMilliseconds(
+                           enqueueKernel(openclKernel, global, local, args));
+          if (runtime > timeout) { runtimes.assign(1, runtime); break; }
+          runtimes.push_back(runtime);
+        }
+        result = median(runtimes);
+      }
+    } catch (cl::Error& err) {
+      LOG_ERROR("Evaluating candidate ", i, " failed: ", err);
+    } catch (cl::Error* err) {
+      // thrown by ABORT_WITH_ERROR
+      LOG_ERROR("Evaluating candidate ", i, " failed: ", *err);
+      delete err;
+    } catch (std::runtime_error* err) {
+      // thrown by ASSERT
+      LOG_ERROR("Evaluating candidate ", i, " failed: ", err->what());
+      delete err;
+    } catch (...) {
+      LOG_ERROR("Evaluating candidate ", i, " failed");
+    }
+    results.push_back(result);
   }
+
+  for (auto& arg : args) arg->download();
+
+  return results;
 }
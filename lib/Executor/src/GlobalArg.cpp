@@ -1,12 +1,150 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "GlobalArg.h"
 
+#include "util/Assert.h"
 #include "util/Logger.h"
 
 namespace executor {
 
+///
+/// \brief A memory mapping of (a part of) a file, which is unmapped on
+///        destruction
+///
+class MappedFile {
+public:
+  ///
+  /// \param forOutput Creates or truncates the file to length bytes and
+  ///                  shares the mapping with it; otherwise the mapping is
+  ///                  private, so that the file is never modified
+  ///
+  MappedFile(const std::string& path, size_t offset, size_t length,
+             bool forOutput)
+    : _mapping(nullptr), _mappingSize(0), _data(nullptr), _size(length)
+  {
+#ifdef _WIN32
+    (void)offset; (void)forOutput;
+    throw std::runtime_error("Cannot map " + path
+                             + ": not supported on this platform");
+#else
+    auto fd = open(path.c_str(),
+                   forOutput ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+    if (fd < 0) fail("Cannot open " + path, errno);
+
+    if (forOutput) {
+      if (ftruncate(fd, offset + length) != 0) {
+        auto error = errno;
+        close(fd);
+        fail("Cannot resize " + path, error);
+      }
+    } else {
+      struct stat status;
+      if (fstat(fd, &status) != 0) {
+        auto error = errno;
+        close(fd);
+        fail("Cannot stat " + path, error);
+      }
+      auto fileSize = static_cast<size_t>(status.st_size);
+      if (_size == 0 && offset < fileSize) _size = fileSize - offset;
+      if (offset + _size > fileSize) {
+        close(fd);
+        throw std::runtime_error(path + " has only " + std::to_string(fileSize)
+                                 + " bytes");
+      }
+    }
+    if (_size == 0) {
+      close(fd);
+      throw std::runtime_error("Cannot map 0 bytes of " + path);
+    }
+
+    // mappings have to start at a page boundary
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto alignedOffset = offset - offset % pageSize;
+    _mappingSize = _size + (offset - alignedOffset);
+    auto mapping = mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE,
+                        forOutput ? MAP_SHARED : MAP_PRIVATE, fd,
+                        static_cast<off_t>(alignedOffset));
+    auto error = errno;
+    // the mapping keeps the file open
+    close(fd);
+    if (mapping == MAP_FAILED) fail("Cannot map " + path, error);
+    _mapping = mapping;
+
+    if (!forOutput) madvise(_mapping, _mappingSize, MADV_SEQUENTIAL);
+    _data = static_cast<char*>(_mapping) + (offset - alignedOffset);
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifndef _WIN32
+    if (_mapping != nullptr) munmap(_mapping, _mappingSize);
+#endif
+  }
+
+  char* data() const { return _data; }
+
+  size_t size() const { return _size; }
+
+private:
+  MappedFile(const MappedFile&);// = delete;
+  MappedFile& operator=(const MappedFile&);// = delete;
+
+  static void fail(const std::string& message, int error)
+  {
+    throw std::runtime_error(message + ": " + std::strerror(error));
+  }
+
+  void*   _mapping;
+  size_t  _mappingSize;
+  char*   _data;
+  size_t  _size;
+};
+
 GlobalArg::GlobalArg(executor::Vector<char>&& vectorP, bool isOutputP)
-  : vector(std::move(vectorP)), isOutput(isOutputP)
+  : vector(std::move(vectorP)), isOutput(isOutputP),
+    externalData(nullptr), externalSize(0), externalBuffer(),
+    externalUploaded(false), externalHostUpToDate(true), externalDownload(),
+    mappedFile()
+{
+}
+
+GlobalArg::GlobalArg(char* externalDataP, size_t externalSizeP, bool isOutputP)
+  : vector(), isOutput(isOutputP),
+    externalData(externalDataP), externalSize(externalSizeP), externalBuffer(),
+    externalUploaded(false), externalHostUpToDate(true), externalDownload(),
+    mappedFile()
+{
+}
+
+GlobalArg::~GlobalArg()
 {
+  // the device must not write into the memory after it has been released
+  if (externalDownload() != nullptr) {
+    try {
+      externalDownload.wait();
+    } catch (cl::Error& err) {
+      LOG_ERROR("Download into external memory failed: ", err);
+    }
+  }
+  // nor read from it, e.g. for an upload from a file mapping or by write()
+  auto& lastAccess = externalBuffer.lastAccess();
+  if (lastAccess() != nullptr) {
+    try {
+      lastAccess.wait();
+    } catch (cl::Error& err) {
+      LOG_ERROR("Transfer of external memory failed: ", err);
+    }
+  }
 }
 
 KernelArg* GlobalArg::create(void* data, size_t size, bool isOutput)
@@ -23,30 +161,201 @@ KernelArg* GlobalArg::create(size_t size, bool isOutput)
   return new GlobalArg{std::move(vector), isOutput};
 }
 
+KernelArg* GlobalArg::createExternal(void* data, size_t size, bool isOutput)
+{
+  return new GlobalArg{static_cast<char*>(data), size, isOutput};
+}
+
+KernelArg* GlobalArg::createInputFromFile(const std::string& path,
+                                          size_t offset, size_t length)
+{
+  std::unique_ptr<MappedFile> file(new MappedFile(path, offset, length, false));
+  auto arg = new GlobalArg{file->data(), file->size(), false};
+  arg->mappedFile = std::move(file);
+  return arg;
+}
+
+KernelArg* GlobalArg::createOutputToFile(const std::string& path,
+                                         size_t sizeInBytes)
+{
+  std::unique_ptr<MappedFile> file(new MappedFile(path, 0, sizeInBytes, true));
+  auto arg = new GlobalArg{file->data(), file->size(), true};
+  arg->mappedFile = std::move(file);
+  return arg;
+}
+
 const executor::Vector<char>& GlobalArg::data() const
 {
   return vector;
 }
 
+const char* GlobalArg::hostData() const
+{
+  if (isExternal()) {
+    if (!externalHostUpToDate) {
+      externalDownload = externalBuffer.devicePtr()->enqueueRead(externalBuffer,
+                                                                 externalData);
+      externalHostUpToDate = true;
+    }
+    if (externalDownload() != nullptr) {
+      externalDownload.wait();
+      externalDownload = cl::Event();
+    }
+    return externalData;
+  }
+  vector.copyDataToHost();
+  return vector.hostBuffer().data();
+}
+
+void GlobalArg::read(size_t offset, size_t size, void* destination) const
+{
+  ASSERT(offset + size <= sizeInBytes());
+  if (size == 0) return;
+
+  if (hostIsUpToDate()) {
+    std::memcpy(destination, hostData() + offset, size);
+    return;
+  }
+
+  auto& buffer = deviceBuffer();
+  buffer.devicePtr()->enqueueRead(buffer, destination, size, offset).wait();
+}
+
+void GlobalArg::write(size_t offset, size_t size, const void* source)
+{
+  ASSERT(offset + size <= sizeInBytes());
+  if (size == 0) return;
+
+  if (!hostIsUpToDate()) {
+    auto& buffer = deviceBuffer();
+    buffer.devicePtr()->enqueueWrite(buffer, const_cast<void*>(source),
+                                     size, offset).wait();
+    return;
+  }
+
+  if (isExternal()) {
+    // a pending download must not overwrite the new data
+    if (externalDownload() != nullptr) {
+      externalDownload.wait();
+      externalDownload = cl::Event();
+    }
+    std::memcpy(externalData + offset, source, size);
+    if (externalUploaded) {
+      externalBuffer.devicePtr()->enqueueWrite(externalBuffer, externalData,
+                                               size, offset, offset);
+    }
+    return;
+  }
+  std::memcpy(vector.hostBuffer().data() + offset, source, size);
+  vector.markDirty(offset, size);
+}
+
+void GlobalArg::assign(const void* source)
+{
+  if (isExternal()) {
+    // a pending download must not overwrite the new data
+    if (externalDownload() != nullptr) {
+      externalDownload.wait();
+      externalDownload = cl::Event();
+    }
+    std::memcpy(externalData, source, externalSize);
+    externalHostUpToDate = true;
+    externalUploaded = false;
+    return;
+  }
+  std::memcpy(vector.hostBuffer().data(), source, vector.size());
+  vector.dataOnHostModified();
+}
+
+bool GlobalArg::producesOutput() const
+{
+  return isOutput;
+}
+
+size_t GlobalArg::sizeInBytes() const
+{
+  return isExternal() ? externalSize : vector.size();
+}
+
+bool GlobalArg::isExternal() const
+{
+  return externalData != nullptr;
+}
+
+const DeviceBuffer& GlobalArg::deviceBuffer() const
+{
+  if (isExternal()) return externalBuffer;
+  return vector.deviceBuffer();
+}
+
+bool GlobalArg::hostIsUpToDate() const
+{
+  return isExternal() ? externalHostUpToDate : vector.hostIsUpToDate();
+}
+
 void GlobalArg::clear()
 {
+  // clear on the device, so that no zeros have to be uploaded afterwards
   if(isOutput){
-    vector.assign(vector.size());
-    vector.dataOnHostModified();
+    createDeviceBuffer();
+    auto& buffer = deviceBuffer();
+    buffer.devicePtr()->enqueueClear(buffer);
+    if (isExternal()) {
+      externalUploaded = true;
+      externalHostUpToDate = false;
+      return;
+    }
+    vector.dataOnDeviceModified();
   }
 }
 
 void GlobalArg::setAsKernelArg(cl::Kernel kernel, int i)
 {
-  LOG_DEBUG_INFO("Setting GlobalArg with size ", vector.size(), ", at position ", i);
-  auto& devPtr = executor::globalDeviceList.front();
-  kernel.setArg(i, vector.deviceBuffer(*devPtr).clBuffer());
+  LOG_DEBUG_INFO("Setting GlobalArg with size ", sizeInBytes(), ", at position ", i);
+  kernel.setArg(i, deviceBuffer().clBuffer());
+}
+
+void GlobalArg::createDeviceBuffer()
+{
+  if (!isExternal()) {
+    vector.createDeviceBuffers();
+    return;
+  }
+
+  auto devPtr = executor::globalDeviceList.current();
+  if (externalBuffer.isValid() && externalBuffer.devicePtr() != devPtr) {
+    // used on a different device than before, take the data along
+    hostData();
+    externalBuffer = DeviceBuffer();
+    externalUploaded = false;
+  }
+  if (!externalBuffer.isValid()) {
+    externalBuffer = DeviceBuffer(devPtr, externalSize, sizeof(char));
+  }
+}
+
+void GlobalArg::appendWaitList(std::vector<cl::Event>& waitList) const
+{
+  auto& lastAccess = deviceBuffer().lastAccess();
+  if (lastAccess() != nullptr) waitList.push_back(lastAccess);
+}
+
+void GlobalArg::accessedBy(const cl::Event& kernel)
+{
+  deviceBuffer().setLastAccess(kernel);
 }
 
 void GlobalArg::upload()
 {
-  // create buffers on device
-  vector.createDeviceBuffers();
+  createDeviceBuffer();
+  if (isExternal()) {
+    // upload straight from the external memory, without a host copy
+    if (!externalUploaded) {
+      externalBuffer.devicePtr()->enqueueWrite(externalBuffer, externalData);
+      externalUploaded = true;
+    }
+    return;
+  }
   // start upload
   vector.startUpload();
 }
@@ -54,8 +363,16 @@ void GlobalArg::upload()
 void GlobalArg::download()
 {
   if (isOutput) {
+    if (isExternal()) {
+      // the owner reads the external memory directly, without going through
+      // hostData(), so the download is started right away
+      externalDownload = externalBuffer.devicePtr()->enqueueRead(externalBuffer,
+                                                                 externalData);
+      externalHostUpToDate = true;
+      return;
+    }
+    // the actual transfer is deferred until the host accesses the data
     vector.dataOnDeviceModified();
-    vector.copyDataToHost();
   }
 }
 
@@ -1,12 +1,99 @@
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
 #include "Kernel.h"
 
+#include "BinaryCache.h"
+#include "CompilePool.h"
 #include "DeviceList.h"
+#include "ProgramCache.h"
 #include "util/Logger.h"
+#include "util/Metrics.h"
+#include "util/Trace.h"
+
+namespace {
+
+cl::Program buildFromSource(const executor::Device& device,
+                            const std::string& kernelSource,
+                            const std::string& buildOptions)
+{
+  auto p = cl::Program(device.clContext(), cl::Program::Sources(1, std::make_pair(kernelSource.c_str(), kernelSource.length())));
+
+  try {
+    // build program for given device
+    p.build(std::vector<cl::Device>(1, device.clDevice()), buildOptions.c_str());
+
+  } catch (cl::Error& err) {
+    if (err.err() == CL_BUILD_PROGRAM_FAILURE) {
+      LOG_ERROR(err);
+
+      auto  buildLog = p.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device.clDevice() );
+      LOG(executor::Logger::Severity::LogAlways, "Build log:\n", buildLog);
+      
+      ABORT_WITH_ERROR(err);
+    } else {
+      ABORT_WITH_ERROR(err);
+    }
+  }
+
+  return p;
+}
+
+cl::Program buildProgram(const executor::Device& device,
+                         const std::string& kernelSource,
+                         const std::string& buildOptions)
+{
+  TRACE_SPAN("compile", "compile");
+  auto devices = std::vector<cl::Device>(1, device.clDevice());
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  // try to skip the driver compiler by loading a previously built binary
+  auto p = executor::globalBinaryCache.load(device, kernelSource, buildOptions);
+  bool fromBinary = (p() != nullptr);
+  if (fromBinary) {
+    try {
+      p.build(devices, buildOptions.c_str());
+    } catch (cl::Error& err) {
+      LOG_WARNING("Building from cached binary failed (", err,
+                  "), building from source");
+      fromBinary = false;
+    }
+  }
+
+  if (!fromBinary) {
+    p = ::buildFromSource(device, kernelSource, buildOptions);
+    executor::globalBinaryCache.store(device, kernelSource, buildOptions, p);
+  }
+
+  static auto& builds = executor::globalMetrics.counter("build.count");
+  static auto& binaryBuilds = executor::globalMetrics.counter("build.from_binary");
+  static auto& buildTime = executor::globalMetrics.histogram("build.time_us");
+  builds.add();
+  if (fromBinary) binaryBuilds.add();
+  buildTime.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::high_resolution_clock::now() - startTime).count());
+
+  if (executor::globalBinaryCache.isEnabled()) {
+    auto endTime = std::chrono::high_resolution_clock::now();
+    executor::globalBinaryCache.recordBuildTime(fromBinary,
+        std::chrono::duration<double, std::milli>(endTime - startTime).count());
+  }
+
+  return p;
+}
+
+} // namespace
 
 namespace executor {
 
 Kernel::Kernel(std::string kernelSourceP, std::string kernelNameP, std::string buildOptionsP)
-  : kernelSource(kernelSourceP), kernelName(kernelNameP), buildOptions(buildOptionsP), kernel()
+  : kernelSource(kernelSourceP), kernelName(kernelNameP), buildOptions(buildOptionsP), programs(),
+    programsMutex()
 {
 }
 
@@ -17,30 +104,71 @@ Kernel* Kernel::create(std::string kernelSource, std::string kernelName, std::st
 
 cl::Kernel Kernel::build() const
 {
-  if (kernel() != nullptr) return kernel;
+  // creating a kernel object is cheap compared to building the program
+  return cl::Kernel(program(false).get(), kernelName.c_str());
+}
 
-  auto& devPtr = executor::globalDeviceList.front();
+std::shared_future<cl::Program> Kernel::buildAsync() const
+{
+  return program(true);
+}
 
-  auto p = cl::Program(devPtr->clContext(), cl::Program::Sources(1, std::make_pair(kernelSource.c_str(), kernelSource.length())));
+std::shared_future<cl::Program> Kernel::program(bool inBackground) const
+{
+  auto devPtr = executor::globalDeviceList.current();
 
-  try {
-    // build program for given device
-    p.build(std::vector<cl::Device>(1, devPtr->clDevice()), buildOptions.c_str());
+  // the task only holds copies, this object might be disposed before a
+  // background build has finished
+  auto source  = kernelSource;
+  auto options = buildOptions;
+  auto task = std::make_shared<std::packaged_task<cl::Program()>>(
+    [devPtr, source, options] () {
+      // the future hands its exception to every later build() of this
+      // Kernel, so errors are stored by value: the pointer thrown by
+      // ABORT_WITH_ERROR would be deleted by the first catch site
+      try {
+        // programs are shared between all Kernel objects built from the
+        // same source
+        auto p = globalProgramCache.lookup(*devPtr, source, options);
+        if (p() == nullptr) {
+          p = ::buildProgram(*devPtr, source, options);
+          globalProgramCache.insert(*devPtr, source, options, p);
+        }
+        return p;
+      } catch (cl::Error* err) {
+        cl::Error error(*err);
+        delete err;
+        throw error;
+      } catch (std::runtime_error* err) {
+        std::runtime_error error(*err);
+        delete err;
+        throw error;
+      }
+    });
 
-  } catch (cl::Error& err) {
-    if (err.err() == CL_BUILD_PROGRAM_FAILURE) {
-      LOG_ERROR(err);
+  std::shared_future<cl::Program> program;
+  {
+    std::lock_guard<std::mutex> lock(programsMutex);
+    auto it = programs.find(devPtr->uid());
+    if (it != programs.end()) return it->second.program;
 
-      auto  buildLog = p.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devPtr->clDevice() );
-      LOG(executor::Logger::Severity::LogAlways, "Build log:\n", buildLog);
-      
-      ABORT_WITH_ERROR(err);
-    } else {
-      ABORT_WITH_ERROR(err);
+    // release programs of devices which are gone, with their contexts
+    for (auto p = programs.begin(); p != programs.end(); ) {
+      if (p->second.device.expired()) p = programs.erase(p);
+      else ++p;
     }
+    program = task->get_future().share();
+    programs[devPtr->uid()] = DeviceProgram{ devPtr, program };
   }
 
-  return cl::Kernel(p, kernelName.c_str());
+  // other threads needing the same program wait for the future, not for the
+  // lock
+  if (inBackground) {
+    globalCompilePool.submit([task] () { (*task)(); });
+  } else {
+    (*task)();
+  }
+  return program;
 }
 
 std::string Kernel::getSource() const
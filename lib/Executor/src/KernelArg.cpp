@@ -6,4 +6,12 @@ void KernelArg::clear()
 {
 }
 
+void KernelArg::appendWaitList(std::vector<cl::Event>& /*waitList*/) const
+{
+}
+
+void KernelArg::accessedBy(const cl::Event& /*kernel*/)
+{
+}
+
 }
@@ -20,6 +20,11 @@ void LocalArg::setAsKernelArg(cl::Kernel kernel, int i)
   kernel.setArg(i, cl::__local(size)); 
 }
 
+size_t LocalArg::sizeInBytes() const
+{
+  return size;
+}
+
 void LocalArg::upload() {}
 void LocalArg::download() {}
 
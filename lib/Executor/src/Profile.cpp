@@ -0,0 +1,78 @@
+///
+/// \file Profile.cpp
+///
+
+#include <algorithm>
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "Profile.h"
+
+namespace {
+
+thread_local executor::ProfileRecorder* currentRecorder = nullptr;
+
+} // namespace
+
+namespace executor {
+
+ProfileRecorder::ProfileRecorder()
+  : _records(), _enclosing(currentRecorder)
+{
+  currentRecorder = this;
+}
+
+ProfileRecorder::~ProfileRecorder()
+{
+  currentRecorder = _enclosing;
+}
+
+void ProfileRecorder::recordTransfer(CommandProfile::Kind kind,
+                                     const std::vector<cl::Event>& events,
+                                     size_t bytes)
+{
+  if (currentRecorder == nullptr || events.empty()) return;
+  currentRecorder->_records.push_back(Record{kind, events, bytes});
+}
+
+void ProfileRecorder::recordKernel(const cl::Event& event)
+{
+  _records.push_back(Record{CommandProfile::Kernel,
+                            std::vector<cl::Event>(1, event), 0});
+}
+
+std::vector<CommandProfile> ProfileRecorder::commands() const
+{
+  std::vector<CommandProfile> commands;
+  for (auto& record : _records) {
+    cl::Event::waitForEvents(record.events);
+
+    // a staged transfer spans from its first to its last chunk
+    auto& first = record.events.front();
+    auto& last  = record.events.back();
+    CommandProfile command;
+    command.kind      = record.kind;
+    command.bytes     = record.bytes;
+    command.queued    = first.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>();
+    command.submit    = first.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>();
+    command.start     = first.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    command.end       = last.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+    command.gapBefore = 0.0;
+    commands.push_back(command);
+  }
+
+  std::sort(commands.begin(), commands.end(),
+            [](const CommandProfile& lhs, const CommandProfile& rhs) {
+              return lhs.start < rhs.start;
+            });
+  for (size_t i = 1; i < commands.size(); ++i) {
+    commands[i].gapBefore = (static_cast<double>(commands[i].start)
+                             - static_cast<double>(commands[i-1].end)) * 1.0e-06;
+  }
+  return commands;
+}
+
+} // namespace executor
@@ -0,0 +1,128 @@
+///
+/// \file ProgramCache.cpp
+///
+
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "util/Hash.h"
+#include "util/Logger.h"
+
+#include "ProgramCache.h"
+#include "Device.h"
+
+namespace executor {
+
+ProgramCache globalProgramCache;
+
+ProgramCache::ProgramCache()
+  : _mutex(), _capacity(256), _entries(), _index(), _hits(0), _misses(0)
+{
+}
+
+void ProgramCache::setCapacity(size_t maxPrograms)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _capacity = maxPrograms;
+  shrink();
+}
+
+size_t ProgramCache::capacity() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _capacity;
+}
+
+std::string ProgramCache::makeKey(const Device& device,
+                                  const std::string& source,
+                                  const std::string& buildOptions)
+{
+  std::ostringstream s;
+  s << device.uid() << ":"
+    << util::hashToString(util::hash(buildOptions, util::hash(source)));
+  return s.str();
+}
+
+cl::Program ProgramCache::lookup(const Device& device,
+                                 const std::string& source,
+                                 const std::string& buildOptions)
+{
+  auto key = makeKey(device, source, buildOptions);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _index.find(key);
+  if (it == _index.end()
+      || it->second->source != source
+      || it->second->buildOptions != buildOptions) {
+    ++_misses;
+    return cl::Program();
+  }
+
+  // move to the front of the LRU list
+  _entries.splice(_entries.begin(), _entries, it->second);
+  ++_hits;
+  LOG_DEBUG_INFO("Reusing cached program for key ", key);
+  return _entries.front().program;
+}
+
+void ProgramCache::insert(const Device& device,
+                          const std::string& source,
+                          const std::string& buildOptions,
+                          const cl::Program& program)
+{
+  auto key = makeKey(device, source, buildOptions);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_capacity == 0) return;
+
+  auto it = _index.find(key);
+  if (it != _index.end()) {
+    // replace, e.g. a colliding entry or a program built concurrently
+    _entries.erase(it->second);
+    _index.erase(it);
+  }
+  _entries.push_front(Entry{ key, source, buildOptions, program });
+  _index[key] = _entries.begin();
+  shrink();
+}
+
+void ProgramCache::purge()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  LOG_DEBUG_INFO("Purging ", _entries.size(), " cached programs");
+  _index.clear();
+  _entries.clear();
+}
+
+void ProgramCache::shrink()
+{
+  while (_entries.size() > _capacity) {
+    _index.erase(_entries.back().key);
+    _entries.pop_back();
+  }
+}
+
+size_t ProgramCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+unsigned long ProgramCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _hits;
+}
+
+unsigned long ProgramCache::misses() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _misses;
+}
+
+} // namespace executor
@@ -0,0 +1,158 @@
+///
+/// \file StagingRing.cpp
+///
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "util/Assert.h"
+#include "util/Logger.h"
+
+#include "StagingRing.h"
+
+namespace executor {
+
+StagingRing::StagingRing(const cl::Context& context,
+                         const cl::CommandQueue& uploadQueue,
+                         const cl::CommandQueue& downloadQueue,
+                         size_t chunkSize, size_t numChunks)
+  : _uploadQueue(uploadQueue), _downloadQueue(downloadQueue),
+    _chunkSize(chunkSize), _chunks()
+{
+  ASSERT(chunkSize > 0);
+  ASSERT(numChunks > 0);
+  try {
+    for (size_t i = 0; i < numChunks; ++i) {
+      Chunk chunk;
+      chunk.buffer = cl::Buffer(context,
+                                CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+                                chunkSize);
+      // keep mapped for the lifetime of the ring
+      chunk.hostPointer = _uploadQueue.enqueueMapBuffer(chunk.buffer, CL_TRUE,
+                                                        CL_MAP_READ
+                                                        | CL_MAP_WRITE,
+                                                        0, chunkSize);
+      _chunks.push_back(chunk);
+    }
+  } catch (cl::Error& err) {
+    ABORT_WITH_ERROR(err);
+  }
+  LOG_DEBUG_INFO("Created staging ring with ", numChunks, " pinned chunks of ",
+                 chunkSize, " bytes");
+}
+
+StagingRing::~StagingRing()
+{
+  try {
+    // pending reads into the chunks have to finish before they are unmapped
+    _downloadQueue.finish();
+    for (auto& chunk : _chunks) {
+      _uploadQueue.enqueueUnmapMemObject(chunk.buffer, chunk.hostPointer);
+    }
+    _uploadQueue.finish();
+  } catch (cl::Error& err) {
+    LOG_ERROR(err);
+  }
+}
+
+std::vector<cl::Event> StagingRing::write(const cl::Buffer& buffer,
+                                          size_t deviceOffset,
+                                          size_t size,
+                                          const void* hostPointer,
+                                          const std::vector<cl::Event>& waitList)
+{
+  std::vector<cl::Event> events;
+  auto source = static_cast<const char*>(hostPointer);
+  try {
+    for (size_t offset = 0, i = 0; offset < size; offset += _chunkSize, ++i) {
+      auto& chunk = _chunks[i % _chunks.size()];
+      auto length = std::min(_chunkSize, size - offset);
+
+      // wait until the DMA transfer of the previous use of this chunk is done
+      if (chunk.lastUse() != nullptr) chunk.lastUse.wait();
+
+      std::memcpy(chunk.hostPointer, source + offset, length);
+
+      cl::Event event;
+      // the queue is in order, only the first chunk has to wait explicitly
+      _uploadQueue.enqueueWriteBuffer(buffer, CL_FALSE, deviceOffset + offset,
+                                      length, chunk.hostPointer,
+                                      i == 0 ? &waitList : NULL, &event);
+      _uploadQueue.flush(); // start the transfer while copying the next chunk
+      chunk.lastUse = event;
+      events.push_back(event);
+    }
+  } catch (cl::Error& err) {
+    ABORT_WITH_ERROR(err);
+  }
+  return events;
+}
+
+std::vector<cl::Event> StagingRing::read(const cl::Buffer& buffer,
+                                         size_t deviceOffset,
+                                         size_t size,
+                                         void* hostPointer,
+                                         const std::vector<cl::Event>& waitList)
+{
+  std::vector<cl::Event> events;
+  auto destination = static_cast<char*>(hostPointer);
+  const size_t numTransfers = (size + _chunkSize - 1) / _chunkSize;
+
+  auto enqueueChunk = [&](size_t i) {
+    auto& chunk = _chunks[i % _chunks.size()];
+    auto offset = i * _chunkSize;
+    // the queue is in order, only the first chunk has to wait for waitList;
+    // every chunk waits for a write from it which might still be pending in
+    // the upload queue
+    std::vector<cl::Event> chunkWaitList;
+    if (i == 0) chunkWaitList = waitList;
+    if (chunk.lastUse() != nullptr) chunkWaitList.push_back(chunk.lastUse);
+    cl::Event event;
+    _downloadQueue.enqueueReadBuffer(buffer, CL_FALSE, deviceOffset + offset,
+                                     std::min(_chunkSize, size - offset),
+                                     chunk.hostPointer,
+                                     chunkWaitList.empty() ? NULL
+                                                           : &chunkWaitList,
+                                     &event);
+    chunk.lastUse = event;
+    events.push_back(event);
+  };
+
+  try {
+    // fill the ring ...
+    for (size_t i = 0; i < std::min(numTransfers, _chunks.size()); ++i) {
+      enqueueChunk(i);
+    }
+    _downloadQueue.flush();
+
+    // ... and drain it, refilling each chunk as soon as it has been copied
+    for (size_t i = 0; i < numTransfers; ++i) {
+      auto& chunk = _chunks[i % _chunks.size()];
+      chunk.lastUse.wait();
+
+      auto offset = i * _chunkSize;
+      std::memcpy(destination + offset, chunk.hostPointer,
+                  std::min(_chunkSize, size - offset));
+
+      if (i + _chunks.size() < numTransfers) {
+        enqueueChunk(i + _chunks.size());
+        _downloadQueue.flush();
+      }
+    }
+  } catch (cl::Error& err) {
+    ABORT_WITH_ERROR(err);
+  }
+  return events;
+}
+
+size_t StagingRing::chunkSize() const
+{
+  return _chunkSize;
+}
+
+} // namespace executor
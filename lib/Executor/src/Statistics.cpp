@@ -0,0 +1,139 @@
+///
+/// \file Statistics.cpp
+///
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "util/Assert.h"
+
+#include "Statistics.h"
+
+namespace {
+
+// Linear interpolation between the closest ranks of the sorted values
+double percentile(const std::vector<double>& sorted, double p)
+{
+  auto rank = p * (sorted.size() - 1);
+  auto lower = static_cast<size_t>(std::floor(rank));
+  auto upper = std::min(lower + 1, sorted.size() - 1);
+  return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+}
+
+// Quantile of the standard normal distribution, using the rational
+// approximation 26.2.23 of Abramowitz and Stegun (error below 4.5e-4)
+double normalQuantile(double p)
+{
+  auto tail = p < 0.5 ? p : 1.0 - p;
+  auto t = std::sqrt(-2.0 * std::log(tail));
+  auto z = t - (2.515517 + 0.802853 * t + 0.010328 * t * t)
+             / (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+  return p < 0.5 ? -z : z;
+}
+
+// Quantile of Student's t-distribution with the given degrees of freedom,
+// exact for 1 and 2 degrees of freedom and using the expansion 26.7.5 of
+// Abramowitz and Stegun otherwise (relative error below 1% for p <= 0.995)
+double studentQuantile(double p, size_t degreesOfFreedom)
+{
+  const double pi = 3.14159265358979323846;
+  if (degreesOfFreedom == 1) return std::tan(pi * (p - 0.5));
+  if (degreesOfFreedom == 2) {
+    return (2.0 * p - 1.0) / std::sqrt(2.0 * p * (1.0 - p));
+  }
+
+  auto x  = normalQuantile(p);
+  auto x2 = x * x;
+  auto g1 = (x2 + 1.0) * x / 4.0;
+  auto g2 = ((5.0 * x2 + 16.0) * x2 + 3.0) * x / 96.0;
+  auto g3 = (((3.0 * x2 + 19.0) * x2 + 17.0) * x2 - 15.0) * x / 384.0;
+  auto g4 = ((((79.0 * x2 + 776.0) * x2 + 1482.0) * x2 - 1920.0) * x2
+             - 945.0) * x / 92160.0;
+  double v = static_cast<double>(degreesOfFreedom);
+  return x + g1 / v + g2 / (v * v) + g3 / (v * v * v) + g4 / (v * v * v * v);
+}
+
+} // namespace
+
+namespace executor {
+
+BenchmarkOptions::BenchmarkOptions()
+  : warmupIterations(3), minIterations(10), maxIterations(1000),
+    targetRelativeError(0.01), confidenceLevel(0.95), outlierThreshold(3.5),
+    timeout(0.0), clearOutputs(true)
+{
+}
+
+BenchmarkSummary::BenchmarkSummary()
+  : runtimes(), outliers(0), mean(0), median(0), p5(0), p95(0), stdDev(0),
+    ciLow(0), ciHigh(0), converged(false)
+{
+}
+
+EvaluationResult::EvaluationResult()
+  : status(Completed), runtime(0), estimate(0), probeFraction(0),
+    privateMemory(0), runtimes()
+{
+}
+
+BenchmarkSummary summarize(const std::vector<double>& runtimes,
+                           double confidenceLevel, double outlierThreshold)
+{
+  ASSERT(confidenceLevel > 0.0 && confidenceLevel < 1.0);
+  BenchmarkSummary s;
+  s.runtimes = runtimes;
+  if (runtimes.empty()) return s;
+
+  std::vector<double> sorted(runtimes);
+  std::sort(sorted.begin(), sorted.end());
+
+  // reject outliers by their distance to the median, scaled by the median
+  // absolute deviation, which unlike the standard deviation is not inflated
+  // by the outliers themselves
+  if (outlierThreshold > 0.0) {
+    auto median = percentile(sorted, 0.5);
+    std::vector<double> deviations;
+    for (auto r : sorted) deviations.push_back(std::fabs(r - median));
+    std::sort(deviations.begin(), deviations.end());
+    auto mad = percentile(deviations, 0.5);
+    if (mad > 0.0) {
+      auto isOutlier = [&] (double r) {
+        return 0.6745 * std::fabs(r - median) / mad > outlierThreshold;
+      };
+      auto end = std::remove_if(sorted.begin(), sorted.end(), isOutlier);
+      s.outliers = sorted.end() - end;
+      sorted.erase(end, sorted.end());
+    }
+  }
+
+  auto n = sorted.size();
+  double sum = 0.0;
+  for (auto r : sorted) sum += r;
+  s.mean = sum / n;
+
+  double squares = 0.0;
+  for (auto r : sorted) squares += (r - s.mean) * (r - s.mean);
+  s.stdDev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+
+  s.median = percentile(sorted, 0.5);
+  s.p5     = percentile(sorted, 0.05);
+  s.p95    = percentile(sorted, 0.95);
+
+  if (n < 2) {
+    // a single run says nothing about the spread
+    s.ciLow  = -std::numeric_limits<double>::infinity();
+    s.ciHigh =  std::numeric_limits<double>::infinity();
+    return s;
+  }
+  // the standard deviation is estimated from the sample, so the interval
+  // follows the t-distribution, which is considerably wider for few runs
+  auto t = studentQuantile(0.5 + confidenceLevel / 2.0, n - 1);
+  auto halfWidth = t * s.stdDev / std::sqrt(static_cast<double>(n));
+  s.ciLow  = s.mean - halfWidth;
+  s.ciHigh = s.mean + halfWidth;
+  return s;
+}
+
+} // namespace executor
@@ -23,6 +23,11 @@ void ValueArg::setAsKernelArg(cl::Kernel kernel, int i)
   kernel.setArg(i, value.size(), value.data());
 }
 
+const std::vector<char>& ValueArg::data() const
+{
+  return value;
+}
+
 void ValueArg::upload() {}
 void ValueArg::download() {}
 
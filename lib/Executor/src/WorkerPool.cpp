@@ -0,0 +1,421 @@
+///
+/// \file WorkerPool.cpp
+///
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "util/Logger.h"
+
+#include "GlobalArg.h"
+#include "LocalArg.h"
+#include "ValueArg.h"
+#include "WorkerPool.h"
+#include "WorkerProtocol.h"
+
+namespace {
+
+// arguments are placed at multiples of this in the shared memory
+const size_t argAlignment = 64;
+
+// the descriptor of its socket in a worker process
+const int workerSocket = 3;
+
+std::atomic<unsigned long> segmentCounter(0);
+
+///
+/// A shared memory segment which is unmapped and unlinked when it goes out
+/// of scope, no matter how the job ended
+///
+class SharedMemory {
+public:
+  explicit SharedMemory(size_t size)
+    : _name(), _data(nullptr), _size(size == 0 ? 1 : size)
+  {
+    _name = "/lift-executor-" + std::to_string(::getpid()) + "-"
+          + std::to_string(segmentCounter++);
+    int fd = ::shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      throw std::runtime_error("shm_open failed: "
+                               + std::string(std::strerror(errno)));
+    }
+    if (::ftruncate(fd, _size) != 0) {
+      ::close(fd);
+      ::shm_unlink(_name.c_str());
+      throw std::runtime_error("ftruncate failed: "
+                               + std::string(std::strerror(errno)));
+    }
+    auto data = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      ::shm_unlink(_name.c_str());
+      throw std::runtime_error("mmap failed: "
+                               + std::string(std::strerror(errno)));
+    }
+    _data = static_cast<char*>(data);
+  }
+
+  ~SharedMemory()
+  {
+    ::munmap(_data, _size);
+    ::shm_unlink(_name.c_str());
+  }
+
+  const std::string& name() const { return _name; }
+  char* data() const { return _data; }
+  size_t size() const { return _size; }
+
+private:
+  SharedMemory(const SharedMemory&);// = delete;
+  SharedMemory& operator=(const SharedMemory&);// = delete;
+
+  std::string _name;
+  char*       _data;
+  size_t      _size;
+};
+
+} // namespace
+
+namespace executor {
+
+namespace worker {
+
+bool readFully(int fd, void* data, size_t size)
+{
+  auto ptr = static_cast<char*>(data);
+  while (size > 0) {
+    auto n = ::read(fd, ptr, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    ptr  += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool writeFully(int fd, const void* data, size_t size)
+{
+  auto ptr = static_cast<const char*>(data);
+  while (size > 0) {
+#ifdef MSG_NOSIGNAL
+    auto n = ::send(fd, ptr, size, MSG_NOSIGNAL);
+#else
+    auto n = ::write(fd, ptr, size);
+#endif
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    ptr  += n;
+    size -= n;
+  }
+  return true;
+}
+
+} // namespace worker
+
+WorkerPool globalWorkerPool;
+
+WorkerPool::WorkerPool()
+  : _mutex(), _condition(), _idle(), _workerPath(), _numWorkers(0),
+    _numAlive(0), _platformId(0), _deviceId(0), _numLost(0)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+  stop();
+}
+
+void WorkerPool::start(const std::string& workerPath, size_t numWorkers,
+                       int platformId, int deviceId)
+{
+  stop();
+  std::lock_guard<std::mutex> lock(_mutex);
+  _workerPath = workerPath;
+  _numWorkers = numWorkers == 0 ? 1 : numWorkers;
+  _platformId = platformId;
+  _deviceId   = deviceId;
+}
+
+void WorkerPool::stop()
+{
+  std::vector<Worker> idle;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    idle.swap(_idle);
+    _numAlive -= idle.size();
+    _numWorkers = 0;
+  }
+  for (auto& worker : idle) {
+    // the worker exits as soon as it reads the end of the stream
+    ::close(worker.socket);
+    ::waitpid(worker.pid, nullptr, 0);
+  }
+}
+
+double WorkerPool::execute(const Kernel& kernel,
+                           int localSize1, int localSize2, int localSize3,
+                           int globalSize1, int globalSize2, int globalSize3,
+                           const std::vector<KernelArg*>& args,
+                           double deadlineInMilliseconds)
+{
+  using namespace worker;
+  using clock = std::chrono::steady_clock;
+  auto deadline = clock::now()
+                + std::chrono::microseconds(
+                    static_cast<long long>(deadlineInMilliseconds * 1000.0));
+
+  // lay out the arguments in the shared memory
+  std::vector<ArgDescriptor> descriptors(args.size());
+  size_t total = 0;
+  for (size_t i = 0; i < args.size(); ++i) {
+    auto& d = descriptors[i];
+    d.padding = 0;
+    d.offset  = total;
+    if (auto g = dynamic_cast<GlobalArg*>(args[i])) {
+      d.kind = g->producesOutput() ? ArgOutput : ArgInput;
+      d.size = g->sizeInBytes();
+    } else if (auto l = dynamic_cast<LocalArg*>(args[i])) {
+      d.kind = ArgLocal;
+      d.size = l->sizeInBytes();
+      continue; // no data
+    } else if (auto v = dynamic_cast<ValueArg*>(args[i])) {
+      d.kind = ArgValue;
+      d.size = v->data().size();
+    } else {
+      throw WorkerError("unsupported kernel argument", false);
+    }
+    total += (d.size + argAlignment - 1) / argAlignment * argAlignment;
+  }
+
+  SharedMemory memory(total);
+  for (size_t i = 0; i < args.size(); ++i) {
+    auto& d = descriptors[i];
+    if (d.kind == ArgInput || d.kind == ArgOutput) {
+      auto g = static_cast<GlobalArg*>(args[i]);
+      std::memcpy(memory.data() + d.offset, g->hostData(), d.size);
+    } else if (d.kind == ArgValue) {
+      auto v = static_cast<ValueArg*>(args[i]);
+      std::memcpy(memory.data() + d.offset, v->data().data(), d.size);
+    }
+  }
+
+  auto source  = kernel.getSource();
+  auto name    = kernel.getName();
+  auto options = kernel.getBuildOptions();
+
+  JobHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic          = jobMagic;
+  header.sourceLength   = source.size();
+  header.nameLength     = name.size();
+  header.optionsLength  = options.size();
+  header.localSize[0]   = localSize1;
+  header.localSize[1]   = localSize2;
+  header.localSize[2]   = localSize3;
+  header.globalSize[0]  = globalSize1;
+  header.globalSize[1]  = globalSize2;
+  header.globalSize[2]  = globalSize3;
+  header.numArgs        = args.size();
+  header.sharedMemorySize = memory.size();
+  std::strncpy(header.sharedMemoryName, memory.name().c_str(),
+               sizeof(header.sharedMemoryName) - 1);
+
+  auto worker = acquire();
+
+  if (!writeFully(worker.socket, &header, sizeof(header))
+      || !writeFully(worker.socket, source.data(), source.size())
+      || !writeFully(worker.socket, name.data(), name.size())
+      || !writeFully(worker.socket, options.data(), options.size())
+      || !writeFully(worker.socket, descriptors.data(),
+                     descriptors.size() * sizeof(ArgDescriptor))) {
+    discard(worker);
+    throw WorkerError("worker " + std::to_string(worker.pid)
+                      + " died before receiving the job", false);
+  }
+
+  // wait for the reply, but not longer than the deadline
+  JobReply reply;
+  auto replyPtr = reinterpret_cast<char*>(&reply);
+  size_t received = 0;
+  while (received < sizeof(reply)) {
+    int timeout = -1;
+    if (deadlineInMilliseconds > 0) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         deadline - clock::now()).count();
+      timeout = remaining < 0 ? 0 : static_cast<int>(remaining);
+    }
+    pollfd fd;
+    fd.fd      = worker.socket;
+    fd.events  = POLLIN;
+    fd.revents = 0;
+    auto ready = ::poll(&fd, 1, timeout);
+    if (ready < 0 && errno == EINTR) continue;
+    if (ready == 0) {
+      LOG_WARNING("Worker ", worker.pid, " exceeded the deadline of ",
+                  deadlineInMilliseconds, " ms, killing it");
+      discard(worker);
+      throw WorkerError("kernel " + name + " exceeded the deadline of "
+                        + std::to_string(deadlineInMilliseconds) + " ms",
+                        true);
+    }
+    ssize_t n = ready < 0 ? -1
+              : ::read(worker.socket, replyPtr + received,
+                       sizeof(reply) - received);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      LOG_WARNING("Worker ", worker.pid, " died while executing ", name);
+      discard(worker);
+      throw WorkerError("worker crashed while executing kernel " + name,
+                        false);
+    }
+    received += n;
+  }
+  release(worker);
+
+  if (reply.status != 0) {
+    throw cl::Error(reply.status, "executor-worker");
+  }
+
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (descriptors[i].kind == ArgOutput) {
+      static_cast<GlobalArg*>(args[i])->assign(memory.data()
+                                               + descriptors[i].offset);
+    }
+  }
+  return reply.runtime;
+}
+
+unsigned long WorkerPool::numLostWorkers() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _numLost;
+}
+
+WorkerPool::Worker WorkerPool::acquire()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (_numWorkers == 0) {
+    throw WorkerError("the worker pool has not been started", false);
+  }
+  _condition.wait(lock, [this] {
+    return !_idle.empty() || _numAlive < _numWorkers;
+  });
+  if (!_idle.empty()) {
+    auto worker = _idle.back();
+    _idle.pop_back();
+    return worker;
+  }
+  ++_numAlive;
+  lock.unlock();
+
+  try {
+    return spawn();
+  } catch (...) {
+    lock.lock();
+    --_numAlive;
+    _condition.notify_one();
+    throw;
+  }
+}
+
+void WorkerPool::release(const Worker& worker)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_numWorkers != 0) {
+      _idle.push_back(worker);
+      _condition.notify_one();
+      return;
+    }
+    // the pool has been stopped while the worker was busy
+    --_numAlive;
+  }
+  ::close(worker.socket);
+  ::waitpid(worker.pid, nullptr, 0);
+}
+
+void WorkerPool::discard(const Worker& worker)
+{
+  ::kill(worker.pid, SIGKILL);
+  ::waitpid(worker.pid, nullptr, 0);
+  ::close(worker.socket);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  ++_numLost;
+  --_numAlive;
+  _condition.notify_one();
+}
+
+WorkerPool::Worker WorkerPool::spawn() const
+{
+  // neither end may be inherited by workers forked concurrently by other
+  // threads, otherwise closing a socket would not end the stream
+  int sockets[2];
+#ifdef SOCK_CLOEXEC
+  auto status = ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets);
+#else
+  auto status = ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+  if (status == 0) {
+    ::fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+  }
+#endif
+  if (status != 0) {
+    throw WorkerError("socketpair failed: "
+                      + std::string(std::strerror(errno)), false);
+  }
+
+  // everything the child needs is prepared before forking, only async
+  // signal safe functions may be called in between fork and exec
+  auto socketArg   = std::to_string(workerSocket);
+  auto platformArg = std::to_string(_platformId);
+  auto deviceArg   = std::to_string(_deviceId);
+  const char* argv[] = { _workerPath.c_str(), socketArg.c_str(),
+                         platformArg.c_str(), deviceArg.c_str(), nullptr };
+
+  auto pid = ::fork();
+  if (pid < 0) {
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+    throw WorkerError("fork failed: " + std::string(std::strerror(errno)),
+                      false);
+  }
+  if (pid == 0) {
+    // only the worker's end is inherited, at a fixed descriptor; dup2 clears
+    // close-on-exec, unless the descriptor is already in place
+    if (sockets[1] == workerSocket) {
+      ::fcntl(workerSocket, F_SETFD, 0);
+    } else if (::dup2(sockets[1], workerSocket) < 0) {
+      ::_exit(127);
+    }
+    ::execv(argv[0], const_cast<char* const*>(argv));
+    ::_exit(127);
+  }
+  ::close(sockets[1]);
+  LOG_DEBUG_INFO("Started worker ", pid, " (", _workerPath, ")");
+
+  Worker worker;
+  worker.pid    = pid;
+  worker.socket = sockets[0];
+  return worker;
+}
+
+} // namespace executor
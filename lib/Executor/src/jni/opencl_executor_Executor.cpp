@@ -1,3 +1,5 @@
+#include <cmath>
+#include <memory>
 #include <string>
 #include <vector>
 #include <limits>
@@ -5,6 +7,7 @@
 #include <algorithm>
 #include <thread>
 #include <cassert>
+#include <stdexcept>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Weffc++"
@@ -13,12 +16,41 @@
 #include "Handle.h"
 #include "Executor.h"
 #include "util/Logger.h"
+#include "util/Trace.h"
 
 enum class Mode {
   Execute,
   Evaluate
 };
 
+// Throws an IllegalArgumentException and returns false if value is negative
+template <typename T>
+bool checkNotNegative(JNIEnv* env, T value, const char* name)
+{
+  if (value >= 0) return true;
+  env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                (std::string(name) + " must not be negative, got "
+                 + std::to_string(value)).c_str());
+  return false;
+}
+
+// Creates an opencl.executor.BenchmarkStatistics holding summary
+jobject newBenchmarkStatistics(JNIEnv* env,
+                               const executor::BenchmarkSummary& summary)
+{
+  auto jRuntimes = env->NewDoubleArray(summary.runtimes.size());
+  env->SetDoubleArrayRegion(jRuntimes, 0, summary.runtimes.size(),
+                            summary.runtimes.data());
+
+  auto cls = env->FindClass("opencl/executor/BenchmarkStatistics");
+  auto methodID = env->GetMethodID(cls, "<init>", "([DIDDDDDDDZ)V");
+  return env->NewObject(cls, methodID, jRuntimes,
+                        static_cast<jint>(summary.outliers),
+                        summary.mean, summary.median, summary.p5, summary.p95,
+                        summary.stdDev, summary.ciLow, summary.ciHigh,
+                        static_cast<jboolean>(summary.converged));
+}
+
 jdouble
   executeOrEvaluate(JNIEnv* env, jclass,
                     jobject jKernel,
@@ -31,6 +63,8 @@ jdouble
 {
   double runtime = 0;
 
+  executor::TraceSpan span(mode == Mode::Execute ? "Executor.execute"
+                                                 : "Executor.evaluate", "jni");
   try {
     
     auto kernel = getHandle<executor::Kernel>(env, jKernel);
@@ -138,19 +172,25 @@ jdouble
         jArgs, Mode::Execute, 0, 0.0);
 }
 
+enum class BenchmarkMode {
+  Default,
+  Resident,
+  ResidentClearingOutputs
+};
+
 jdoubleArray
-  Java_opencl_executor_Executor_benchmark(
-    JNIEnv* env,
-    jclass,
-    jobject jKernel,
-    jint localSize1, jint localSize2, jint localSize3,
-    jint globalSize1, jint globalSize2, jint globalSize3,
-    jobjectArray jArgs,
-    jint iterations,
-    jdouble timeout)
+  benchmarkWithMode(JNIEnv* env,
+                    jobject jKernel,
+                    jint localSize1, jint localSize2, jint localSize3,
+                    jint globalSize1, jint globalSize2, jint globalSize3,
+                    jobjectArray jArgs,
+                    jint iterations,
+                    jdouble timeout,
+                    BenchmarkMode mode)
 {
   std::vector<double> runtimes;
 
+  TRACE_SPAN("Executor.benchmark", "jni");
   try {
     
     auto kernel = getHandle<executor::Kernel>(env, jKernel);
@@ -163,9 +203,16 @@ jdoubleArray
       ++i;
     }
 
-    benchmark(*kernel,
-      localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
-      args, iterations, timeout, runtimes);
+    if (mode == BenchmarkMode::Default) {
+      benchmark(*kernel,
+        localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+        args, iterations, timeout, runtimes);
+    } else {
+      benchmarkResident(*kernel,
+        localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+        args, iterations, timeout,
+        mode == BenchmarkMode::ResidentClearingOutputs, runtimes);
+    }
 
   } catch(cl::Error err) {
     jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
@@ -190,6 +237,365 @@ jdoubleArray
   }
 }
 
+jdoubleArray
+  Java_opencl_executor_Executor_executePipeline(JNIEnv* env, jclass,
+                                                jobjectArray jKernels,
+                                                jintArray jSizes,
+                                                jobjectArray jArgs)
+{
+  std::vector<double> runtimes;
+
+  TRACE_SPAN("Executor.executePipeline", "jni");
+  try {
+
+    std::vector<const executor::Kernel*> kernels(env->GetArrayLength(jKernels));
+    std::vector<std::vector<executor::KernelArg*>> args(kernels.size());
+    for (size_t i = 0; i < kernels.size(); ++i) {
+      auto obj = env->GetObjectArrayElement(jKernels, i);
+      kernels[i] = getHandle<executor::Kernel>(env, obj);
+
+      auto jStageArgs = static_cast<jobjectArray>(
+                          env->GetObjectArrayElement(jArgs, i));
+      args[i].resize(env->GetArrayLength(jStageArgs));
+      int j = 0;
+      for (auto& p : args[i]) {
+        auto argObj = env->GetObjectArrayElement(jStageArgs, j);
+        p = getHandle<executor::KernelArg>(env, argObj);
+        ++j;
+      }
+    }
+
+    std::vector<int> sizes(env->GetArrayLength(jSizes));
+    env->GetIntArrayRegion(jSizes, 0, sizes.size(), sizes.data());
+
+    runtimes = executePipeline(kernels, sizes, args);
+
+  } catch(cl::Error& err) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + err.what()).c_str());
+    return nullptr;
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+    return nullptr;
+  }
+
+  auto jRuntimes = env->NewDoubleArray(runtimes.size());
+  env->SetDoubleArrayRegion(jRuntimes, 0, runtimes.size(), runtimes.data());
+  return jRuntimes;
+}
+
+jdoubleArray
+  Java_opencl_executor_Executor_benchmark(
+    JNIEnv* env,
+    jclass,
+    jobject jKernel,
+    jint localSize1, jint localSize2, jint localSize3,
+    jint globalSize1, jint globalSize2, jint globalSize3,
+    jobjectArray jArgs,
+    jint iterations,
+    jdouble timeout)
+{
+  return benchmarkWithMode(env, jKernel,
+        localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+        jArgs, iterations, timeout, BenchmarkMode::Default);
+}
+
+jdoubleArray
+  Java_opencl_executor_Executor_benchmarkResident(
+    JNIEnv* env,
+    jclass,
+    jobject jKernel,
+    jint localSize1, jint localSize2, jint localSize3,
+    jint globalSize1, jint globalSize2, jint globalSize3,
+    jobjectArray jArgs,
+    jint iterations,
+    jdouble timeout,
+    jboolean clearOutputs)
+{
+  return benchmarkWithMode(env, jKernel,
+        localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+        jArgs, iterations, timeout,
+        clearOutputs ? BenchmarkMode::ResidentClearingOutputs
+                     : BenchmarkMode::Resident);
+}
+
+jobject
+  Java_opencl_executor_Executor_benchmarkStatistics(
+    JNIEnv* env,
+    jclass,
+    jobject jKernel,
+    jint localSize1, jint localSize2, jint localSize3,
+    jint globalSize1, jint globalSize2, jint globalSize3,
+    jobjectArray jArgs,
+    jint warmupIterations, jint minIterations, jint maxIterations,
+    jdouble targetRelativeError, jdouble confidenceLevel,
+    jdouble outlierThreshold, jdouble timeout, jboolean clearOutputs)
+{
+  executor::BenchmarkSummary summary;
+
+  TRACE_SPAN("Executor.benchmarkStatistics", "jni");
+  try {
+
+    auto kernel = getHandle<executor::Kernel>(env, jKernel);
+
+    std::vector<executor::KernelArg*> args(env->GetArrayLength(jArgs));
+    int i = 0;
+    for (auto& p : args) {
+      auto obj = env->GetObjectArrayElement(jArgs, i);
+      p = getHandle<executor::KernelArg>(env, obj);
+      ++i;
+    }
+
+    executor::BenchmarkOptions options;
+    options.warmupIterations    = warmupIterations;
+    options.minIterations       = minIterations;
+    options.maxIterations       = maxIterations;
+    options.targetRelativeError = targetRelativeError;
+    options.confidenceLevel     = confidenceLevel;
+    options.outlierThreshold    = outlierThreshold;
+    options.timeout             = timeout;
+    options.clearOutputs        = clearOutputs;
+
+    summary = benchmarkAdaptive(*kernel,
+      localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+      args, options);
+
+  } catch(cl::Error& err) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + err.what()).c_str());
+    return nullptr;
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+    return nullptr;
+  }
+
+  return newBenchmarkStatistics(env, summary);
+}
+
+jobject
+  Java_opencl_executor_Executor_summarize(JNIEnv* env, jclass,
+                                          jdoubleArray jRuntimes,
+                                          jdouble confidenceLevel,
+                                          jdouble outlierThreshold)
+{
+  if (!(confidenceLevel > 0.0 && confidenceLevel < 1.0)) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  ("confidenceLevel must be between 0 and 1, got "
+                   + std::to_string(confidenceLevel)).c_str());
+    return nullptr;
+  }
+
+  std::vector<double> runtimes(env->GetArrayLength(jRuntimes));
+  env->GetDoubleArrayRegion(jRuntimes, 0, runtimes.size(), runtimes.data());
+
+  return newBenchmarkStatistics(env,
+           executor::summarize(runtimes, confidenceLevel, outlierThreshold));
+}
+
+jobject
+  Java_opencl_executor_Executor_executeProfiled(JNIEnv* env, jclass,
+                                                jobject jKernel,
+                                                jint localSize1, jint localSize2, jint localSize3,
+                                                jint globalSize1, jint globalSize2, jint globalSize3,
+                                                jobjectArray jArgs)
+{
+  executor::ExecutionProfile profile;
+
+  TRACE_SPAN("Executor.executeProfiled", "jni");
+  try {
+
+    auto kernel = getHandle<executor::Kernel>(env, jKernel);
+
+    std::vector<executor::KernelArg*> args(env->GetArrayLength(jArgs));
+    int i = 0;
+    for (auto& p : args) {
+      auto obj = env->GetObjectArrayElement(jArgs, i);
+      p = getHandle<executor::KernelArg>(env, obj);
+      ++i;
+    }
+
+    profile = executeProfiled(*kernel,
+      localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+      args);
+
+  } catch(cl::Error& err) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + err.what()).c_str());
+    return nullptr;
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+    return nullptr;
+  }
+
+  auto commandCls = env->FindClass("opencl/executor/ExecutionProfile$Command");
+  auto commandInit = env->GetMethodID(commandCls, "<init>", "(IJJJJJD)V");
+  auto jCommands = env->NewObjectArray(profile.commands.size(), commandCls,
+                                       nullptr);
+  for (size_t i = 0; i < profile.commands.size(); ++i) {
+    auto& c = profile.commands[i];
+    auto jCommand = env->NewObject(commandCls, commandInit,
+                                   static_cast<jint>(c.kind),
+                                   static_cast<jlong>(c.bytes),
+                                   static_cast<jlong>(c.queued),
+                                   static_cast<jlong>(c.submit),
+                                   static_cast<jlong>(c.start),
+                                   static_cast<jlong>(c.end),
+                                   c.gapBefore);
+    env->SetObjectArrayElement(jCommands, i, jCommand);
+    env->DeleteLocalRef(jCommand);
+  }
+
+  auto cls = env->FindClass("opencl/executor/ExecutionProfile");
+  auto methodID = env->GetMethodID(cls, "<init>",
+                                   "(DD[Lopencl/executor/ExecutionProfile$Command;)V");
+  return env->NewObject(cls, methodID, profile.buildTime, profile.hostTime,
+                        jCommands);
+}
+
+// Global references needed to complete a future, which are released by the
+// last copy of the completion, i.e. after the callback has run or if the
+// execution failed before the callback has been registered
+class CompletionReferences {
+public:
+  CompletionReferences(JNIEnv* env, jobject future)
+    : vm(nullptr), future(env->NewGlobalRef(future)),
+      doubleClass(nullptr), exceptionClass(nullptr)
+  {
+    env->GetJavaVM(&vm);
+    // classes are resolved here, the class loader of the application is not
+    // available from threads attached later on
+    doubleClass = static_cast<jclass>(
+        env->NewGlobalRef(env->FindClass("java/lang/Double")));
+    exceptionClass = static_cast<jclass>(env->NewGlobalRef(
+        env->FindClass("opencl/executor/Executor$ExecutorFailureException")));
+  }
+
+  ~CompletionReferences()
+  {
+    JNIEnv* env = nullptr;
+    bool attached = attach(vm, env);
+    env->DeleteGlobalRef(future);
+    env->DeleteGlobalRef(doubleClass);
+    env->DeleteGlobalRef(exceptionClass);
+    if (attached) vm->DetachCurrentThread();
+  }
+
+  // Sets env for the calling thread and returns whether it had to be
+  // attached to the JVM for this
+  static bool attach(JavaVM* vm, JNIEnv*& env)
+  {
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6)
+        == JNI_EDETACHED) {
+      vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&env), nullptr);
+      return true;
+    }
+    return false;
+  }
+
+  JavaVM* vm;
+  jobject future;
+  jclass  doubleClass;
+  jclass  exceptionClass;
+
+private:
+  CompletionReferences(const CompletionReferences&);// = delete;
+  CompletionReferences& operator=(const CompletionReferences&);// = delete;
+};
+
+// Completes a java.util.concurrent.CompletableFuture from the thread of the
+// OpenCL implementation invoking the callback of an asynchronous execution
+class FutureCompletion {
+public:
+  FutureCompletion(JNIEnv* env, jobject future)
+    : _refs(std::make_shared<CompletionReferences>(env, future))
+  {
+    auto futureClass = env->GetObjectClass(future);
+    _valueOf = env->GetStaticMethodID(_refs->doubleClass, "valueOf",
+                                      "(D)Ljava/lang/Double;");
+    _exceptionInit = env->GetMethodID(_refs->exceptionClass, "<init>",
+                                      "(Ljava/lang/String;)V");
+    _complete = env->GetMethodID(futureClass, "complete",
+                                 "(Ljava/lang/Object;)Z");
+    _completeExceptionally = env->GetMethodID(futureClass,
+                                              "completeExceptionally",
+                                              "(Ljava/lang/Throwable;)Z");
+  }
+
+  void operator()(double runtime, cl_int status) const
+  {
+    JNIEnv* env = nullptr;
+    bool attached = CompletionReferences::attach(_refs->vm, env);
+
+    if (status == CL_SUCCESS) {
+      auto value = env->CallStaticObjectMethod(_refs->doubleClass, _valueOf,
+                                               runtime);
+      env->CallBooleanMethod(_refs->future, _complete, value);
+    } else {
+      auto message = env->NewStringUTF((std::string("Executor failure: ")
+                        + executor::logger_impl::getErrorString(status)).c_str());
+      auto exception = env->NewObject(_refs->exceptionClass, _exceptionInit,
+                                       message);
+      env->CallBooleanMethod(_refs->future, _completeExceptionally, exception);
+    }
+
+    if (attached) _refs->vm->DetachCurrentThread();
+  }
+
+private:
+  std::shared_ptr<CompletionReferences> _refs;
+  jmethodID _valueOf;
+  jmethodID _exceptionInit;
+  jmethodID _complete;
+  jmethodID _completeExceptionally;
+};
+
+void
+  Java_opencl_executor_Executor_enqueueAsync(JNIEnv* env, jclass,
+                                             jobject jKernel,
+                                             jint localSize1, jint localSize2, jint localSize3,
+                                             jint globalSize1, jint globalSize2, jint globalSize3,
+                                             jobjectArray jArgs,
+                                             jobject jFuture)
+{
+  TRACE_SPAN("Executor.enqueueAsync", "jni");
+  try {
+
+    auto kernel = getHandle<executor::Kernel>(env, jKernel);
+
+    std::vector<executor::KernelArg*> args(env->GetArrayLength(jArgs));
+    int i = 0;
+    for (auto& p : args) {
+      auto obj = env->GetObjectArrayElement(jArgs, i);
+      p = getHandle<executor::KernelArg>(env, obj);
+      ++i;
+    }
+
+    executeAsync(*kernel,
+      localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+      args, FutureCompletion(env, jFuture));
+
+  } catch(cl::Error& err) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass,
+        (std::string("Executor failure: ") + err.what() + std::string(". Error code: ") +
+         executor::logger_impl::getErrorString(err.err())).c_str());
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+  }
+}
+
 jdouble
   Java_opencl_executor_Executor_evaluate(JNIEnv* env, jclass jClass,
                                         jobject jKernel,
@@ -204,6 +610,112 @@ jdouble
         jArgs, Mode::Evaluate, iterations, timeout);
 }
 
+jobject
+  Java_opencl_executor_Executor_evaluateWithEarlyAbort(
+    JNIEnv* env,
+    jclass,
+    jobject jKernel,
+    jint localSize1, jint localSize2, jint localSize3,
+    jint globalSize1, jint globalSize2, jint globalSize3,
+    jobjectArray jArgs,
+    jint iterations, jdouble timeout, jdouble bestRuntime,
+    jboolean sizesInjected)
+{
+  executor::EvaluationResult result;
+
+  TRACE_SPAN("Executor.evaluateWithEarlyAbort", "jni");
+  try {
+
+    auto kernel = getHandle<executor::Kernel>(env, jKernel);
+
+    std::vector<executor::KernelArg*> args(env->GetArrayLength(jArgs));
+    int i = 0;
+    for (auto& p : args) {
+      auto obj = env->GetObjectArrayElement(jArgs, i);
+      p = getHandle<executor::KernelArg>(env, obj);
+      ++i;
+    }
+
+    result = evaluateWithEarlyAbort(*kernel,
+      localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+      args, iterations, timeout, bestRuntime, sizesInjected != 0);
+
+  } catch(cl::Error& err) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass,
+        (std::string("Executor failure: ") + err.what() + std::string(". Error code: ") +
+         executor::logger_impl::getErrorString(err.err())).c_str());
+    return nullptr;
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+    return nullptr;
+  }
+
+  auto jRuntimes = env->NewDoubleArray(result.runtimes.size());
+  env->SetDoubleArrayRegion(jRuntimes, 0, result.runtimes.size(),
+                            result.runtimes.data());
+
+  auto cls = env->FindClass("opencl/executor/EvaluationResult");
+  auto methodID = env->GetMethodID(cls, "<init>", "(IDDDJ[D)V");
+  return env->NewObject(cls, methodID, static_cast<jint>(result.status),
+                        result.runtime, result.estimate, result.probeFraction,
+                        static_cast<jlong>(result.privateMemory), jRuntimes);
+}
+
+jdoubleArray
+  Java_opencl_executor_Executor_evaluateBatch(JNIEnv* env, jclass,
+                                              jobjectArray jKernels,
+                                              jintArray jSizes,
+                                              jobjectArray jArgs,
+                                              jint iterations,
+                                              jdouble timeout)
+{
+  std::vector<double> runtimes;
+
+  TRACE_SPAN("Executor.evaluateBatch", "jni");
+  try {
+
+    std::vector<const executor::Kernel*> kernels(env->GetArrayLength(jKernels));
+    int i = 0;
+    for (auto& k : kernels) {
+      auto obj = env->GetObjectArrayElement(jKernels, i);
+      k = getHandle<executor::Kernel>(env, obj);
+      ++i;
+    }
+
+    std::vector<executor::KernelArg*> args(env->GetArrayLength(jArgs));
+    i = 0;
+    for (auto& p : args) {
+      auto obj = env->GetObjectArrayElement(jArgs, i);
+      p = getHandle<executor::KernelArg>(env, obj);
+      ++i;
+    }
+
+    std::vector<int> sizes(env->GetArrayLength(jSizes));
+    env->GetIntArrayRegion(jSizes, 0, sizes.size(), sizes.data());
+
+    runtimes = evaluateBatch(kernels, sizes, args, iterations, timeout);
+
+  } catch(cl::Error& err) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + err.what()).c_str());
+    return nullptr;
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+    return nullptr;
+  }
+
+  auto jRuntimes = env->NewDoubleArray(runtimes.size());
+  env->SetDoubleArrayRegion(jRuntimes, 0, runtimes.size(), runtimes.data());
+  return jRuntimes;
+}
+
 
 
 void Java_opencl_executor_Executor_init(JNIEnv *, jclass,
@@ -213,6 +725,40 @@ void Java_opencl_executor_Executor_init(JNIEnv *, jclass,
   initExecutor(platformId, deviceId);
 }
 
+void Java_opencl_executor_Executor_initDevices(JNIEnv* env, jclass,
+                                               jintArray jPlatformIds,
+                                               jintArray jDeviceIds)
+{
+  std::vector<int> platformIds(env->GetArrayLength(jPlatformIds));
+  std::vector<int> deviceIds(env->GetArrayLength(jDeviceIds));
+  env->GetIntArrayRegion(jPlatformIds, 0, platformIds.size(),
+                         reinterpret_cast<jint*>(platformIds.data()));
+  env->GetIntArrayRegion(jDeviceIds, 0, deviceIds.size(),
+                         reinterpret_cast<jint*>(deviceIds.data()));
+  initExecutor(platformIds, deviceIds);
+}
+
+void Java_opencl_executor_Executor_selectDevice(JNIEnv* env, jclass,
+                                                jint index)
+{
+  try {
+    selectDevice(index);
+  } catch (std::out_of_range& e) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  e.what());
+  }
+}
+
+jint Java_opencl_executor_Executor_getSelectedDevice(JNIEnv *, jclass)
+{
+  return getSelectedDevice();
+}
+
+jint Java_opencl_executor_Executor_getDeviceCount(JNIEnv *, jclass)
+{
+  return getDeviceCount();
+}
+
 jstring Java_opencl_executor_Executor_getPlatformName(JNIEnv * env, jclass)
 {
   auto name = getPlatformName();
@@ -271,6 +817,318 @@ jboolean Java_opencl_executor_Executor_isLittleEndian(JNIEnv *, jclass)
   return static_cast<bool>(littleEndian);
 }
 
+void Java_opencl_executor_Executor_enableBinaryCache(JNIEnv* env, jclass,
+                                                     jstring jDirectory,
+                                                     jlong maxSizeInBytes)
+{
+  if (!checkNotNegative(env, maxSizeInBytes, "maxSizeInBytes")) return;
+
+  auto chars = env->GetStringUTFChars(jDirectory, nullptr);
+  std::string directory(chars);
+  env->ReleaseStringUTFChars(jDirectory, chars);
+  try {
+    enableBinaryCache(directory, maxSizeInBytes);
+  } catch (std::exception& e) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + e.what()).c_str());
+  }
+}
+
+void Java_opencl_executor_Executor_disableBinaryCache(JNIEnv *, jclass)
+{
+  disableBinaryCache();
+}
+
+jlong Java_opencl_executor_Executor_getBinaryCacheHits(JNIEnv *, jclass)
+{
+  return getBinaryCacheHits();
+}
+
+jlong Java_opencl_executor_Executor_getBinaryCacheMisses(JNIEnv *, jclass)
+{
+  return getBinaryCacheMisses();
+}
+
+jdouble Java_opencl_executor_Executor_getBinaryCacheHitBuildTime(JNIEnv *, jclass)
+{
+  return getBinaryCacheHitBuildTime();
+}
+
+jdouble Java_opencl_executor_Executor_getBinaryCacheMissBuildTime(JNIEnv *, jclass)
+{
+  return getBinaryCacheMissBuildTime();
+}
+
+void Java_opencl_executor_Executor_setProgramCacheCapacity(JNIEnv* env, jclass,
+                                                           jint maxPrograms)
+{
+  if (!checkNotNegative(env, maxPrograms, "maxPrograms")) return;
+  setProgramCacheCapacity(maxPrograms);
+}
+
+void Java_opencl_executor_Executor_setCompileThreads(JNIEnv* env, jclass,
+                                                     jint numThreads)
+{
+  if (!checkNotNegative(env, numThreads, "numThreads")) return;
+  setCompileThreads(numThreads);
+}
+
+void Java_opencl_executor_Executor_startWorkers(JNIEnv* env, jclass,
+                                                jstring jWorkerPath,
+                                                jint numWorkers,
+                                                jint platformId,
+                                                jint deviceId)
+{
+  if (!checkNotNegative(env, numWorkers, "numWorkers")) return;
+
+  auto chars = env->GetStringUTFChars(jWorkerPath, nullptr);
+  std::string workerPath(chars);
+  env->ReleaseStringUTFChars(jWorkerPath, chars);
+  try {
+    startWorkers(workerPath, numWorkers, platformId, deviceId);
+  } catch (std::exception& e) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + e.what()).c_str());
+  }
+}
+
+void Java_opencl_executor_Executor_stopWorkers(JNIEnv *, jclass)
+{
+  stopWorkers();
+}
+
+jdouble
+  Java_opencl_executor_Executor_executeInWorker(JNIEnv* env, jclass,
+                                                jobject jKernel,
+                                                jint localSize1, jint localSize2, jint localSize3,
+                                                jint globalSize1, jint globalSize2, jint globalSize3,
+                                                jobjectArray jArgs,
+                                                jdouble deadline)
+{
+  double runtime = 0;
+
+  TRACE_SPAN("Executor.executeInWorker", "jni");
+  try {
+
+    auto kernel = getHandle<executor::Kernel>(env, jKernel);
+
+    std::vector<executor::KernelArg*> args(env->GetArrayLength(jArgs));
+    int i = 0;
+    for (auto& p : args) {
+      auto obj = env->GetObjectArrayElement(jArgs, i);
+      p = getHandle<executor::KernelArg>(env, obj);
+      ++i;
+    }
+
+    runtime = executeInWorker(*kernel,
+      localSize1, localSize2, localSize3, globalSize1, globalSize2, globalSize3,
+      args, deadline);
+
+  } catch(executor::WorkerError& err) {
+    jclass jClass = env->FindClass(err.timedOut()
+                      ? "opencl/executor/Executor$WorkerTimeoutException"
+                      : "opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + err.what()).c_str());
+  } catch(cl::Error& err) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass,
+        (std::string("Executor failure: ") + err.what() + std::string(". Error code: ") +
+         executor::logger_impl::getErrorString(err.err())).c_str());
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+  }
+
+  return runtime;
+}
+
+void Java_opencl_executor_Executor_enableTracing(JNIEnv* env, jclass,
+                                                 jint eventsPerThread)
+{
+  if (!checkNotNegative(env, eventsPerThread, "eventsPerThread")) return;
+  enableTracing(eventsPerThread);
+}
+
+void Java_opencl_executor_Executor_disableTracing(JNIEnv *, jclass)
+{
+  disableTracing();
+}
+
+jboolean Java_opencl_executor_Executor_dumpTrace(JNIEnv* env, jclass,
+                                                 jstring jPath)
+{
+  auto chars = env->GetStringUTFChars(jPath, nullptr);
+  std::string path(chars);
+  env->ReleaseStringUTFChars(jPath, chars);
+  return dumpTrace(path);
+}
+
+void Java_opencl_executor_Executor_enableMetrics(JNIEnv *, jclass)
+{
+  enableMetrics();
+}
+
+void Java_opencl_executor_Executor_disableMetrics(JNIEnv *, jclass)
+{
+  disableMetrics();
+}
+
+jobject Java_opencl_executor_Executor_getMetrics(JNIEnv* env, jclass)
+{
+  auto metrics = getMetrics();
+
+  auto mapClass = env->FindClass("java/util/HashMap");
+  auto mapInit = env->GetMethodID(mapClass, "<init>", "(I)V");
+  auto put = env->GetMethodID(mapClass, "put",
+                 "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+  auto doubleClass = env->FindClass("java/lang/Double");
+  auto valueOf = env->GetStaticMethodID(doubleClass, "valueOf",
+                                        "(D)Ljava/lang/Double;");
+
+  auto map = env->NewObject(mapClass, mapInit,
+                            static_cast<jint>(2 * metrics.size()));
+  for (auto& metric : metrics) {
+    auto key = env->NewStringUTF(metric.first.c_str());
+    auto value = env->CallStaticObjectMethod(doubleClass, valueOf,
+                                             metric.second);
+    env->DeleteLocalRef(env->CallObjectMethod(map, put, key, value));
+    env->DeleteLocalRef(key);
+    env->DeleteLocalRef(value);
+  }
+  return map;
+}
+
+void Java_opencl_executor_Executor_startMetricsDump(JNIEnv* env, jclass,
+                                                    jstring jPath,
+                                                    jdouble interval)
+{
+  if (!(interval > 0.0) || !std::isfinite(interval)) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  ("intervalInSeconds must be positive, got "
+                   + std::to_string(interval)).c_str());
+    return;
+  }
+
+  auto chars = env->GetStringUTFChars(jPath, nullptr);
+  std::string path(chars);
+  env->ReleaseStringUTFChars(jPath, chars);
+  try {
+    startMetricsDump(path, interval);
+  } catch (std::exception& e) {
+    // e.g. if the thread writing the metrics can not be started
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + e.what()).c_str());
+  }
+}
+
+void Java_opencl_executor_Executor_stopMetricsDump(JNIEnv *, jclass)
+{
+  stopMetricsDump();
+}
+
+void Java_opencl_executor_Executor_purgeProgramCache(JNIEnv *, jclass)
+{
+  purgeProgramCache();
+}
+
+jlong Java_opencl_executor_Executor_getProgramCacheHits(JNIEnv *, jclass)
+{
+  return getProgramCacheHits();
+}
+
+jlong Java_opencl_executor_Executor_getProgramCacheMisses(JNIEnv *, jclass)
+{
+  return getProgramCacheMisses();
+}
+
+void Java_opencl_executor_Executor_setBufferPoolHighWaterMark(JNIEnv* env, jclass,
+                                                              jlong bytes)
+{
+  if (!checkNotNegative(env, bytes, "bytes")) return;
+  setBufferPoolHighWaterMark(bytes);
+}
+
+jobject Java_opencl_executor_Executor_getBufferPoolStatistics(JNIEnv* env,
+                                                              jclass)
+{
+  executor::BufferPool::Statistics stats;
+  try {
+    stats = getBufferPoolStatistics();
+  } catch (std::exception& e) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, (std::string("Executor failure: ") + e.what()).c_str());
+    return nullptr;
+  } catch (...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+    return nullptr;
+  }
+  auto cls = env->FindClass("opencl/executor/BufferPoolStatistics");
+  auto methodID = env->GetMethodID(cls, "<init>", "(JJDD)V");
+  return env->NewObject(cls, methodID,
+                        static_cast<jlong>(stats.bytesReserved),
+                        static_cast<jlong>(stats.bytesInUse),
+                        stats.hitRate, stats.fragmentation);
+}
+
+void Java_opencl_executor_Executor_enableStagedTransfers(JNIEnv* env, jclass,
+                                                         jlong chunkSize,
+                                                         jint numChunks)
+{
+  if (chunkSize <= 0 || numChunks <= 0) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  ("chunkSize and numChunks must be positive, got "
+                   + std::to_string(chunkSize) + " and "
+                   + std::to_string(numChunks)).c_str());
+    return;
+  }
+
+  std::string message;
+  try {
+    enableStagedTransfers(chunkSize, numChunks);
+    return;
+  } catch (cl::Error& err) {
+    message = err.what() + std::string(". Error code: ")
+            + executor::logger_impl::getErrorString(err.err());
+  } catch (cl::Error* err) {
+    // thrown by ABORT_WITH_ERROR, e.g. if no pinned memory is left
+    message = err->what() + std::string(". Error code: ")
+            + executor::logger_impl::getErrorString(err->err());
+    delete err;
+  } catch (std::runtime_error* err) {
+    message = err->what();
+    delete err;
+  } catch (std::exception& e) {
+    message = e.what();
+  }
+  jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+  if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+  env->ThrowNew(jClass, ("Executor failure: " + message).c_str());
+}
+
+void Java_opencl_executor_Executor_disableStagedTransfers(JNIEnv *, jclass)
+{
+  disableStagedTransfers();
+}
+
+jdouble Java_opencl_executor_Executor_getLastUploadThroughput(JNIEnv *, jclass)
+{
+  return getLastUploadThroughput();
+}
+
+jdouble Java_opencl_executor_Executor_getLastDownloadThroughput(JNIEnv *, jclass)
+{
+  return getLastDownloadThroughput();
+}
+
 void Java_opencl_executor_Executor_init__(JNIEnv *, jclass)
 {
   initExecutor("ANY");
@@ -23,6 +23,14 @@ JNIEXPORT void JNICALL Java_opencl_executor_Executor_nativeMatrixMultiply
 JNIEXPORT jdouble JNICALL Java_opencl_executor_Executor_execute
   (JNIEnv *, jclass, jobject, jint, jint, jint, jint, jint, jint, jobjectArray);
 
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    enqueueAsync
+ * Signature: (Lopencl/executor/Kernel;IIIIII[Lopencl/executor/KernelArg;Ljava/util/concurrent/CompletableFuture;)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_enqueueAsync
+  (JNIEnv *, jclass, jobject, jint, jint, jint, jint, jint, jint, jobjectArray, jobject);
+
 /*
  * Class:     opencl_executor_Executor
  * Method:    benchmark
@@ -119,6 +127,318 @@ JNIEXPORT jstring JNICALL Java_opencl_executor_Executor_getDeviceType
 JNIEXPORT jboolean JNICALL Java_opencl_executor_Executor_isLittleEndian
   (JNIEnv *, jclass);
 
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    enableBinaryCache
+ * Signature: (Ljava/lang/String;J)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_enableBinaryCache
+  (JNIEnv *, jclass, jstring, jlong);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    disableBinaryCache
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_disableBinaryCache
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getBinaryCacheHits
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_opencl_executor_Executor_getBinaryCacheHits
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getBinaryCacheMisses
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_opencl_executor_Executor_getBinaryCacheMisses
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getBinaryCacheHitBuildTime
+ * Signature: ()D
+ */
+JNIEXPORT jdouble JNICALL Java_opencl_executor_Executor_getBinaryCacheHitBuildTime
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getBinaryCacheMissBuildTime
+ * Signature: ()D
+ */
+JNIEXPORT jdouble JNICALL Java_opencl_executor_Executor_getBinaryCacheMissBuildTime
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    setProgramCacheCapacity
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_setProgramCacheCapacity
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    purgeProgramCache
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_purgeProgramCache
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getProgramCacheHits
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_opencl_executor_Executor_getProgramCacheHits
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getProgramCacheMisses
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_opencl_executor_Executor_getProgramCacheMisses
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    setBufferPoolHighWaterMark
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_setBufferPoolHighWaterMark
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getBufferPoolStatistics
+ * Signature: ()Lopencl/executor/BufferPoolStatistics;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_Executor_getBufferPoolStatistics
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    enableStagedTransfers
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_enableStagedTransfers
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    disableStagedTransfers
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_disableStagedTransfers
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getLastUploadThroughput
+ * Signature: ()D
+ */
+JNIEXPORT jdouble JNICALL Java_opencl_executor_Executor_getLastUploadThroughput
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getLastDownloadThroughput
+ * Signature: ()D
+ */
+JNIEXPORT jdouble JNICALL Java_opencl_executor_Executor_getLastDownloadThroughput
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    initDevices
+ * Signature: ([I[I)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_initDevices
+  (JNIEnv *, jclass, jintArray, jintArray);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    selectDevice
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_selectDevice
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getSelectedDevice
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_opencl_executor_Executor_getSelectedDevice
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getDeviceCount
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_opencl_executor_Executor_getDeviceCount
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    executePipeline
+ * Signature: ([Lopencl/executor/Kernel;[I[[Lopencl/executor/KernelArg;)[D
+ */
+JNIEXPORT jdoubleArray JNICALL Java_opencl_executor_Executor_executePipeline
+  (JNIEnv *, jclass, jobjectArray, jintArray, jobjectArray);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    evaluateBatch
+ * Signature: ([Lopencl/executor/Kernel;[I[Lopencl/executor/KernelArg;ID)[D
+ */
+JNIEXPORT jdoubleArray JNICALL Java_opencl_executor_Executor_evaluateBatch
+  (JNIEnv *, jclass, jobjectArray, jintArray, jobjectArray, jint, jdouble);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    setCompileThreads
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_setCompileThreads
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    benchmarkResident
+ * Signature: (Lopencl/executor/Kernel;IIIIII[Lopencl/executor/KernelArg;IDZ)[D
+ */
+JNIEXPORT jdoubleArray JNICALL Java_opencl_executor_Executor_benchmarkResident
+  (JNIEnv *, jclass, jobject, jint, jint, jint, jint, jint, jint, jobjectArray, jint, jdouble, jboolean);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    benchmarkStatistics
+ * Signature: (Lopencl/executor/Kernel;IIIIII[Lopencl/executor/KernelArg;IIIDDDDZ)Lopencl/executor/BenchmarkStatistics;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_Executor_benchmarkStatistics
+  (JNIEnv *, jclass, jobject, jint, jint, jint, jint, jint, jint, jobjectArray, jint, jint, jint, jdouble, jdouble, jdouble, jdouble, jboolean);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    summarize
+ * Signature: ([DDD)Lopencl/executor/BenchmarkStatistics;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_Executor_summarize
+  (JNIEnv *, jclass, jdoubleArray, jdouble, jdouble);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    startWorkers
+ * Signature: (Ljava/lang/String;III)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_startWorkers
+  (JNIEnv *, jclass, jstring, jint, jint, jint);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    stopWorkers
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_stopWorkers
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    executeInWorker
+ * Signature: (Lopencl/executor/Kernel;IIIIII[Lopencl/executor/KernelArg;D)D
+ */
+JNIEXPORT jdouble JNICALL Java_opencl_executor_Executor_executeInWorker
+  (JNIEnv *, jclass, jobject, jint, jint, jint, jint, jint, jint, jobjectArray, jdouble);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    executeProfiled
+ * Signature: (Lopencl/executor/Kernel;IIIIII[Lopencl/executor/KernelArg;)Lopencl/executor/ExecutionProfile;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_Executor_executeProfiled
+  (JNIEnv *, jclass, jobject, jint, jint, jint, jint, jint, jint, jobjectArray);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    enableTracing
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_enableTracing
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    disableTracing
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_disableTracing
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    dumpTrace
+ * Signature: (Ljava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_opencl_executor_Executor_dumpTrace
+  (JNIEnv *, jclass, jstring);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    enableMetrics
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_enableMetrics
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    disableMetrics
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_disableMetrics
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    getMetrics
+ * Signature: ()Ljava/util/Map;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_Executor_getMetrics
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    startMetricsDump
+ * Signature: (Ljava/lang/String;D)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_startMetricsDump
+  (JNIEnv *, jclass, jstring, jdouble);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    stopMetricsDump
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Executor_stopMetricsDump
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     opencl_executor_Executor
+ * Method:    evaluateWithEarlyAbort
+ * Signature: (Lopencl/executor/Kernel;IIIIII[Lopencl/executor/KernelArg;IDDZ)Lopencl/executor/EvaluationResult;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_Executor_evaluateWithEarlyAbort
+  (JNIEnv *, jclass, jobject, jint, jint, jint, jint, jint, jint, jobjectArray, jint, jdouble, jdouble, jboolean);
+
 /*
  * Class:     opencl_executor_Executor
  * Method:    shutdown
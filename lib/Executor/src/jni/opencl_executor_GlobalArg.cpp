@@ -1,3 +1,5 @@
+#include <string>
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Weffc++"
 #include "opencl_executor_GlobalArg.h"
@@ -80,77 +82,220 @@ jobject Java_opencl_executor_GlobalArg_createOutput(JNIEnv* env, jclass cls,
   return obj;
 }
 
-jfloat Java_opencl_executor_GlobalArg_at(JNIEnv* env, jobject obj, jint index)
+jobject createFromDirectBuffer(JNIEnv* env, jclass cls, jobject buffer,
+                               bool isOutput)
+{
+  auto address = env->GetDirectBufferAddress(buffer);
+  auto capacity = env->GetDirectBufferCapacity(buffer);
+  if (address == nullptr || capacity < 0) {
+    auto jClass = env->FindClass("java/lang/IllegalArgumentException");
+    env->ThrowNew(jClass, "GlobalArg requires a direct ByteBuffer");
+    return nullptr;
+  }
+  if (capacity == 0) {
+    // OpenCL does not allow buffers of size 0
+    auto jClass = env->FindClass("java/lang/IllegalArgumentException");
+    env->ThrowNew(jClass, "GlobalArg requires a non-empty ByteBuffer");
+    return nullptr;
+  }
+
+  auto ptr = executor::GlobalArg::createExternal(address, capacity, isOutput);
+  auto methodID = env->GetMethodID(cls, "<init>", "(J)V");
+  auto obj = env->NewObject(cls, methodID, ptr);
+  return obj;
+}
+
+jobject Java_opencl_executor_GlobalArg_createInputFromDirectBuffer(JNIEnv* env,
+                                                                   jclass cls,
+                                                                   jobject buffer)
+{
+  return createFromDirectBuffer(env, cls, buffer, false);
+}
+
+jobject Java_opencl_executor_GlobalArg_createOutputFromDirectBuffer(JNIEnv* env,
+                                                                    jclass cls,
+                                                                    jobject buffer)
+{
+  return createFromDirectBuffer(env, cls, buffer, true);
+}
+
+jobject createFromFile(JNIEnv* env, jclass cls, jstring jPath,
+                       jlong offset, jlong size, bool isOutput)
+{
+  auto chars = env->GetStringUTFChars(jPath, nullptr);
+  std::string path(chars);
+  env->ReleaseStringUTFChars(jPath, chars);
+
+  executor::KernelArg* ptr = nullptr;
+  try {
+    ptr = isOutput ? executor::GlobalArg::createOutputToFile(path, size)
+                   : executor::GlobalArg::createInputFromFile(path, offset,
+                                                              size);
+  } catch (std::exception& e) {
+    auto jClass = env->FindClass("java/io/IOException");
+    env->ThrowNew(jClass, e.what());
+    return nullptr;
+  }
+
+  auto methodID = env->GetMethodID(cls, "<init>", "(J)V");
+  auto obj = env->NewObject(cls, methodID, ptr);
+  return obj;
+}
+
+jobject Java_opencl_executor_GlobalArg_createInputFromFile(JNIEnv* env,
+                                                           jclass cls,
+                                                           jstring jPath,
+                                                           jlong offset,
+                                                           jlong length)
+{
+  return createFromFile(env, cls, jPath, offset, length, false);
+}
+
+jobject Java_opencl_executor_GlobalArg_createOutputToFile(JNIEnv* env,
+                                                          jclass cls,
+                                                          jstring jPath,
+                                                          jlong size)
+{
+  return createFromFile(env, cls, jPath, 0, size, true);
+}
+
+// Throws an IndexOutOfBoundsException and returns false unless count
+// elements of elemSize bytes starting at element index lie within arg
+bool checkRange(JNIEnv* env, const executor::GlobalArg& arg,
+                jlong index, jlong count, size_t elemSize)
+{
+  auto numElems = static_cast<jlong>(arg.sizeInBytes() / elemSize);
+  if (index >= 0 && count >= 0 && index <= numElems
+      && count <= numElems - index) {
+    return true;
+  }
+  auto jClass = env->FindClass("java/lang/IndexOutOfBoundsException");
+  env->ThrowNew(jClass, (std::to_string(count) + " elements at index "
+                         + std::to_string(index) + " exceed size "
+                         + std::to_string(numElems)).c_str());
+  return false;
+}
+
+jfloat Java_opencl_executor_GlobalArg_at(JNIEnv* env, jobject obj, jlong index)
 {
   auto ptr = getHandle<executor::GlobalArg>(env, obj);
-  auto& vec = ptr->data();
-  vec.copyDataToHost();
-  auto dataPtr = reinterpret_cast<jfloat*>(vec.hostBuffer().data());
-  return dataPtr[index];
+  jfloat value = 0;
+  if (!checkRange(env, *ptr, index, 1, sizeof(jfloat))) return value;
+  ptr->read(index * sizeof(jfloat), sizeof(jfloat), &value);
+  return value;
+}
+
+jbyteArray Java_opencl_executor_GlobalArg_readBytes(JNIEnv* env, jobject obj,
+                                                    jlong offset, jlong length)
+{
+  auto ptr = getHandle<executor::GlobalArg>(env, obj);
+  if (!checkRange(env, *ptr, offset, length, 1)) return nullptr;
+
+  auto res = env->NewByteArray(length);
+  if (res == nullptr) return nullptr;
+
+  auto arrayPtr = env->GetByteArrayElements(res, nullptr);
+  ptr->read(offset, length, arrayPtr);
+  env->ReleaseByteArrayElements(res, arrayPtr, 0);
+  return res;
+}
+
+jfloatArray Java_opencl_executor_GlobalArg_readFloats(JNIEnv* env, jobject obj,
+                                                      jlong index, jlong count)
+{
+  auto ptr = getHandle<executor::GlobalArg>(env, obj);
+  if (!checkRange(env, *ptr, index, count, sizeof(jfloat))) return nullptr;
+
+  auto res = env->NewFloatArray(count);
+  if (res == nullptr) return nullptr;
+
+  auto arrayPtr = env->GetFloatArrayElements(res, nullptr);
+  ptr->read(index * sizeof(jfloat), count * sizeof(jfloat), arrayPtr);
+  env->ReleaseFloatArrayElements(res, arrayPtr, 0);
+  return res;
+}
+
+void Java_opencl_executor_GlobalArg_writeBytes(JNIEnv* env, jobject obj,
+                                               jlong offset, jbyteArray data)
+{
+  auto ptr = getHandle<executor::GlobalArg>(env, obj);
+  auto length = env->GetArrayLength(data);
+  if (!checkRange(env, *ptr, offset, length, 1)) return;
+
+  auto arrayPtr = env->GetByteArrayElements(data, nullptr);
+  ptr->write(offset, length, arrayPtr);
+  env->ReleaseByteArrayElements(data, arrayPtr, JNI_ABORT);
+}
+
+void Java_opencl_executor_GlobalArg_writeFloats(JNIEnv* env, jobject obj,
+                                                jlong index, jfloatArray data)
+{
+  auto ptr = getHandle<executor::GlobalArg>(env, obj);
+  auto count = env->GetArrayLength(data);
+  if (!checkRange(env, *ptr, index, count, sizeof(jfloat))) return;
+
+  auto arrayPtr = env->GetFloatArrayElements(data, nullptr);
+  ptr->write(index * sizeof(jfloat), count * sizeof(jfloat), arrayPtr);
+  env->ReleaseFloatArrayElements(data, arrayPtr, JNI_ABORT);
 }
 
 jfloatArray Java_opencl_executor_GlobalArg_asFloatArray(JNIEnv* env,
                                                         jobject obj)
 {
   auto ptr = getHandle<executor::GlobalArg>(env, obj);
-  auto& vec = ptr->data();
 
-  auto res = env->NewFloatArray(vec.size() / sizeof(jfloat));
+  auto res = env->NewFloatArray(ptr->sizeInBytes() / sizeof(jfloat));
   if (res == nullptr) return nullptr;
 
-  env->SetFloatArrayRegion(res, 0, vec.size() / sizeof(jfloat),
-                           reinterpret_cast<jfloat*>(vec.hostBuffer().data()));
+  env->SetFloatArrayRegion(res, 0, ptr->sizeInBytes() / sizeof(jfloat),
+                           reinterpret_cast<const jfloat*>(ptr->hostData()));
   return res;
 }
 
 jintArray Java_opencl_executor_GlobalArg_asIntArray(JNIEnv* env, jobject obj)
 {
   auto ptr = getHandle<executor::GlobalArg>(env, obj);
-  auto& vec = ptr->data();
 
-  auto res = env->NewIntArray(vec.size() / sizeof(jint));
+  auto res = env->NewIntArray(ptr->sizeInBytes() / sizeof(jint));
   if (res == nullptr) return nullptr;
 
-  env->SetIntArrayRegion(res, 0, vec.size() / sizeof(jint),
-                         reinterpret_cast<jint*>(vec.hostBuffer().data()));
+  env->SetIntArrayRegion(res, 0, ptr->sizeInBytes() / sizeof(jint),
+                         reinterpret_cast<const jint*>(ptr->hostData()));
   return res;
 }
 
 jdoubleArray Java_opencl_executor_GlobalArg_asDoubleArray(JNIEnv* env, jobject obj)
 {
   auto ptr = getHandle<executor::GlobalArg>(env, obj);
-  auto& vec = ptr->data();
 
-  auto res = env->NewDoubleArray(vec.size() / sizeof(jdouble));
+  auto res = env->NewDoubleArray(ptr->sizeInBytes() / sizeof(jdouble));
   if (res == nullptr) return nullptr;
 
-  env->SetDoubleArrayRegion(res, 0, vec.size() / sizeof(jdouble),
-                         reinterpret_cast<jdouble*>(vec.hostBuffer().data()));
+  env->SetDoubleArrayRegion(res, 0, ptr->sizeInBytes() / sizeof(jdouble),
+                         reinterpret_cast<const jdouble*>(ptr->hostData()));
   return res;
 }
 
 jbooleanArray Java_opencl_executor_GlobalArg_asBooleanArray(JNIEnv* env, jobject obj)
 {
   auto ptr = getHandle<executor::GlobalArg>(env, obj);
-  auto& vec = ptr->data();
 
-  auto res = env->NewBooleanArray(vec.size() / sizeof(jboolean));
+  auto res = env->NewBooleanArray(ptr->sizeInBytes() / sizeof(jboolean));
   if (res == nullptr) return nullptr;
 
-  env->SetBooleanArrayRegion(res, 0, vec.size() / sizeof(jboolean),
-                         reinterpret_cast<jboolean*>(vec.hostBuffer().data()));
+  env->SetBooleanArrayRegion(res, 0, ptr->sizeInBytes() / sizeof(jboolean),
+                         reinterpret_cast<const jboolean*>(ptr->hostData()));
   return res;
 }
 
 jbyteArray Java_opencl_executor_GlobalArg_asByteArray(JNIEnv* env, jobject obj)
 {
   auto ptr = getHandle<executor::GlobalArg>(env, obj);
-  auto& vec = ptr->data();
 
-  auto res = env->NewByteArray(vec.size() / sizeof(jbyte));
+  auto res = env->NewByteArray(ptr->sizeInBytes() / sizeof(jbyte));
   if (res == nullptr) return nullptr;
 
-  env->SetByteArrayRegion(res, 0, vec.size() / sizeof(jbyte),
-                          reinterpret_cast<jbyte*>(vec.hostBuffer().data()));
+  env->SetByteArrayRegion(res, 0, ptr->sizeInBytes() / sizeof(jbyte),
+                          reinterpret_cast<const jbyte*>(ptr->hostData()));
   return res;
 }
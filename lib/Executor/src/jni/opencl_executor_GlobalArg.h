@@ -55,6 +55,38 @@ JNIEXPORT jobject JNICALL Java_opencl_executor_GlobalArg_createInput___3Z
 JNIEXPORT jobject JNICALL Java_opencl_executor_GlobalArg_createOutput
   (JNIEnv *, jclass, jlong);
 
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    createInputFromDirectBuffer
+ * Signature: (Ljava/nio/ByteBuffer;)Lopencl/executor/GlobalArg;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_GlobalArg_createInputFromDirectBuffer
+  (JNIEnv *, jclass, jobject);
+
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    createOutputFromDirectBuffer
+ * Signature: (Ljava/nio/ByteBuffer;)Lopencl/executor/GlobalArg;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_GlobalArg_createOutputFromDirectBuffer
+  (JNIEnv *, jclass, jobject);
+
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    createInputFromFile
+ * Signature: (Ljava/lang/String;JJ)Lopencl/executor/GlobalArg;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_GlobalArg_createInputFromFile
+  (JNIEnv *, jclass, jstring, jlong, jlong);
+
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    createOutputToFile
+ * Signature: (Ljava/lang/String;J)Lopencl/executor/GlobalArg;
+ */
+JNIEXPORT jobject JNICALL Java_opencl_executor_GlobalArg_createOutputToFile
+  (JNIEnv *, jclass, jstring, jlong);
+
 /*
  * Class:     opencl_executor_GlobalArg
  * Method:    at
@@ -63,6 +95,38 @@ JNIEXPORT jobject JNICALL Java_opencl_executor_GlobalArg_createOutput
 JNIEXPORT jfloat JNICALL Java_opencl_executor_GlobalArg_at
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    readBytes
+ * Signature: (JJ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_opencl_executor_GlobalArg_readBytes
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    readFloats
+ * Signature: (JJ)[F
+ */
+JNIEXPORT jfloatArray JNICALL Java_opencl_executor_GlobalArg_readFloats
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    writeBytes
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_GlobalArg_writeBytes
+  (JNIEnv *, jobject, jlong, jbyteArray);
+
+/*
+ * Class:     opencl_executor_GlobalArg
+ * Method:    writeFloats
+ * Signature: (J[F)V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_GlobalArg_writeFloats
+  (JNIEnv *, jobject, jlong, jfloatArray);
+
 /*
  * Class:     opencl_executor_GlobalArg
  * Method:    asFloatArray
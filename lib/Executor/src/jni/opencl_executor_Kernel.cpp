@@ -42,3 +42,16 @@ void Java_opencl_executor_Kernel_build(JNIEnv* env, jobject obj)
   }
 }
 
+void Java_opencl_executor_Kernel_buildAsync(JNIEnv* env, jobject obj)
+{
+  try {
+
+    auto ptr = getHandle<executor::Kernel>(env, obj);
+    ptr->buildAsync();
+
+  } catch(...) {
+    jclass jClass = env->FindClass("opencl/executor/Executor$ExecutorFailureException");
+    if(!jClass) LOG_ERROR("[JNI ERROR] Cannot find the exception class");
+    env->ThrowNew(jClass, "Executor failure");
+  }
+}
@@ -23,6 +23,14 @@ JNIEXPORT jobject JNICALL Java_opencl_executor_Kernel_create
 JNIEXPORT void JNICALL Java_opencl_executor_Kernel_build
   (JNIEnv *, jobject);
 
+/*
+ * Class:     opencl_executor_Kernel
+ * Method:    buildAsync
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_opencl_executor_Kernel_buildAsync
+  (JNIEnv *, jobject);
+
 #ifdef __cplusplus
 }
 #endif
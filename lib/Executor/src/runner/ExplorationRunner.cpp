@@ -0,0 +1,706 @@
+///
+/// \file ExplorationRunner.cpp
+///
+/// A command line tool running every kernel of an exploration, i.e. of the
+/// <topFolder>/Cl directory written by ParameterRewrite and SaveOpenCL.
+///
+/// Usage: exploration-runner [options] <topFolder>
+///
+/// Every row of every Cl/<low-level hash>/exec_<size id>.csv file is one
+/// job. The arguments of a kernel are derived from its signature: the
+/// const global buffers are the inputs, the first other global buffer is
+/// the output, further global buffers are temporaries, local buffers and
+/// temporaries take their sizes from the exec_*.csv row, the inputs and the
+/// output from the args_<size id>.csv file and scalars are the input sizes.
+///
+/// Kernels are built on the globalCompilePool a few jobs ahead of the
+/// devices, every device is fed by its own thread, so that building and
+/// executing kernels overlap. Every result is appended to a single results
+/// file keyed by the high-level, low-level and kernel hash and the size id.
+/// The results file doubles as checkpoint: jobs which already have a result
+/// are skipped, so that an interrupted run resumes where it stopped.
+///
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Executor.h"
+#include "GlobalArg.h"
+#include "LocalArg.h"
+#include "ValueArg.h"
+
+namespace {
+
+const char* usage =
+  "Usage: exploration-runner [options] <topFolder>\n"
+  "Options:\n"
+  "  --device <p>:<d>      use device d of platform p, may be given several\n"
+  "                        times to run on several devices (default: 0:0)\n"
+  "  --compile-threads <n> threads building kernels (default: one per\n"
+  "                        hardware thread)\n"
+  "  --ahead <n>           kernels built ahead of every device (default: 8)\n"
+  "  --iterations <n>      measured runs per kernel (default: 10)\n"
+  "  --timeout <ms>        stop after a run taking at least this long\n"
+  "                        (default: 100)\n"
+  "  --size <id>           only run the exec_<id>.csv files\n"
+  "  --build-options <s>   options passed to the OpenCL compiler\n"
+  "  --output <file>       results and checkpoint file\n"
+  "                        (default: <topFolder>/Cl/results.csv)\n";
+
+const char* resultsHeader =
+  "high_level_hash,low_level_hash,kernel_hash,size_id,size,"
+  "global0,global1,global2,local0,local1,local2,device,median,status\n";
+
+// A row of an exec_<size id>.csv file
+struct Run {
+  std::string           sizeId;
+  std::string           size;
+  int                   global[3];
+  int                   local[3];
+  std::vector<size_t>   temps;
+  std::vector<size_t>   locals;
+};
+
+// All runs of one kernel, which is built once for all of them
+struct Job {
+  std::string       lowLevelHash;
+  std::string       hash;
+  std::string       path;
+  std::vector<Run>  runs;
+};
+
+// A row of an args_<size id>.csv file
+struct Buffers {
+  std::vector<size_t> inputsAndOutput;
+  std::vector<int>    sizes;
+};
+
+struct Param {
+  enum Kind { Input, Output, Temp, Local, Scalar } kind;
+  std::string type;
+};
+
+std::vector<std::string> split(const std::string& string, char separator)
+{
+  std::vector<std::string> parts;
+  std::istringstream stream(string);
+  std::string part;
+  while (std::getline(stream, part, separator)) parts.push_back(part);
+  return parts;
+}
+
+std::vector<std::string> listDirectory(const std::string& path)
+{
+  std::vector<std::string> entries;
+  auto dir = opendir(path.c_str());
+  if (dir == nullptr) return entries;
+  while (auto entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name != "." && name != "..") entries.push_back(name);
+  }
+  closedir(dir);
+  std::sort(entries.begin(), entries.end());
+  return entries;
+}
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::runtime_error("cannot read " + path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+// Returns the value following prefix in the header comments of source
+std::string headerValue(const std::string& source, const std::string& prefix)
+{
+  auto pos = source.find(prefix);
+  if (pos == std::string::npos) return std::string();
+  pos += prefix.size();
+  return source.substr(pos, source.find('\n', pos) - pos);
+}
+
+Run parseRun(const std::string& sizeId, const std::string& line,
+             std::string& hash)
+{
+  auto fields = split(line, ',');
+  if (fields.size() < 10) throw std::runtime_error("invalid row: " + line);
+
+  Run run;
+  run.sizeId = sizeId;
+  run.size   = fields[0];
+  for (int i = 0; i < 3; ++i) {
+    run.global[i] = std::stoi(fields[1 + i]);
+    run.local[i]  = std::stoi(fields[4 + i]);
+  }
+  hash = fields[7];
+
+  size_t pos = 8;
+  auto numTemps = std::stoul(fields.at(pos++));
+  for (size_t i = 0; i < numTemps; ++i) {
+    run.temps.push_back(std::stoul(fields.at(pos++)));
+  }
+  auto numLocals = std::stoul(fields.at(pos++));
+  for (size_t i = 0; i < numLocals; ++i) {
+    run.locals.push_back(std::stoul(fields.at(pos++)));
+  }
+  return run;
+}
+
+// Collects all runs of all kernels below topFolder/Cl, in a stable order
+std::vector<Job> findJobs(const std::string& clFolder,
+                          const std::string& onlySizeId)
+{
+  std::vector<Job> jobs;
+  for (auto& lowLevelHash : listDirectory(clFolder)) {
+    auto folder = clFolder + "/" + lowLevelHash;
+    std::map<std::string, size_t> jobOfHash;
+
+    for (auto& file : listDirectory(folder)) {
+      const std::string prefix = "exec_";
+      const std::string suffix = ".csv";
+      if (file.compare(0, prefix.size(), prefix) != 0
+          || file.size() <= prefix.size() + suffix.size()) continue;
+      auto sizeId = file.substr(prefix.size(),
+                                file.size() - prefix.size() - suffix.size());
+      if (!onlySizeId.empty() && sizeId != onlySizeId) continue;
+
+      std::ifstream csv(folder + "/" + file);
+      std::string line;
+      while (std::getline(csv, line)) {
+        if (line.empty()) continue;
+        std::string hash;
+        auto run = parseRun(sizeId, line, hash);
+
+        auto it = jobOfHash.find(hash);
+        if (it == jobOfHash.end()) {
+          it = jobOfHash.insert({hash, jobs.size()}).first;
+          Job job;
+          job.lowLevelHash = lowLevelHash;
+          job.hash = hash;
+          job.path = folder + "/" + hash + ".cl";
+          jobs.push_back(job);
+        }
+        jobs[it->second].runs.push_back(run);
+      }
+    }
+  }
+  return jobs;
+}
+
+// Reads the sizes of the inputs and the output of every kernel in folder for
+// the given size id, keyed by the kernel hash
+std::map<std::string, Buffers> readBuffers(const std::string& folder,
+                                           const std::string& sizeId)
+{
+  std::map<std::string, Buffers> buffers;
+  std::ifstream csv(folder + "/args_" + sizeId + ".csv");
+  std::string line;
+  while (std::getline(csv, line)) {
+    auto fields = split(line, ',');
+    if (fields.size() < 2) continue;
+    Buffers b;
+    size_t pos = 1;
+    auto numBuffers = std::stoul(fields.at(pos++));
+    for (size_t i = 0; i < numBuffers; ++i) {
+      b.inputsAndOutput.push_back(std::stoul(fields.at(pos++)));
+    }
+    if (pos < fields.size()) {
+      auto numSizes = std::stoul(fields.at(pos++));
+      for (size_t i = 0; i < numSizes; ++i) {
+        b.sizes.push_back(std::stoi(fields.at(pos++)));
+      }
+    }
+    buffers[fields[0]] = b;
+  }
+  return buffers;
+}
+
+// Classifies the parameters of the generated kernel
+std::vector<Param> parseSignature(const std::string& source)
+{
+  auto begin = source.find("KERNEL(");
+  if (begin == std::string::npos) throw std::runtime_error("no KERNEL found");
+  begin += 7;
+  auto end = source.find(')', begin);
+
+  std::vector<Param> params;
+  bool seenOutput = false;
+  for (auto& decl : split(source.substr(begin, end - begin), ',')) {
+    std::istringstream words(decl);
+    std::string word;
+    bool isConst = false, isGlobal = false, isLocal = false;
+    Param param;
+    while (words >> word) {
+      if (word == "const") isConst = true;
+      else if (word == "global" || word == "__global") isGlobal = true;
+      else if (word == "local" || word == "__local") isLocal = true;
+      else if (param.type.empty()) param.type = word;
+    }
+    if (!param.type.empty() && param.type.back() == '*') param.type.pop_back();
+
+    if (isLocal) {
+      param.kind = Param::Local;
+    } else if (!isGlobal) {
+      param.kind = Param::Scalar;
+    } else if (isConst && !seenOutput) {
+      param.kind = Param::Input;
+    } else if (!seenOutput) {
+      param.kind = Param::Output;
+      seenOutput = true;
+    } else {
+      param.kind = Param::Temp;
+    }
+    params.push_back(param);
+  }
+  return params;
+}
+
+// Inputs are the same for all kernels of an exploration, the fixed seed
+// makes runs comparable
+std::vector<char> randomData(const std::string& type, size_t sizeInBytes)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  std::vector<char> data(sizeInBytes);
+  if (type == "float") {
+    auto values = reinterpret_cast<float*>(data.data());
+    for (size_t i = 0; i < sizeInBytes / sizeof(float); ++i) {
+      values[i] = distribution(rng);
+    }
+  } else if (type == "int") {
+    auto values = reinterpret_cast<int*>(data.data());
+    for (size_t i = 0; i < sizeInBytes / sizeof(int); ++i) {
+      values[i] = static_cast<int>(distribution(rng) * 10);
+    }
+  } else if (type == "double") {
+    auto values = reinterpret_cast<double*>(data.data());
+    for (size_t i = 0; i < sizeInBytes / sizeof(double); ++i) {
+      values[i] = distribution(rng);
+    }
+  }
+  return data;
+}
+
+///
+/// Appends results to the results file and knows the jobs finished by
+/// previous runs
+///
+class Results {
+public:
+  explicit Results(const std::string& path)
+    : _mutex(), _done(), _file(), _count(0)
+  {
+    std::ifstream previous(path);
+    std::string line;
+    bool empty = true;
+    while (std::getline(previous, line)) {
+      empty = false;
+      auto fields = split(line, ',');
+      if (fields.size() > 3 && fields[0] != "high_level_hash") {
+        _done.insert(key(fields[2], fields[3]));
+      }
+    }
+    _file.open(path, std::ios::app);
+    if (!_file) throw std::runtime_error("cannot write " + path);
+    if (empty) _file << resultsHeader << std::flush;
+  }
+
+  static std::string key(const std::string& hash, const std::string& sizeId)
+  {
+    return hash + "/" + sizeId;
+  }
+
+  bool isDone(const Job& job, const Run& run) const
+  {
+    return _done.count(key(job.hash, run.sizeId)) != 0;
+  }
+
+  size_t numDone() const { return _done.size(); }
+
+  void add(const std::string& highLevelHash, const Job& job, const Run& run,
+           size_t device, double median, const std::string& status)
+  {
+    std::ostringstream line;
+    line << highLevelHash << ',' << job.lowLevelHash << ',' << job.hash
+         << ',' << run.sizeId << ',' << run.size
+         << ',' << run.global[0] << ',' << run.global[1] << ',' << run.global[2]
+         << ',' << run.local[0] << ',' << run.local[1] << ',' << run.local[2]
+         << ',' << device << ',' << median << ',' << status << '\n';
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    // flushed right away, so that at most the running jobs are lost
+    _file << line.str() << std::flush;
+    ++_count;
+  }
+
+  size_t count()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _count;
+  }
+
+private:
+  std::mutex            _mutex;
+  std::set<std::string> _done;
+  std::ofstream         _file;
+  size_t                _count;
+};
+
+struct Settings {
+  std::string buildOptions;
+  size_t      ahead;
+  int         iterations;
+  double      timeout;
+};
+
+///
+/// Feeds one device: takes jobs from the shared queue, starts building them
+/// ahead of time and executes them one after another
+///
+class DeviceRunner {
+public:
+  DeviceRunner(size_t device, const std::string& clFolder,
+               const Settings& settings, Results& results,
+               const std::vector<Job>& jobs, std::atomic<size_t>& nextJob)
+    : _device(device), _clFolder(clFolder), _settings(settings),
+      _results(results), _jobs(jobs), _nextJob(nextJob), _inputs(),
+      _buffers()
+  {
+  }
+
+  void run()
+  {
+    selectDevice(_device);
+
+    std::vector<std::pair<const Job*, std::shared_ptr<executor::Kernel>>>
+      pipeline;
+    for (;;) {
+      // keep the compile pool busy with the next kernels of this device
+      while (pipeline.size() < _settings.ahead) {
+        auto index = _nextJob.fetch_add(1);
+        if (index >= _jobs.size()) break;
+        auto& job = _jobs[index];
+        std::shared_ptr<executor::Kernel> kernel;
+        try {
+          kernel = std::make_shared<executor::Kernel>(
+                     readFile(job.path), "KERNEL", _settings.buildOptions);
+          kernel->buildAsync();
+        } catch (std::exception& e) {
+          LOG_ERROR(e.what());
+        }
+        pipeline.push_back({&job, kernel});
+      }
+      if (pipeline.empty()) break;
+
+      auto next = pipeline.front();
+      pipeline.erase(pipeline.begin());
+      execute(*next.first, next.second.get());
+    }
+  }
+
+private:
+  void execute(const Job& job, const executor::Kernel* kernel)
+  {
+    if (kernel == nullptr) {
+      for (auto& run : job.runs) {
+        if (_results.isDone(job, run)) continue;
+        _results.add("", job, run, _device, -1, "missing_kernel");
+      }
+      return;
+    }
+
+    auto source = kernel->getSource();
+    auto highLevelHash = headerValue(source, "// High-level hash: ");
+    std::vector<Param> params;
+    try {
+      params = parseSignature(source);
+    } catch (std::exception& e) {
+      for (auto& run : job.runs) {
+        if (_results.isDone(job, run)) continue;
+        _results.add(highLevelHash, job, run, _device, -1, "invalid_kernel");
+      }
+      return;
+    }
+
+    // a kernel which does not build fails all of its runs the same way, so
+    // the failure is recorded for every run without launching any of them
+    std::string buildStatus;
+    try {
+      kernel->build();
+    } catch (cl::Error& err) {
+      buildStatus = executor::logger_impl::getErrorString(err.err());
+    } catch (std::exception& e) {
+      LOG_ERROR(job.path, ": ", e.what());
+      buildStatus = "build_error";
+    }
+    if (!buildStatus.empty()) {
+      for (auto& run : job.runs) {
+        if (_results.isDone(job, run)) continue;
+        _results.add(highLevelHash, job, run, _device, -1, buildStatus);
+      }
+      return;
+    }
+
+    for (auto& run : job.runs) {
+      if (_results.isDone(job, run)) continue;
+
+      std::string status = "ok";
+      double result = -1;
+      try {
+        std::vector<std::unique_ptr<executor::KernelArg>> owned;
+        std::vector<executor::KernelArg*> args;
+        if (!bindArgs(job, run, params, owned, args)) {
+          status = "missing_args";
+        } else {
+          std::vector<double> runtimes;
+          benchmarkResident(*kernel,
+                            run.local[0], run.local[1], run.local[2],
+                            run.global[0], run.global[1], run.global[2],
+                            args, _settings.iterations, _settings.timeout,
+                            false, runtimes);
+          std::sort(runtimes.begin(), runtimes.end());
+          result = runtimes[runtimes.size() / 2];
+          if (_settings.timeout != 0.0 && runtimes.back() >= _settings.timeout) {
+            status = "timeout";
+          }
+        }
+      } catch (cl::Error* err) {
+        status = executor::logger_impl::getErrorString(err->err());
+        delete err;
+      } catch (cl::Error& err) {
+        status = executor::logger_impl::getErrorString(err.err());
+      } catch (std::exception& e) {
+        LOG_ERROR(job.path, ": ", e.what());
+        status = "error";
+      }
+      _results.add(highLevelHash, job, run, _device, result, status);
+    }
+  }
+
+  // Creates the arguments of one run. The inputs and the output are shared
+  // by all kernels with the same sizes, so that they are uploaded only once.
+  bool bindArgs(const Job& job, const Run& run,
+                const std::vector<Param>& params,
+                std::vector<std::unique_ptr<executor::KernelArg>>& owned,
+                std::vector<executor::KernelArg*>& args)
+  {
+    auto& buffers = buffersOf(job.lowLevelHash, run.sizeId);
+    auto it = buffers.find(job.hash);
+    if (it == buffers.end()) return false;
+    auto& b = it->second;
+
+    size_t buffer = 0, temp = 0, local = 0, scalar = 0;
+    for (auto& param : params) {
+      switch (param.kind) {
+        case Param::Input:
+        case Param::Output: {
+          if (buffer >= b.inputsAndOutput.size()) return false;
+          auto bytes = b.inputsAndOutput[buffer++];
+          std::ostringstream key;
+          key << param.kind << ':' << param.type << ':' << bytes << ':'
+              << buffer;
+          auto& arg = _inputs[key.str()];
+          if (arg == nullptr) {
+            if (param.kind == Param::Output) {
+              arg.reset(executor::GlobalArg::create(bytes, true));
+            } else {
+              auto data = randomData(param.type, bytes);
+              arg.reset(executor::GlobalArg::create(data.data(), bytes));
+            }
+          }
+          args.push_back(arg.get());
+          break;
+        }
+        case Param::Temp:
+          if (temp >= run.temps.size()) return false;
+          owned.emplace_back(executor::GlobalArg::create(run.temps[temp++]));
+          args.push_back(owned.back().get());
+          break;
+        case Param::Local:
+          if (local >= run.locals.size()) return false;
+          owned.emplace_back(executor::LocalArg::create(run.locals[local++]));
+          args.push_back(owned.back().get());
+          break;
+        case Param::Scalar: {
+          // without the sizes every input has the size of the run
+          int value = scalar < b.sizes.size() ? b.sizes[scalar]
+                                              : std::stoi(run.size);
+          ++scalar;
+          owned.emplace_back(executor::ValueArg::create(&value, sizeof(value)));
+          args.push_back(owned.back().get());
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+  const std::map<std::string, Buffers>& buffersOf(const std::string& lowLevelHash,
+                                                  const std::string& sizeId)
+  {
+    auto key = lowLevelHash + "/" + sizeId;
+    auto it = _buffers.find(key);
+    if (it == _buffers.end()) {
+      it = _buffers.insert({key, readBuffers(_clFolder + "/" + lowLevelHash,
+                                             sizeId)}).first;
+    }
+    return it->second;
+  }
+
+  size_t                                                    _device;
+  std::string                                               _clFolder;
+  const Settings&                                           _settings;
+  Results&                                                  _results;
+  const std::vector<Job>&                                   _jobs;
+  std::atomic<size_t>&                                      _nextJob;
+  std::map<std::string, std::unique_ptr<executor::KernelArg>> _inputs;
+  std::map<std::string, std::map<std::string, Buffers>>     _buffers;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<int> platformIds;
+  std::vector<int> deviceIds;
+  long compileThreads = -1;
+  std::string onlySizeId;
+  std::string output;
+  std::string topFolder;
+  Settings settings;
+  settings.ahead      = 8;
+  settings.iterations = 10;
+  settings.timeout    = 100.0;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto next = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        std::cerr << arg << " requires a value\n" << usage;
+        std::exit(EXIT_FAILURE);
+      }
+      return argv[++i];
+    };
+    if (arg == "--device") {
+      auto ids = split(next(), ':');
+      if (ids.size() != 2) {
+        std::cerr << usage;
+        return EXIT_FAILURE;
+      }
+      platformIds.push_back(std::stoi(ids[0]));
+      deviceIds.push_back(std::stoi(ids[1]));
+    }
+    else if (arg == "--compile-threads")  compileThreads = std::stol(next());
+    else if (arg == "--ahead")            settings.ahead = std::stoul(next());
+    else if (arg == "--iterations")       settings.iterations = std::stoi(next());
+    else if (arg == "--timeout")          settings.timeout = std::stod(next());
+    else if (arg == "--size")             onlySizeId = next();
+    else if (arg == "--build-options")    settings.buildOptions = next();
+    else if (arg == "--output")           output = next();
+    else if (arg == "--help" || arg == "-h") {
+      std::cout << usage;
+      return EXIT_SUCCESS;
+    }
+    else if (topFolder.empty()) topFolder = arg;
+    else {
+      std::cerr << usage;
+      return EXIT_FAILURE;
+    }
+  }
+  if (topFolder.empty() || settings.iterations <= 0) {
+    std::cerr << usage;
+    return EXIT_FAILURE;
+  }
+  if (settings.ahead == 0) settings.ahead = 1;
+  if (platformIds.empty()) {
+    platformIds.push_back(0);
+    deviceIds.push_back(0);
+  }
+
+  try {
+    auto clFolder = topFolder + "/Cl";
+    if (output.empty()) output = clFolder + "/results.csv";
+
+    Results results(output);
+    auto jobs = findJobs(clFolder, onlySizeId);
+
+    // jobs of which all runs are finished are not even built
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [&](const Job& job) {
+      return std::all_of(job.runs.begin(), job.runs.end(),
+                         [&](const Run& run) { return results.isDone(job, run); });
+    }), jobs.end());
+    size_t numRuns = 0;
+    for (auto& job : jobs) numRuns += job.runs.size();
+    LOG_INFO("Running ", jobs.size(), " kernels, ", results.numDone(),
+             " results of a previous run are kept");
+
+    initExecutor(platformIds, deviceIds);
+    if (compileThreads >= 0) setCompileThreads(compileThreads);
+
+    std::atomic<size_t> nextJob(0);
+    std::vector<std::unique_ptr<DeviceRunner>> runners;
+    std::vector<std::thread> threads;
+    for (size_t d = 0; d < platformIds.size(); ++d) {
+      runners.emplace_back(new DeviceRunner(d, clFolder, settings, results,
+                                            jobs, nextJob));
+      auto runner = runners.back().get();
+      threads.emplace_back([runner] { runner->run(); });
+    }
+
+    std::mutex progressMutex;
+    std::condition_variable progressCondition;
+    bool finished = false;
+    std::thread progress([&] {
+      std::unique_lock<std::mutex> lock(progressMutex);
+      while (!progressCondition.wait_for(lock, std::chrono::seconds(10),
+                                         [&] { return finished; })) {
+        LOG_INFO(results.count(), " of ", numRuns, " runs done");
+      }
+    });
+
+    for (auto& thread : threads) thread.join();
+    {
+      std::lock_guard<std::mutex> lock(progressMutex);
+      finished = true;
+    }
+    progressCondition.notify_all();
+    progress.join();
+
+    // the arguments of the runners are released before the devices
+    runners.clear();
+    shutdownExecutor();
+    LOG_INFO("Results written to ", output);
+  } catch (cl::Error* err) {
+    std::cerr << "OpenCL error: " << err->what() << " ("
+              << executor::logger_impl::getErrorString(err->err()) << ")\n";
+    delete err;
+    return EXIT_FAILURE;
+  } catch (cl::Error& err) {
+    std::cerr << "OpenCL error: " << err.what() << " ("
+              << executor::logger_impl::getErrorString(err.err()) << ")\n";
+    return EXIT_FAILURE;
+  } catch (std::exception& e) {
+    std::cerr << "error: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,365 @@
+///
+/// \file KernelRunner.cpp
+///
+/// A command line tool benchmarking OpenCL kernels, e.g. those written by
+/// SaveOpenCL, without a JVM.
+///
+/// Usage: kernel-runner [options] <kernel.cl> <argument spec>
+///
+/// The argument spec describes the arguments of the kernel in order, one per
+/// line, and optionally the NDRange and the name of the kernel:
+///
+///   # comment
+///   kernel  KERNEL          (default: the first __kernel in the file)
+///   local   32,1,1          (default: "// Local sizes:" of the header)
+///   global  1024,1,1        (default: "// Global sizes:" of the header)
+///   input   float 1024 random       an input of 1024 floats, which are
+///                                   random, zero, <a number> or
+///                                   file:<path> (raw binary)
+///   output  float 1024              an output of 1024 floats
+///   local   float 256               local memory of 256 floats
+///   value   int 1024                a scalar argument with the value 1024
+///
+/// The statistics of the runtimes are printed as CSV or JSON.
+///
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Executor.h"
+#include "GlobalArg.h"
+#include "LocalArg.h"
+#include "ValueArg.h"
+
+namespace {
+
+const char* usage =
+  "Usage: kernel-runner [options] <kernel.cl> <argument spec>\n"
+  "Options:\n"
+  "  --platform <id>       OpenCL platform (default: 0)\n"
+  "  --device <id>         OpenCL device (default: 0)\n"
+  "  --build-options <s>   options passed to the OpenCL compiler\n"
+  "  --warmup <n>          unmeasured runs (default: 3)\n"
+  "  --min <n>             minimal measured runs (default: 10)\n"
+  "  --max <n>             maximal measured runs (default: 1000)\n"
+  "  --target-error <f>    relative half width of the confidence interval\n"
+  "                        to stop at (default: 0.01)\n"
+  "  --timeout <ms>        stop after a run taking at least this long\n"
+  "  --format csv|json     output format (default: csv)\n"
+  "  --no-header           omit the CSV header\n";
+
+struct ArgSpec {
+  std::string kind;   // input, output, local or value
+  std::string type;
+  size_t      count;
+  std::string init;   // inputs and values only
+};
+
+struct RunSpec {
+  std::string           kernelName;
+  std::vector<int>      local;
+  std::vector<int>      global;
+  std::vector<ArgSpec>  args;
+};
+
+size_t sizeOfType(const std::string& type)
+{
+  if (type == "char"   || type == "uchar")  return 1;
+  if (type == "short"  || type == "ushort") return 2;
+  if (type == "int"    || type == "uint"   || type == "float") return 4;
+  if (type == "long"   || type == "ulong"  || type == "double") return 8;
+  throw std::runtime_error("unsupported type: " + type);
+}
+
+// Parses "x,y,z"; returns an empty vector if a component is not a number,
+// e.g. a size variable in the header of a generated kernel
+std::vector<int> parseRange(const std::string& string)
+{
+  std::vector<int> range;
+  std::istringstream stream(string);
+  std::string component;
+  while (std::getline(stream, component, ',')) {
+    char* end = nullptr;
+    auto value = std::strtol(component.c_str(), &end, 10);
+    while (end != nullptr && *end == ' ') ++end;
+    if (end == component.c_str() || (end != nullptr && *end != '\0')) {
+      return std::vector<int>();
+    }
+    range.push_back(static_cast<int>(value));
+  }
+  while (!range.empty() && range.size() < 3) range.push_back(1);
+  return range.size() == 3 ? range : std::vector<int>();
+}
+
+// Returns the value following prefix in the header comments of source
+std::string headerValue(const std::string& source, const std::string& prefix)
+{
+  auto pos = source.find(prefix);
+  if (pos == std::string::npos) return std::string();
+  pos += prefix.size();
+  return source.substr(pos, source.find('\n', pos) - pos);
+}
+
+std::string firstKernelName(const std::string& source)
+{
+  // matches both kernel and __kernel, the name precedes the parameter list
+  auto pos = source.find("kernel ");
+  auto open = pos == std::string::npos ? pos : source.find('(', pos);
+  if (open == std::string::npos) throw std::runtime_error("no kernel found");
+  auto end = source.find_last_not_of(" \t\n", open - 1);
+  auto begin = source.find_last_of(" \t\n*", end);
+  return source.substr(begin + 1, end - begin);
+}
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::runtime_error("cannot read " + path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+RunSpec parseSpec(const std::string& path, const std::string& source)
+{
+  RunSpec spec;
+  spec.local  = parseRange(headerValue(source, "// Local sizes: "));
+  spec.global = parseRange(headerValue(source, "// Global sizes: "));
+
+  std::istringstream lines(readFile(path));
+  std::string line;
+  size_t lineNumber = 0;
+  while (std::getline(lines, line)) {
+    ++lineNumber;
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    std::string keyword;
+    if (!(words >> keyword)) continue;
+
+    auto error = [&](const std::string& message) {
+      return std::runtime_error(path + ":" + std::to_string(lineNumber)
+                                + ": " + message);
+    };
+
+    std::string first;
+    words >> first;
+    if (keyword == "kernel") {
+      spec.kernelName = first;
+    } else if ((keyword == "local" || keyword == "global")
+               && first.find(',') != std::string::npos) {
+      auto range = parseRange(first);
+      if (range.empty()) throw error("invalid NDRange " + first);
+      (keyword == "local" ? spec.local : spec.global) = range;
+    } else if (keyword == "input" || keyword == "output"
+               || keyword == "local" || keyword == "value") {
+      ArgSpec arg;
+      arg.kind  = keyword;
+      arg.type  = first;
+      arg.count = 1;
+      if (keyword == "value") {
+        if (!(words >> arg.init)) throw error("missing value");
+      } else {
+        if (!(words >> arg.count)) throw error("missing element count");
+        words >> arg.init;
+        if (arg.init.empty()) arg.init = "random";
+      }
+      sizeOfType(arg.type);
+      spec.args.push_back(arg);
+    } else {
+      throw error("unknown keyword " + keyword);
+    }
+  }
+
+  if (spec.kernelName.empty()) spec.kernelName = firstKernelName(source);
+  if (spec.local.empty() || spec.global.empty()) {
+    throw std::runtime_error("the NDRange is neither given in " + path
+                             + " nor in the header of the kernel");
+  }
+  return spec;
+}
+
+template <typename T>
+void fill(std::vector<char>& data, const std::string& init, std::mt19937& rng)
+{
+  auto values = reinterpret_cast<T*>(data.data());
+  auto count = data.size() / sizeof(T);
+  if (init == "random") {
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    for (size_t i = 0; i < count; ++i) {
+      // integers between 0 and 9, so that sums do not overflow quickly
+      values[i] = static_cast<T>(std::is_floating_point<T>::value
+                                 ? distribution(rng)
+                                 : distribution(rng) * 10);
+    }
+  } else {
+    auto value = static_cast<T>(init == "zero" ? 0.0 : std::stod(init));
+    for (size_t i = 0; i < count; ++i) values[i] = value;
+  }
+}
+
+std::vector<char> initialData(const ArgSpec& arg, std::mt19937& rng)
+{
+  std::vector<char> data(arg.count * sizeOfType(arg.type));
+  if (arg.init.compare(0, 5, "file:") == 0) {
+    auto contents = readFile(arg.init.substr(5));
+    if (contents.size() != data.size()) {
+      throw std::runtime_error(arg.init.substr(5) + " does not contain "
+                               + std::to_string(data.size()) + " bytes");
+    }
+    return std::vector<char>(contents.begin(), contents.end());
+  }
+
+  auto& t = arg.type;
+  if      (t == "char"   || t == "uchar")  fill<char>(data, arg.init, rng);
+  else if (t == "short"  || t == "ushort") fill<short>(data, arg.init, rng);
+  else if (t == "int"    || t == "uint")   fill<int>(data, arg.init, rng);
+  else if (t == "long"   || t == "ulong")  fill<long long>(data, arg.init, rng);
+  else if (t == "float")                   fill<float>(data, arg.init, rng);
+  else                                     fill<double>(data, arg.init, rng);
+  return data;
+}
+
+void printCsv(std::ostream& out, bool header, const std::string& file,
+              const RunSpec& spec, const executor::BenchmarkSummary& s)
+{
+  if (header) {
+    out << "file,kernel,local0,local1,local2,global0,global1,global2,"
+           "runs,outliers,mean,median,p5,p95,stddev,ci_low,ci_high,"
+           "converged\n";
+  }
+  out << file << ',' << spec.kernelName;
+  for (auto l : spec.local)  out << ',' << l;
+  for (auto g : spec.global) out << ',' << g;
+  out << ',' << s.runtimes.size() << ',' << s.outliers
+      << ',' << s.mean << ',' << s.median << ',' << s.p5 << ',' << s.p95
+      << ',' << s.stdDev << ',' << s.ciLow << ',' << s.ciHigh
+      << ',' << (s.converged ? "true" : "false") << '\n';
+}
+
+void printJson(std::ostream& out, const std::string& file,
+               const RunSpec& spec, const executor::BenchmarkSummary& s)
+{
+  auto range = [](const std::vector<int>& r) {
+    return "[" + std::to_string(r[0]) + "," + std::to_string(r[1]) + ","
+               + std::to_string(r[2]) + "]";
+  };
+  out << "{\"file\":\"" << file << "\",\"kernel\":\"" << spec.kernelName
+      << "\",\"local\":" << range(spec.local)
+      << ",\"global\":" << range(spec.global)
+      << ",\"runs\":" << s.runtimes.size() << ",\"outliers\":" << s.outliers
+      << ",\"mean\":" << s.mean << ",\"median\":" << s.median
+      << ",\"p5\":" << s.p5 << ",\"p95\":" << s.p95
+      << ",\"stddev\":" << s.stdDev
+      << ",\"ci\":[" << s.ciLow << "," << s.ciHigh << "]"
+      << ",\"converged\":" << (s.converged ? "true" : "false")
+      << ",\"runtimes\":[";
+  for (size_t i = 0; i < s.runtimes.size(); ++i) {
+    out << (i == 0 ? "" : ",") << s.runtimes[i];
+  }
+  out << "]}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int platformId = 0;
+  int deviceId = 0;
+  std::string buildOptions;
+  std::string format = "csv";
+  bool header = true;
+  executor::BenchmarkOptions options;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto next = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        std::cerr << arg << " requires a value\n" << usage;
+        std::exit(EXIT_FAILURE);
+      }
+      return argv[++i];
+    };
+    if      (arg == "--platform")       platformId = std::stoi(next());
+    else if (arg == "--device")         deviceId = std::stoi(next());
+    else if (arg == "--build-options")  buildOptions = next();
+    else if (arg == "--warmup")         options.warmupIterations = std::stoi(next());
+    else if (arg == "--min")            options.minIterations = std::stoi(next());
+    else if (arg == "--max")            options.maxIterations = std::stoi(next());
+    else if (arg == "--target-error")   options.targetRelativeError = std::stod(next());
+    else if (arg == "--timeout")        options.timeout = std::stod(next());
+    else if (arg == "--format")         format = next();
+    else if (arg == "--no-header")      header = false;
+    else if (arg == "--help" || arg == "-h") {
+      std::cout << usage;
+      return EXIT_SUCCESS;
+    }
+    else files.push_back(arg);
+  }
+  if (files.size() != 2 || (format != "csv" && format != "json")) {
+    std::cerr << usage;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    auto source = readFile(files[0]);
+    auto spec = parseSpec(files[1], source);
+
+    initExecutor(platformId, deviceId);
+
+    // a fixed seed makes runs comparable
+    std::mt19937 rng(42);
+    std::vector<std::unique_ptr<executor::KernelArg>> owned;
+    std::vector<executor::KernelArg*> args;
+    for (auto& argSpec : spec.args) {
+      auto bytes = argSpec.count * sizeOfType(argSpec.type);
+      executor::KernelArg* arg;
+      if (argSpec.kind == "local") {
+        arg = executor::LocalArg::create(bytes);
+      } else if (argSpec.kind == "output") {
+        arg = executor::GlobalArg::create(bytes, true);
+      } else {
+        auto data = initialData(argSpec, rng);
+        arg = argSpec.kind == "value"
+            ? executor::ValueArg::create(data.data(), sizeOfType(argSpec.type))
+            : executor::GlobalArg::create(data.data(), data.size());
+      }
+      owned.emplace_back(arg);
+      args.push_back(arg);
+    }
+
+    executor::Kernel kernel(source, spec.kernelName, buildOptions);
+    auto summary = benchmarkAdaptive(kernel,
+                                     spec.local[0], spec.local[1], spec.local[2],
+                                     spec.global[0], spec.global[1], spec.global[2],
+                                     args, options);
+
+    if (format == "csv") printCsv(std::cout, header, files[0], spec, summary);
+    else                 printJson(std::cout, files[0], spec, summary);
+
+    owned.clear();
+    shutdownExecutor();
+  } catch (cl::Error* err) {
+    std::cerr << "OpenCL error: " << err->what() << " ("
+              << executor::logger_impl::getErrorString(err->err()) << ")\n";
+    delete err;
+    return EXIT_FAILURE;
+  } catch (cl::Error& err) {
+    std::cerr << "OpenCL error: " << err.what() << " ("
+              << executor::logger_impl::getErrorString(err.err()) << ")\n";
+    return EXIT_FAILURE;
+  } catch (std::exception& e) {
+    std::cerr << "error: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+///
+/// \file Hash.cpp
+///
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "util/Hash.h"
+
+namespace executor {
+
+namespace util {
+
+uint64_t hash(const void* data, size_t size, uint64_t seed)
+{
+  auto bytes = static_cast<const unsigned char*>(data);
+  uint64_t h = seed;
+  for (size_t i = 0; i < size; ++i) {
+    h ^= bytes[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+uint64_t hash(const std::string& s, uint64_t seed)
+{
+  // hash the length as well, so that concatenated strings can not collide
+  // by shifting characters from one string into the next
+  auto size = static_cast<uint64_t>(s.size());
+  return hash(s.data(), s.size(), hash(&size, sizeof(size), seed));
+}
+
+std::string hashToString(uint64_t hash)
+{
+  std::ostringstream s;
+  s << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return s.str();
+}
+
+} // namespace util
+
+} // namespace executor
@@ -0,0 +1,204 @@
+///
+/// \file Metrics.cpp
+///
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "util/Logger.h"
+#include "util/Metrics.h"
+
+namespace {
+
+// sub-buckets per power of two
+const unsigned subBucketBits = 4;
+const uint64_t subBuckets    = 1 << subBucketBits;
+
+unsigned log2(uint64_t value)
+{
+  unsigned result = 0;
+  while (value >>= 1) ++result;
+  return result;
+}
+
+} // namespace
+
+namespace executor {
+
+MetricsRegistry globalMetrics;
+
+Histogram::Histogram()
+  : _buckets(), _count(0), _sum(0), _max(0)
+{
+  for (auto& bucket : _buckets) bucket.store(0);
+}
+
+size_t Histogram::bucketOf(uint64_t value)
+{
+  if (value < subBuckets) return value;
+  auto exponent = log2(value);
+  auto subBucket = (value >> (exponent - subBucketBits)) & (subBuckets - 1);
+  return (exponent - subBucketBits + 1) * subBuckets + subBucket;
+}
+
+double Histogram::midpointOf(size_t bucket)
+{
+  if (bucket < subBuckets) return bucket;
+  auto exponent = bucket / subBuckets + subBucketBits - 1;
+  auto subBucket = bucket % subBuckets;
+  auto width = static_cast<double>(uint64_t(1) << (exponent - subBucketBits));
+  return (subBuckets + subBucket) * width + width / 2.0;
+}
+
+void Histogram::record(uint64_t value)
+{
+  _buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+  _count.fetch_add(1, std::memory_order_relaxed);
+  _sum.fetch_add(value, std::memory_order_relaxed);
+  auto max = _max.load(std::memory_order_relaxed);
+  while (value > max
+         && !_max.compare_exchange_weak(max, value,
+                                        std::memory_order_relaxed)) {}
+}
+
+uint64_t Histogram::count() const
+{
+  return _count.load(std::memory_order_relaxed);
+}
+
+double Histogram::mean() const
+{
+  auto n = count();
+  return n == 0 ? 0.0
+                : static_cast<double>(_sum.load(std::memory_order_relaxed)) / n;
+}
+
+uint64_t Histogram::max() const
+{
+  return _max.load(std::memory_order_relaxed);
+}
+
+double Histogram::percentile(double fraction) const
+{
+  // buckets are updated concurrently, so their sum is used instead of count
+  uint64_t total = 0;
+  for (auto& bucket : _buckets) total += bucket.load(std::memory_order_relaxed);
+  if (total == 0) return 0.0;
+
+  auto rank = static_cast<uint64_t>(fraction * total);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < numBuckets; ++i) {
+    seen += _buckets[i].load(std::memory_order_relaxed);
+    if (seen > rank) return std::min(midpointOf(i), static_cast<double>(max()));
+  }
+  return max();
+}
+
+MetricsRegistry::MetricsRegistry()
+  : _mutex(), _counters(), _histograms(), _gauges(), _enabled(false),
+    _dumpMutex(),
+    _dumpCondition(), _dumpThread(), _stopDump(false)
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+  stopPeriodicDump();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& counter = _counters[name];
+  if (counter == nullptr) counter.reset(new Counter);
+  return *counter;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& histogram = _histograms[name];
+  if (histogram == nullptr) histogram.reset(new Histogram);
+  return *histogram;
+}
+
+void MetricsRegistry::gauge(const std::string& name,
+                            std::function<double()> function)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _gauges[name] = std::move(function);
+}
+
+std::map<std::string, double> MetricsRegistry::snapshot() const
+{
+  std::map<std::string, double> values;
+  std::map<std::string, std::function<double()>> gauges;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& counter : _counters) {
+      values[counter.first] = counter.second->value();
+    }
+    for (auto& entry : _histograms) {
+      auto& histogram = *entry.second;
+      values[entry.first + ".count"] = histogram.count();
+      values[entry.first + ".mean"]  = histogram.mean();
+      values[entry.first + ".p50"]   = histogram.percentile(0.50);
+      values[entry.first + ".p90"]   = histogram.percentile(0.90);
+      values[entry.first + ".p99"]   = histogram.percentile(0.99);
+      values[entry.first + ".max"]   = histogram.max();
+    }
+    gauges = _gauges;
+  }
+  // gauges might take locks of their own
+  for (auto& gauge : gauges) values[gauge.first] = gauge.second();
+  return values;
+}
+
+void MetricsRegistry::write(std::ostream& output) const
+{
+  auto values = snapshot();
+  auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+  output << "{\"timestamp\":" << now;
+  for (auto& value : values) {
+    output << ",\"" << value.first << "\":" << value.second;
+  }
+  output << "}\n";
+}
+
+void MetricsRegistry::startPeriodicDump(const std::string& path,
+                                        double intervalInSeconds)
+{
+  stopPeriodicDump();
+  enable();
+  _stopDump = false;
+  auto interval = std::chrono::milliseconds(
+                    static_cast<long long>(intervalInSeconds * 1000.0));
+  _dumpThread = std::thread([this, path, interval] {
+    std::unique_lock<std::mutex> lock(_dumpMutex);
+    while (!_dumpCondition.wait_for(lock, interval,
+                                    [this] { return _stopDump; })) {
+      std::ofstream file(path, std::ios::app);
+      if (!file) {
+        LOG_ERROR("Cannot write metrics to ", path);
+        continue;
+      }
+      write(file);
+    }
+  });
+}
+
+void MetricsRegistry::stopPeriodicDump()
+{
+  if (!_dumpThread.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(_dumpMutex);
+    _stopDump = true;
+  }
+  _dumpCondition.notify_all();
+  _dumpThread.join();
+}
+
+} // namespace executor
@@ -0,0 +1,262 @@
+///
+/// \file Trace.cpp
+///
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#undef  __CL_ENABLE_EXCEPTIONS
+
+#include "util/Logger.h"
+#include "util/Trace.h"
+
+namespace {
+
+// process ids of the two groups of lanes in the trace
+const int hostPid   = 0;
+const int devicePid = 1;
+
+void writeEscaped(std::ostream& output, const std::string& string)
+{
+  for (auto c : string) {
+    if (c == '"' || c == '\\') output << '\\';
+    if (static_cast<unsigned char>(c) < 0x20) continue;
+    output << c;
+  }
+}
+
+} // namespace
+
+namespace executor {
+
+Tracer globalTracer;
+
+Tracer::Tracer()
+  : _enabled(false), _capacity(65536), _start(clock::now()), _mutex(),
+    _buffers(), _nextThreadId(0)
+{
+  // the trace is written by terminate() to the given path
+  if (std::getenv("LIFT_EXECUTOR_TRACE") != nullptr) enable();
+}
+
+void Tracer::enable(size_t eventsPerThread)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _capacity = eventsPerThread == 0 ? 1 : eventsPerThread;
+  for (auto& weakBuffer : _buffers) {
+    auto buffer = weakBuffer.lock();
+    if (buffer == nullptr) continue;
+    std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+    buffer->ring.clear();
+    buffer->ring.resize(_capacity);
+    buffer->next   = 0;
+    buffer->count  = 0;
+    buffer->pending.clear();
+    buffer->pushed = 0;
+  }
+  _enabled = true;
+}
+
+void Tracer::disable()
+{
+  _enabled = false;
+}
+
+void Tracer::recordSpan(const std::string& name, const char* category,
+                        clock::time_point begin, clock::time_point end,
+                        size_t bytes)
+{
+  if (!isEnabled()) return;
+  Event event;
+  event.name     = name;
+  event.category = category;
+  event.begin    = sinceStart(begin);
+  event.end      = sinceStart(end);
+  event.bytes    = bytes;
+  event.deviceId = 0;
+  event.device   = false;
+  event.failed   = false;
+  push(std::move(event));
+}
+
+void Tracer::recordCommand(const std::string& name, const char* category,
+                           const std::vector<cl::Event>& events,
+                           clock::time_point enqueued, unsigned deviceId,
+                           size_t bytes)
+{
+  if (!isEnabled() || events.empty()) return;
+  Event event;
+  event.name         = name;
+  event.category     = category;
+  event.begin        = sinceStart(enqueued);
+  event.end          = event.begin;
+  event.bytes        = bytes;
+  event.deviceEvents = events;
+  event.deviceId     = deviceId;
+  event.device       = true;
+  event.failed       = false;
+  push(std::move(event));
+}
+
+void Tracer::write(std::ostream& output) const
+{
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& weakBuffer : _buffers) {
+      auto buffer = weakBuffer.lock();
+      if (buffer != nullptr) buffers.push_back(buffer);
+    }
+  }
+
+  output << "{\"traceEvents\":[\n"
+         << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << hostPid
+         << ",\"args\":{\"name\":\"host\"}},\n"
+         << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << devicePid
+         << ",\"args\":{\"name\":\"OpenCL devices\"}}";
+
+  for (auto& buffer : buffers) {
+    std::vector<Event> events;
+    unsigned threadId;
+    {
+      std::lock_guard<std::mutex> lock(buffer->mutex);
+      resolvePending(*buffer);
+      // oldest first
+      auto first = (buffer->next + buffer->ring.size() - buffer->count)
+                 % buffer->ring.size();
+      for (size_t i = 0; i < buffer->count; ++i) {
+        events.push_back(buffer->ring[(first + i) % buffer->ring.size()]);
+      }
+      threadId = buffer->threadId;
+    }
+
+    for (auto& event : events) {
+      // device commands which have not finished yet are left out
+      if (!resolve(event) || event.failed) continue;
+
+      int pid = event.device ? devicePid : hostPid;
+      unsigned tid = event.device ? event.deviceId : threadId;
+      auto begin = event.begin;
+      auto end   = event.end;
+
+      output << ",\n{\"name\":\"";
+      writeEscaped(output, event.name);
+      output << "\",\"cat\":\"" << event.category
+             << "\",\"ph\":\"X\",\"ts\":" << begin / 1000.0
+             << ",\"dur\":" << (end - begin) / 1000.0
+             << ",\"pid\":" << pid << ",\"tid\":" << tid;
+      if (event.bytes != 0) {
+        output << ",\"args\":{\"bytes\":" << event.bytes << "}";
+      }
+      output << "}";
+    }
+  }
+  output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool Tracer::write(const std::string& path) const
+{
+  std::ofstream file(path);
+  if (!file) {
+    LOG_ERROR("Cannot write trace to ", path);
+    return false;
+  }
+  write(file);
+  LOG_INFO("Trace written to ", path);
+  return static_cast<bool>(file);
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer()
+{
+  // owns the ring, which is released when the thread exits
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (buffer == nullptr) {
+    buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lock(_mutex);
+    buffer->ring.resize(_capacity);
+    buffer->next     = 0;
+    buffer->count    = 0;
+    buffer->threadId = _nextThreadId++;
+    buffer->pushed   = 0;
+    // forget the rings of threads which have exited
+    _buffers.erase(std::remove_if(_buffers.begin(), _buffers.end(),
+                     [](const std::weak_ptr<ThreadBuffer>& weakBuffer) {
+                       return weakBuffer.expired();
+                     }), _buffers.end());
+    _buffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void Tracer::push(Event&& event)
+{
+  auto& buffer = threadBuffer();
+  // only contended while the trace is written or the tracer is re-enabled
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  resolvePending(buffer);
+  if (!event.deviceEvents.empty()) {
+    buffer.pending.emplace_back(buffer.next, buffer.pushed);
+  }
+  buffer.ring[buffer.next] = std::move(event);
+  buffer.next = (buffer.next + 1) % buffer.ring.size();
+  if (buffer.count < buffer.ring.size()) ++buffer.count;
+  ++buffer.pushed;
+}
+
+void Tracer::resolvePending(ThreadBuffer& buffer)
+{
+  // commands complete roughly in the order they have been recorded, so the
+  // first one still running ends the search
+  while (!buffer.pending.empty()) {
+    auto& oldest = buffer.pending.front();
+    bool overwritten = buffer.pushed - oldest.second > buffer.ring.size();
+    if (!overwritten && !resolve(buffer.ring[oldest.first])) break;
+    buffer.pending.pop_front();
+  }
+}
+
+bool Tracer::resolve(Event& event)
+{
+  if (event.deviceEvents.empty()) return true;
+  try {
+    auto& first = event.deviceEvents.front();
+    auto& last  = event.deviceEvents.back();
+    auto status = last.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>();
+    if (status > CL_COMPLETE) return false;
+    if (status < 0) {
+      // the command has been terminated abnormally
+      event.failed = true;
+    } else {
+      auto queued = static_cast<long long>(
+                      first.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>());
+      auto start  = static_cast<long long>(
+                      first.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+      auto finish = static_cast<long long>(
+                      last.getProfilingInfo<CL_PROFILING_COMMAND_END>());
+      // device clock -> host clock
+      auto offset = event.begin - queued;
+      event.begin = start + offset;
+      event.end   = finish + offset;
+    }
+  } catch (cl::Error& err) {
+    event.failed = true;
+  }
+  // release the events
+  std::vector<cl::Event>().swap(event.deviceEvents);
+  return true;
+}
+
+long long Tracer::sinceStart(clock::time_point time) const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           time - _start).count();
+}
+
+} // namespace executor
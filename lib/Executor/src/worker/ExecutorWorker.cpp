@@ -0,0 +1,144 @@
+///
+/// \file ExecutorWorker.cpp
+///
+/// The executor-worker process used by the WorkerPool. It executes the jobs
+/// it reads from the socket passed on the command line one after the other
+/// and exits once the socket is closed.
+///
+/// Usage: executor-worker <socket fd> <platform id> <device id>
+///
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Executor.h"
+#include "GlobalArg.h"
+#include "LocalArg.h"
+#include "ValueArg.h"
+#include "WorkerProtocol.h"
+
+#include "util/Logger.h"
+
+using namespace executor::worker;
+
+namespace {
+
+bool readString(int fd, size_t length, std::string& string)
+{
+  string.resize(length);
+  return length == 0 || readFully(fd, &string[0], length);
+}
+
+// returns the OpenCL status of the job and stores the runtime in runtime
+int runJob(const JobHeader& header, const std::string& source,
+           const std::string& name, const std::string& options,
+           const std::vector<ArgDescriptor>& descriptors, double& runtime)
+{
+  std::string shmName(header.sharedMemoryName,
+                      strnlen(header.sharedMemoryName,
+                              sizeof(header.sharedMemoryName)));
+  int fd = shm_open(shmName.c_str(), O_RDWR, 0);
+  if (fd < 0) return CL_OUT_OF_HOST_MEMORY;
+  auto mapping = mmap(nullptr, header.sharedMemorySize,
+                      PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return CL_OUT_OF_HOST_MEMORY;
+  auto memory = static_cast<char*>(mapping);
+
+  int status = CL_SUCCESS;
+  {
+    std::vector<std::unique_ptr<executor::KernelArg>> owned;
+    std::vector<executor::KernelArg*> args;
+    std::vector<executor::GlobalArg*> outputs;
+    for (auto& d : descriptors) {
+      executor::KernelArg* arg = nullptr;
+      switch (d.kind) {
+        case ArgInput:
+        case ArgOutput:
+          // outputs are downloaded straight into the shared memory
+          arg = executor::GlobalArg::createExternal(memory + d.offset, d.size,
+                                                    d.kind == ArgOutput);
+          if (d.kind == ArgOutput) {
+            outputs.push_back(static_cast<executor::GlobalArg*>(arg));
+          }
+          break;
+        case ArgLocal:
+          arg = executor::LocalArg::create(d.size);
+          break;
+        default:
+          arg = executor::ValueArg::create(memory + d.offset, d.size);
+          break;
+      }
+      owned.emplace_back(arg);
+      args.push_back(arg);
+    }
+
+    try {
+      executor::Kernel kernel(source, name, options);
+      runtime = execute(kernel,
+                        header.localSize[0], header.localSize[1],
+                        header.localSize[2], header.globalSize[0],
+                        header.globalSize[1], header.globalSize[2], args);
+      // waits for the downloads into the shared memory
+      for (auto output : outputs) output->hostData();
+    } catch (cl::Error& err) {
+      status = err.err();
+    } catch (cl::Error* err) {
+      status = err->err();
+      delete err;
+    } catch (...) {
+      status = CL_INVALID_VALUE;
+    }
+  }
+  munmap(memory, header.sharedMemorySize);
+  return status;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc != 4) {
+    LOG_ERROR("Usage: ", argv[0], " <socket fd> <platform id> <device id>");
+    return EXIT_FAILURE;
+  }
+  int socket = std::atoi(argv[1]);
+  initExecutor(std::atoi(argv[2]), std::atoi(argv[3]));
+
+  for (;;) {
+    JobHeader header;
+    // the pool closed the socket
+    if (!readFully(socket, &header, sizeof(header))) break;
+    if (header.magic != jobMagic) {
+      LOG_ERROR("Received a corrupted job");
+      break;
+    }
+
+    std::string source, name, options;
+    std::vector<ArgDescriptor> descriptors(header.numArgs);
+    if (!readString(socket, header.sourceLength, source)
+        || !readString(socket, header.nameLength, name)
+        || !readString(socket, header.optionsLength, options)
+        || !readFully(socket, descriptors.data(),
+                      descriptors.size() * sizeof(ArgDescriptor))) {
+      break;
+    }
+
+    JobReply reply;
+    reply.padding = 0;
+    reply.runtime = 0.0;
+    reply.status  = runJob(header, source, name, options, descriptors,
+                           reply.runtime);
+    if (!writeFully(socket, &reply, sizeof(reply))) break;
+  }
+
+  shutdownExecutor();
+  return EXIT_SUCCESS;
+}
@@ -2,11 +2,12 @@ package benchmarks
 
 import java.io._
 
+import ir.Type
 import ir.ast.Lambda
 import opencl.executor.Decoder.DecodeTypes.DecodeType
 import opencl.executor.Executor.ExecutorFailureException
 import opencl.executor._
-import opencl.generator.Verbose
+import opencl.generator.{NDRange, Verbose}
 import _root_.utils.CommandLineParser
 import scopt.OParser
 
@@ -34,9 +35,9 @@ object BenchmarkUtils {
   def median(sorted: Array[Double]): Double = {
     val trials = sorted.length
     if (trials % 2 == 0)
-      sorted((trials - 1) / 2)
-    else
       (sorted((trials - 1) / 2) + sorted(trials / 2)) / 2
+    else
+      sorted(trials / 2)
   }
 }
 
@@ -302,56 +303,51 @@ abstract class Benchmark[T: ClassTag](val name: String,
                                    configuration: BenchmarkConfiguration) : InstanceStatistic = {
     var runtimes = Array.ofDim[Double](configuration.trials, lambdas.length)
     var validities = Array.ofDim[RunResult](configuration.trials)
-    // cache the compiled kernels
-    val kernels = Array.ofDim[String](lambdas.length)
+
+    val localSize = NDRange(
+      cmdArgs.get.localSize(0),
+      cmdArgs.get.localSize(1),
+      cmdArgs.get.localSize(2))
+    // the first kernel is launched with the given global size, all following ones with 128
+    val globalSizes = NDRange(
+      cmdArgs.get.globalSize(0),
+      cmdArgs.get.globalSize(1),
+      cmdArgs.get.globalSize(2)) +: Seq.fill(lambdas.length - 1)(NDRange(128, 1, 1))
+
+    // compile the kernels once, every kernel is applied to the output of the previous one
+    var argT: Type = null
+    val stages = for (j <- lambdas.indices) yield {
+      val lambda = lambdas(j)
+      val globalSize = globalSizes(j)
+      val kernel = if (j == 0)
+        Utils.compile(lambda, inputs,
+          localSize(0).eval, localSize(1).eval, localSize(2).eval,
+          globalSize(0).eval, globalSize(1).eval, globalSize(2).eval,
+          (configuration.injectLocal, configuration.injectGroup))
+      else
+        Utils.compile(lambda, argT,
+          localSize(0).eval, localSize(1).eval, localSize(2).eval,
+          globalSize(0).eval, globalSize(1).eval, globalSize(2).eval,
+          (configuration.injectLocal, configuration.injectGroup))
+
+      val valueMap =
+        if (j == 0) Execute.createValueMap(lambda, inputs: _*)
+        else Execute.createValueMap.fromType(lambda, argT)
+      argT = Type.substitute(lambda.body.t, valueMap)
+
+      Execute.PipelineStage(kernel, lambda, localSize, globalSizes(j))
+    }
+
     for (i <- 0 until configuration.trials) {
       if (i == 1)
         Verbose(false)
       println("Iteration: " + i)
 
-      /*
-        Actually run the lambdas - inlined from the old "runOpenCL" function
-       */
-      var realInputs = inputs
-      val realGlobalSizes = cmdArgs.get.globalSize
-      var totalRuntime = 0.0
-      var finalOutput: Array[T] = Array.ofDim[T](1)
-
-      for (j <- lambdas.indices) {
-        if(i == 0)
-          kernels(j) = Utils.compile(lambdas(j),
-            realInputs,
-            cmdArgs.get.localSize(0),
-            cmdArgs.get.localSize(1),
-            cmdArgs.get.localSize(2),
-            realGlobalSizes(0),
-            realGlobalSizes(1),
-            realGlobalSizes(2),
-            (configuration.injectLocal, configuration.injectGroup))
-
-        val (kOutput, kRuntime) = Execute(
-          cmdArgs.get.localSize(0),
-          cmdArgs.get.localSize(1),
-          cmdArgs.get.localSize(2),
-          realGlobalSizes(0),
-          realGlobalSizes(1),
-          realGlobalSizes(2),
-          (configuration.injectLocal, configuration.injectGroup)
-        )[T](kernels(j), realInputs)
-
-        // update parameters for next kernel, if any
-        realInputs = Seq(kOutput)
-        //realGlobalSizes(0) = kOutput.length
-        realGlobalSizes(0) = 128
-        realGlobalSizes(1) = 1
-        realGlobalSizes(2) = 1
-
-        totalRuntime += kRuntime
-        runtimes(i)(j) = kRuntime
-        finalOutput(0) = kOutput
-      }
+      // intermediate results stay on the device, only the final output is copied back
+      val (finalOutput, stageRuntimes) = Execute.pipeline[T](stages, inputs: _*)
+      runtimes(i) = stageRuntimes
 
-      val output = postProcessResult(variant, name, finalOutput(0))
+      val output = postProcessResult(variant, name, finalOutput)
 
       validities(i) = configuration.checkResult match {
         case true => {
@@ -180,6 +180,21 @@ class SaveOpenCL(
           localTempAlloc.mkString(",")+ "\n")
 
         fileWriter.close()
+
+        // Sizes of the inputs and the output in bytes and the values of the
+        // size parameters, which are sorted by name like in the kernel
+        // signature, as needed by the exploration-runner of the executor
+        val inputsAndOutput = allBufferSizes.take(numParams + 1)
+        val sizeValues = sizes.map(_.eval)
+
+        val argsWriter = new FileWriter(s"$path/args_$sizeId.csv", true)
+
+        argsWriter.write(s"$hash," + inputsAndOutput.length + "," +
+          inputsAndOutput.mkString(",") + "," + sizeValues.length +
+          (if (sizeValues.isEmpty) "" else ",") +
+          sizeValues.mkString(",") + "\n")
+
+        argsWriter.close()
       }
     })
   }
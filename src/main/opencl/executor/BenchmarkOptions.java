@@ -0,0 +1,29 @@
+package opencl.executor;
+
+/**
+ * Controls how often a kernel is run by Executor.benchmarkStatistics.
+ */
+public class BenchmarkOptions {
+    /** Runs performed before measuring, e.g. to warm up caches and clocks */
+    public int warmupIterations = 3;
+    /** Measured runs performed before checking for convergence */
+    public int minIterations = 10;
+    /** Upper bound of measured runs, even if the results did not converge */
+    public int maxIterations = 1000;
+    /**
+     * Stop once the half width of the confidence interval of the mean is at most this fraction
+     * of the mean
+     */
+    public double targetRelativeError = 0.01;
+    /** Confidence level of the interval */
+    public double confidenceLevel = 0.95;
+    /**
+     * Runs with a modified z-score (based on the median absolute deviation) above this threshold
+     * are rejected as outliers; 0 disables the rejection
+     */
+    public double outlierThreshold = 3.5;
+    /** A single run taking at least this many milliseconds stops the benchmark; 0 disables it */
+    public double timeOut = 0.0;
+    /** Sets the outputs to zero on the device before every run */
+    public boolean clearOutputs = true;
+}
@@ -0,0 +1,53 @@
+package opencl.executor;
+
+/**
+ * Summary statistics of the runtimes of a benchmark in milliseconds. Everything but runtimes and
+ * outliers is computed over the runs which have not been rejected as outliers.
+ */
+public class BenchmarkStatistics {
+    /** All measured runtimes in the order of execution, including outliers */
+    public final double[] runtimes;
+    /** Number of runs rejected as outliers */
+    public final int outliers;
+    public final double mean;
+    public final double median;
+    /** 5th percentile */
+    public final double p5;
+    /** 95th percentile */
+    public final double p95;
+    public final double stdDev;
+    /** Lower bound of the confidence interval of the mean */
+    public final double ciLow;
+    /** Upper bound of the confidence interval of the mean */
+    public final double ciHigh;
+    /** Whether the confidence interval became as narrow as requested */
+    public final boolean converged;
+
+    BenchmarkStatistics(double[] runtimes, int outliers, double mean, double median,
+                        double p5, double p95, double stdDev, double ciLow, double ciHigh,
+                        boolean converged) {
+        this.runtimes = runtimes;
+        this.outliers = outliers;
+        this.mean = mean;
+        this.median = median;
+        this.p5 = p5;
+        this.p95 = p95;
+        this.stdDev = stdDev;
+        this.ciLow = ciLow;
+        this.ciHigh = ciHigh;
+        this.converged = converged;
+    }
+
+    @Override
+    public String toString() {
+        return "BenchmarkStatistics(runs: " + runtimes.length +
+                ", outliers: " + outliers +
+                ", mean: " + mean +
+                ", median: " + median +
+                ", p5: " + p5 +
+                ", p95: " + p95 +
+                ", stdDev: " + stdDev +
+                ", ci: [" + ciLow + ", " + ciHigh + "]" +
+                ", converged: " + converged + ")";
+    }
+}
@@ -0,0 +1,30 @@
+package opencl.executor;
+
+/**
+ * Snapshot of the statistics of the pool recycling device buffers of a device.
+ */
+public class BufferPoolStatistics {
+    /** Bytes of all device buffers allocated through the pool which are still alive */
+    public final long bytesReserved;
+    /** Bytes requested by the device buffers which are currently in use */
+    public final long bytesInUse;
+    /** Fraction of buffer requests served by reusing a previously released buffer */
+    public final double hitRate;
+    /** Fraction of the capacity of buffers in use which is wasted by rounding to size classes */
+    public final double fragmentation;
+
+    BufferPoolStatistics(long bytesReserved, long bytesInUse, double hitRate, double fragmentation) {
+        this.bytesReserved = bytesReserved;
+        this.bytesInUse = bytesInUse;
+        this.hitRate = hitRate;
+        this.fragmentation = fragmentation;
+    }
+
+    @Override
+    public String toString() {
+        return "BufferPoolStatistics(bytesReserved: " + bytesReserved +
+                ", bytesInUse: " + bytesInUse +
+                ", hitRate: " + hitRate +
+                ", fragmentation: " + fragmentation + ")";
+    }
+}
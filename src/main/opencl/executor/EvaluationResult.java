@@ -0,0 +1,53 @@
+package opencl.executor;
+
+/**
+ * The outcome of evaluating a candidate kernel with an early abort (see
+ * Executor.evaluateWithEarlyAbort). All times are in milliseconds.
+ */
+public class EvaluationResult {
+
+    public enum Status {
+        /** All runs were performed */
+        COMPLETED,
+        /** The estimate exceeded the timeout or the best runtime, no full run was performed */
+        ABORTED,
+        /** A full run exceeded the timeout */
+        TIMED_OUT,
+        /** The local size is too large for the kernel */
+        INVALID_WORK_GROUP_SIZE
+    }
+
+    public final Status status;
+    /**
+     * The median of all runs if completed, the runtime of the run exceeding the timeout, or the
+     * estimate if aborted
+     */
+    public final double runtime;
+    /**
+     * The full runtime extrapolated from the probe on a reduced NDRange, 0 if the sizes are not
+     * injected and there is no probe
+     */
+    public final double estimate;
+    /** The fraction of all work-groups run by the probe, 0 without a probe */
+    public final double probeFraction;
+    /** Private memory used by the kernel in bytes */
+    public final long privateMemory;
+    /** All full runs in order */
+    public final double[] runtimes;
+
+    EvaluationResult(int status, double runtime, double estimate, double probeFraction,
+                     long privateMemory, double[] runtimes) {
+        this.status = Status.values()[status];
+        this.runtime = runtime;
+        this.estimate = estimate;
+        this.probeFraction = probeFraction;
+        this.privateMemory = privateMemory;
+        this.runtimes = runtimes;
+    }
+
+    @Override
+    public String toString() {
+        return "EvaluationResult(" + status + ", runtime: " + runtime + ", estimate: " + estimate +
+                ", probe fraction: " + probeFraction + ", private memory: " + privateMemory + ")";
+    }
+}
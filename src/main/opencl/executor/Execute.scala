@@ -113,6 +113,25 @@ object Execute {
       (cleanedSizes ++ cleanedCaps).mapValues(Cst(_))
     }
 
+    /**
+     * Creates the map given a lambda with a single parameter and the type of
+     * the value it is applied to, e.g. the output type of a previously
+     * executed lambda. All lengths in this type have to be known.
+     */
+    def fromType(f: Lambda, argT: Type): immutable.Map[ArithExpr, Cst] = {
+      if (f.params.length != 1)
+        throw new IllegalArgumentException(
+          s"""| Wrong number of arguments.
+              | Expected: ${f.params.length}. Got: 1"""
+            .stripMargin
+        )
+
+      val (caps, sizes) = fetchTypeConstraints(f.params.head.t, argT, (Set.empty, Set.empty))
+      val cleanedSizes = cleanSizeConstraints(simplify(sizes))
+      val cleanedCaps = cleanCapacityConstraints(simplify(caps), cleanedSizes)
+      (cleanedSizes ++ cleanedCaps).mapValues(Cst(_))
+    }
+
     // -------------------------------
     // Below: private helper functions
     // -------------------------------
@@ -232,6 +251,32 @@ object Execute {
       }
     }
 
+    /**
+     * Same as fetchConstraints but the lengths are taken from the type of the
+     * argument instead of from its value
+     */
+    private def fetchTypeConstraints(ty: Type, argT: Type, constraints: (Set[Constraint], Set[Constraint]))
+                                    : (Set[Constraint], Set[Constraint]) = {
+      (ty, argT) match {
+        case (at: ArrayType, argAt: ArrayType) =>
+          val len = argAt match {
+            case s: Size if s.size.isEvaluable => s.size.eval
+            case c: Capacity if c.capacity.isEvaluable => c.capacity.eval
+            case _ => throw new IllegalKernelArgument(s"Array of known length expected, got: $argT")
+          }
+
+          val (caps, sizes) = fetchTypeConstraints(at.elemT, argAt.elemT, constraints)
+          (
+            collectCapacityConstraints(at, len, caps),
+            collectSizeConstraints(at, len, sizes)
+          )
+        case _ =>
+          if (ty != argT)
+            throw TypeException(s"Expected value of type $ty, but value of type $argT given")
+          constraints
+      }
+    }
+
     /**
      * Type-checks a bit of kernel argument.
      * Arrays are handled in fetchConstraints since more work is required for them.
@@ -326,6 +371,58 @@ object Execute {
     })
   }
 
+  /**
+   * A kernel of a pipeline: the code compiled for f and the sizes it is launched with
+   */
+  case class PipelineStage(code: String, f: Lambda, localSize: NDRange, globalSize: NDRange)
+
+  /**
+   * Executes the stages one after another on the same device. The first stage is applied to the
+   * given values, every following stage to the output of the previous one. Intermediate results
+   * stay on the device; only the output of the last stage is copied back and decoded.
+   *
+   * Returns a pair consisting of the output of the last stage as its first and the runtime of
+   * every stage as its second component
+   */
+  def pipeline[T](stages: Seq[PipelineStage], values: Any*)
+                 (implicit decodeType: DecodeType[T]): (T, Array[Double]) = {
+    if (stages.isEmpty)
+      throw new IllegalArgumentException("A pipeline needs at least one stage")
+
+    def executeFor(stage: PipelineStage) = new Execute(
+      stage.localSize(0), stage.localSize(1), stage.localSize(2),
+      stage.globalSize(0), stage.globalSize(1), stage.globalSize(2),
+      injectLocalSize = false)
+
+    // bind the output of every stage as input of the next one
+    val launches = stages.tail.scanLeft(executeFor(stages.head).prepare(stages.head.f, values: _*))(
+      (previous, stage) => executeFor(stage).prepareChained(stage.f, previous.output, previous.outT))
+
+    val kernels = stages.map(stage => Build(stage.code)).toArray
+    val runtimes = try {
+      val sizes = launches.flatMap(l => Seq(
+        l.localSize(0), l.localSize(1), l.localSize(2),
+        l.globalSize(0), l.globalSize(1), l.globalSize(2)).map(_.eval)).toArray
+      Executor.executePipeline(kernels, sizes, launches.map(_.args.toArray).toArray)
+    } finally {
+      kernels.foreach(_.dispose())
+    }
+
+    val output = Decoder(launches.last.outT, launches.last.output)(decodeType)
+
+    // intermediate outputs are arguments of two stages, release them only once
+    launches.flatMap(_.args).distinct.foreach(_.dispose)
+
+    (output, runtimes)
+  }
+
+  /**
+   * Everything needed to launch a kernel compiled for a lambda: the validated sizes, the output
+   * argument and its type and all kernel arguments in the order expected by the kernel
+   */
+  private[executor] case class Launch(localSize: NDRange, globalSize: NDRange,
+                                      output: GlobalArg, outT: Type, args: Seq[KernelArg])
+
   /**
    * Helper function to run sanity checks on the global and local size.
    * @param globalSize Global range
@@ -547,8 +644,9 @@ class Execute(val localSize1: ArithExpr, val localSize2: ArithExpr, val localSiz
          globalSize1, globalSize2, globalSize3, args) => {
         val kernel = Build(code)
         try {
-          Executor.benchmark(kernel, localSize1, localSize2, localSize3,
-            globalSize1, globalSize2, globalSize3, args, iterations, timeout)
+          // the outputs are cleared before every iteration, everything else is set up only once
+          Executor.benchmarkResident(kernel, localSize1, localSize2, localSize3,
+            globalSize1, globalSize2, globalSize3, args, iterations, timeout, true)
         } finally {
           kernel.dispose()
         }
@@ -655,6 +753,28 @@ class Execute(val localSize1: ArithExpr, val localSize2: ArithExpr, val localSiz
   private def execute[T, Time](executeFunction: (Int, Int, Int, Int, Int, Int, Array[KernelArg]) => Time,
                                f: Lambda, values: Any*)
                               (implicit decodeType: DecodeType[T]): (T, Time) = {
+    val launch = prepare(f, values: _*)
+    val (localSize, globalSize) = (launch.localSize, launch.globalSize)
+
+    // 8. execute via JNI and get the runtime (or runtimes); the executor is
+    //    thread-safe, so several threads can execute kernels concurrently
+    val t = executeFunction(localSize(0).eval, localSize(1).eval, localSize(2).eval,
+      globalSize(0).eval, globalSize(1).eval, globalSize(2).eval, launch.args.toArray)
+
+    // 9. cast the output accordingly to the output type
+    val output = Decoder(launch.outT, launch.output)(decodeType)
+
+    // 10. release OpenCL objects
+    launch.args.foreach(_.dispose)
+
+    // 11. return output data and runtime as a tuple
+    (output, t)
+  }
+
+  /**
+   * Creates the kernel arguments for applying f to the given values
+   */
+  private[executor] def prepare(f: Lambda, values: Any*): Execute.Launch = {
     // 1. If some inputs could not been allocated so far because of some
     //    unknown capacity in their type, we have a last chance to do it now
     //    because we have their values.
@@ -669,6 +789,25 @@ class Execute(val localSize1: ArithExpr, val localSize2: ArithExpr, val localSiz
     //    Also type-checks the inputs.
     val valueMap = createValueMap(f, values: _*)
 
+    createArgs(f, valueMap, (i, ty, size) => arg(values(i), ty, size))
+  }
+
+  /**
+   * Creates the kernel arguments for applying f to the output of a previously executed kernel,
+   * which is still on the device and has the given type
+   */
+  private[executor] def prepareChained(f: Lambda, input: GlobalArg, inputT: Type): Execute.Launch = {
+    val valueMap = createValueMap.fromType(f, inputT)
+
+    val p = f.params.head
+    if (p.mem.size == ?)
+      p.mem = OpenCLMemory(p.mem.variable, Type.getMaxAllocatedSize(inputT), GlobalMemory)
+
+    createArgs(f, valueMap, (_, _, _) => input)
+  }
+
+  private def createArgs(f: Lambda, valueMap: immutable.Map[ArithExpr, Cst],
+                         paramArg: (Int, Type, Long) => KernelArg): Execute.Launch = {
     val (localSize, globalSize) = getAndValidateSizesForExecution(f, valueMap)
 
     // 3. make sure the device has enough memory to execute the kernel
@@ -679,7 +818,7 @@ class Execute(val localSize1: ArithExpr, val localSize2: ArithExpr, val localSiz
     val outputData = global(outputSize)
 
     // 5. create all OpenCL data kernel arguments
-    val memArgs = createMemArgs(f, outputData, valueMap, values:_*)
+    val memArgs = createMemArgs(f, outputData, valueMap, paramArg)
 
     // 6. create OpenCL arguments reflecting the size information for the data arguments
     val sizes = createSizeArgs(f, valueMap)
@@ -687,27 +826,14 @@ class Execute(val localSize1: ArithExpr, val localSize2: ArithExpr, val localSiz
     // 7. combine kernel arguments. first pointers and data, then the size information
     val args: Seq[KernelArg] = memArgs ++ sizes
 
-    // 8. execute via JNI and get the runtime (or runtimes)
-    val t = this.synchronized {
-      executeFunction(localSize(0).eval, localSize(1).eval, localSize(2).eval,
-        globalSize(0).eval, globalSize(1).eval, globalSize(2).eval, args.toArray)
-    }
-
-    // 9. cast the output accordingly to the output type
     val outT = Type.substitute(f.body.t, valueMap)
-    val output = Decoder(outT, outputData)(decodeType)
-
-    // 10. release OpenCL objects
-    args.foreach(_.dispose)
-
-    // 11. return output data and runtime as a tuple
-    (output, t)
+    Execute.Launch(localSize, globalSize, outputData, outT, args)
   }
 
   private def createMemArgs(f: Lambda,
                             outputData: KernelArg,
                             valueMap: immutable.Map[ArithExpr, ArithExpr],
-                            values: Any*): Seq[KernelArg] = {
+                            paramArg: (Int, Type, Long) => KernelArg): Seq[KernelArg] = {
     // go through all memory objects associated with the generated kernel
     OpenCLGenerator.getMemories(f)._2.map(mem => {
       // get the OpenCL memory object ...
@@ -716,7 +842,7 @@ class Execute(val localSize1: ArithExpr, val localSize2: ArithExpr, val localSiz
       // ... look for it in the parameter list ...
       val i = f.params.indexWhere(m == _.mem)
       // ... if found create an OpenCL kernel argument from the matching runtime value ...
-      if (i != -1) arg(values(i), Type.substitute(mem.t, valueMap), size)
+      if (i != -1) paramArg(i, Type.substitute(mem.t, valueMap), size)
       // ... if not found but it is the output set this ...
       else if (m == f.body.mem) outputData
       // ... else create a fresh local or global object argument
@@ -0,0 +1,113 @@
+package opencl.executor;
+
+/**
+ * The breakdown of a single execution (see Executor.executeProfiled). All times are in
+ * milliseconds, timestamps of commands are in nanoseconds of the device clock.
+ */
+public class ExecutionProfile {
+
+    public enum Kind { UPLOAD, KERNEL, DOWNLOAD }
+
+    public static class Command {
+        public final Kind kind;
+        /** Bytes transferred, 0 for kernels */
+        public final long bytes;
+        public final long queued;
+        public final long submit;
+        public final long start;
+        public final long end;
+        /**
+         * Time the device was idle between the end of the previous command and the start of this
+         * one; negative if they overlapped
+         */
+        public final double gapBefore;
+
+        Command(int kind, long bytes, long queued, long submit, long start, long end,
+                double gapBefore) {
+            this.kind = Kind.values()[kind];
+            this.bytes = bytes;
+            this.queued = queued;
+            this.submit = submit;
+            this.start = start;
+            this.end = end;
+            this.gapBefore = gapBefore;
+        }
+
+        public double runtime() {
+            return (end - start) * 1.0e-6;
+        }
+
+        /** Time from enqueueing the command on the host until it started on the device */
+        public double latency() {
+            return (start - queued) * 1.0e-6;
+        }
+
+        @Override
+        public String toString() {
+            return kind + "(" + runtime() + " ms, " + bytes + " bytes, latency: " + latency() +
+                    " ms, gap before: " + gapBefore + " ms)";
+        }
+    }
+
+    /** Host time spent building (or looking up) the kernel */
+    public final double buildTime;
+    /** Host time of the whole execution */
+    public final double hostTime;
+    /** All commands ordered by their start on the device */
+    public final Command[] commands;
+
+    ExecutionProfile(double buildTime, double hostTime, Command[] commands) {
+        this.buildTime = buildTime;
+        this.hostTime = hostTime;
+        this.commands = commands;
+    }
+
+    public double kernelTime() {
+        return time(Kind.KERNEL);
+    }
+
+    public double uploadTime() {
+        return time(Kind.UPLOAD);
+    }
+
+    public double downloadTime() {
+        return time(Kind.DOWNLOAD);
+    }
+
+    /** Sum of the positive gaps in between the commands, i.e. the time the device waited for the host */
+    public double idleTime() {
+        double idle = 0.0;
+        for (Command c : commands) idle += Math.max(0.0, c.gapBefore);
+        return idle;
+    }
+
+    /**
+     * Whether the execution spent most of its time in the kernel ("compute"), in transfers
+     * ("transfer") or in building and launching ("launch")
+     */
+    public String bound() {
+        double compute = kernelTime();
+        double transfer = uploadTime() + downloadTime();
+        double launch = hostTime - compute - transfer;
+        if (compute >= transfer && compute >= launch) return "compute";
+        if (transfer >= launch) return "transfer";
+        return "launch";
+    }
+
+    private double time(Kind kind) {
+        double time = 0.0;
+        for (Command c : commands) if (c.kind == kind) time += c.runtime();
+        return time;
+    }
+
+    @Override
+    public String toString() {
+        return "ExecutionProfile(build: " + buildTime +
+                ", host: " + hostTime +
+                ", kernel: " + kernelTime() +
+                ", upload: " + uploadTime() +
+                ", download: " + downloadTime() +
+                ", idle: " + idleTime() +
+                ", bound: " + bound() + ")";
+    }
+}
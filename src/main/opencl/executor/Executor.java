@@ -3,7 +3,9 @@ package opencl.executor;
 import utils.NativeUtils;
 
 import java.io.IOException;
+import java.util.Map;
 import java.util.Objects;
+import java.util.concurrent.CompletableFuture;
 
 public class Executor {
 
@@ -31,6 +33,21 @@ public class Executor {
         }
     }
 
+    /**
+     * Thrown if a kernel executed with executeInWorker exceeded its deadline. The worker running it
+     * has already been killed, so the executor of this process does not have to be restarted.
+     */
+    public static class WorkerTimeoutException extends ExecutorFailureException {
+        public WorkerTimeoutException(String message) {
+            super(message);
+        }
+
+        @Override
+        public void consume() {
+            System.err.println("Kernel timed out, its worker has been replaced");
+        }
+    }
+
     public static double initAndExecute(Kernel kernel,
                                         int localSize1, int localSize2, int localSize3,
                                         int globalSize1, int globalSize2, int globalSize3,
@@ -80,6 +97,52 @@ public class Executor {
                                         int globalSize1, int globalSize2, int globalSize3,
                                         KernelArg[] args);
 
+    /**
+     * Executes the given kernel like execute and returns the profiling information of the build, of
+     * every upload and download and of the kernel. Outputs are downloaded before returning, so the
+     * profile covers the whole round trip.
+     */
+    public native static ExecutionProfile executeProfiled(Kernel kernel,
+                                                          int localSize1, int localSize2, int localSize3,
+                                                          int globalSize1, int globalSize2, int globalSize3,
+                                                          KernelArg[] args);
+
+    /**
+     * Executes the given kernel in a separate executor-worker process (see startWorkers), so that a
+     * kernel which hangs or crashes the driver can not take down the JVM. If the worker does not
+     * answer within deadline milliseconds (0 disables the deadline) it is killed and a
+     * WorkerTimeoutException is thrown. On success the outputs are copied back into the arguments.
+     */
+    public native static double executeInWorker(Kernel kernel,
+                                                int localSize1, int localSize2, int localSize3,
+                                                int globalSize1, int globalSize2, int globalSize3,
+                                                KernelArg[] args, double deadline);
+
+    /**
+     * Enqueues the execution of the given kernel and returns without waiting for the device.
+     * The returned future completes with the kernel runtime in milliseconds once the kernel
+     * has finished (or exceptionally with an ExecutorFailureException), so that the next
+     * kernel can be prepared while the device is busy.
+     * The arguments must not be disposed or used by another execution before the future has
+     * completed. Dependent actions are run asynchronously, never on a thread of the OpenCL
+     * implementation.
+     */
+    public static CompletableFuture<Double> executeAsync(Kernel kernel,
+                                                         int localSize1, int localSize2, int localSize3,
+                                                         int globalSize1, int globalSize2, int globalSize3,
+                                                         KernelArg[] args)
+    {
+        CompletableFuture<Double> completion = new CompletableFuture<>();
+        enqueueAsync(kernel, localSize1, localSize2, localSize3,
+                globalSize1, globalSize2, globalSize3, args, completion);
+        return completion.thenApplyAsync(runtime -> runtime);
+    }
+
+    private native static void enqueueAsync(Kernel kernel,
+                                            int localSize1, int localSize2, int localSize3,
+                                            int globalSize1, int globalSize2, int globalSize3,
+                                            KernelArg[] args, CompletableFuture<Double> completion);
+
     /**
      * Executes the given kernel with the given runtime configuration and arguments iterations many
      * times. Returns the runtime of all runs in the order they were executed.
@@ -109,11 +172,111 @@ public class Executor {
                                             int globalSize1, int globalSize2, int globalSize3,
                                             KernelArg[] args, int iterations, double timeOut);
 
+    /**
+     * Executes the given kernels one after another on the same device. Arguments shared between
+     * kernels, e.g. the output of one kernel passed as input to the next, stay on the device and
+     * are not copied back to the host in between.
+     *
+     * @param kernels The kernels to execute in order
+     * @param sizes The three local sizes followed by the three global sizes of every kernel
+     * @param args The arguments of every kernel
+     * @return The runtime of every kernel in milliseconds, measured using the OpenCL timing API
+     */
+    public native static double[] executePipeline(Kernel[] kernels, int[] sizes, KernelArg[][] args);
+
+    /**
+     * Same as benchmark, but the kernel is built and the arguments are uploaded and bound only
+     * once; every iteration only enqueues the kernel again, so that the measured runtimes are not
+     * affected by host side work between the iterations.
+     *
+     * @param clearOutputs If set, the outputs are set to zero on the device before every
+     *                     iteration as done by benchmark. Otherwise every iteration runs on the
+     *                     outputs of the previous one.
+     */
+    public native static double[] benchmarkResident(Kernel kernel,
+                                                    int localSize1, int localSize2, int localSize3,
+                                                    int globalSize1, int globalSize2, int globalSize3,
+                                                    KernelArg[] args, int iterations, double timeOut,
+                                                    boolean clearOutputs);
+
+    /**
+     * Runs the given kernel until the confidence interval of its mean runtime is as narrow as
+     * requested by the options, rejecting outliers, and returns summary statistics of the
+     * runtimes. The kernel is built and the arguments are bound only once, as done by
+     * benchmarkResident.
+     */
+    public static BenchmarkStatistics benchmarkStatistics(Kernel kernel,
+                                                          int localSize1, int localSize2, int localSize3,
+                                                          int globalSize1, int globalSize2, int globalSize3,
+                                                          KernelArg[] args, BenchmarkOptions options)
+    {
+        return benchmarkStatistics(kernel, localSize1, localSize2, localSize3,
+                globalSize1, globalSize2, globalSize3, args,
+                options.warmupIterations, options.minIterations, options.maxIterations,
+                options.targetRelativeError, options.confidenceLevel, options.outlierThreshold,
+                options.timeOut, options.clearOutputs);
+    }
+
+    private native static BenchmarkStatistics benchmarkStatistics(Kernel kernel,
+                                                                  int localSize1, int localSize2, int localSize3,
+                                                                  int globalSize1, int globalSize2, int globalSize3,
+                                                                  KernelArg[] args,
+                                                                  int warmupIterations, int minIterations,
+                                                                  int maxIterations, double targetRelativeError,
+                                                                  double confidenceLevel, double outlierThreshold,
+                                                                  double timeOut, boolean clearOutputs);
+
+    /**
+     * Computes the summary statistics reported by benchmarkStatistics for the given runtimes,
+     * e.g. for runtimes measured elsewhere. converged is always false.
+     *
+     * @param confidenceLevel Confidence level of the interval of the mean, between 0 and 1
+     * @param outlierThreshold Runs with a modified z-score above it are rejected as outliers;
+     *                         0 disables the rejection
+     */
+    public native static BenchmarkStatistics summarize(double[] runtimes, double confidenceLevel,
+                                                       double outlierThreshold);
+
     public native static double evaluate(Kernel kernel,
                                          int localSize1, int localSize2, int localSize3,
                                          int globalSize1, int globalSize2, int globalSize3,
                                          KernelArg[] args, int iterations, double timeOut);
 
+    /**
+     * Evaluates a candidate kernel, rejecting bad candidates early. If the sizes are injected the
+     * kernel is first timed on a slab of its work-groups and its full runtime is extrapolated
+     * from that; if the estimate exceeds timeOut or, if positive, bestRuntime by more than 50% no
+     * full run is performed. Otherwise there is no probe, as the work of the kernel may depend on
+     * the NDRange. Then the kernel is run iterations times, stopping after a run exceeding timeOut.
+     *
+     * @param bestRuntime The best runtime of the candidates evaluated so far, or 0
+     * @param sizesInjected Whether the kernel has been generated with the local and global sizes
+     *                      injected, so that its work does not depend on the launched NDRange
+     */
+    public native static EvaluationResult evaluateWithEarlyAbort(Kernel kernel,
+                                                                 int localSize1, int localSize2, int localSize3,
+                                                                 int globalSize1, int globalSize2, int globalSize3,
+                                                                 KernelArg[] args, int iterations,
+                                                                 double timeOut, double bestRuntime,
+                                                                 boolean sizesInjected);
+
+    /**
+     * Evaluates many candidate kernels on the same arguments in a single call. The arguments are
+     * uploaded once; the candidates are built on background threads while previously built ones
+     * are launched back-to-back.
+     *
+     * @param kernels The candidates to evaluate, in order
+     * @param ndRanges The three local sizes followed by the three global sizes of every candidate
+     * @param sharedArgs Kernel arguments used by all candidates
+     * @param iterations The number of runs of every candidate
+     * @param timeOut If a run of a candidate takes longer, no further runs of it are performed
+     * @return For every candidate the median runtime in milliseconds, the runtime of the run
+     *         exceeding the timeout, or -1 if the candidate could not be built or launched
+     */
+    public native static double[] evaluateBatch(Kernel[] kernels, int[] ndRanges,
+                                                KernelArg[] sharedArgs, int iterations,
+                                                double timeOut);
+
  
 
     public native static void init(int platformId, int deviceId);
@@ -136,6 +299,232 @@ public class Executor {
 
     public native static boolean isLittleEndian();
 
+    /**
+     * Enables the on-disk cache of compiled OpenCL program binaries. Programs built from the same
+     * source with the same build options for the same device and driver are loaded from the cache
+     * instead of being compiled again, including across JVM restarts.
+     *
+     * @param directory The directory to store the binaries in. It is created if necessary and can
+     *                  be shared between concurrently running processes.
+     * @param maxSizeInBytes The maximal total size of the cache. The least recently used binaries
+     *                       are evicted when the limit is exceeded. 0 disables the limit.
+     * @throws IllegalArgumentException if maxSizeInBytes is negative
+     */
+    public native static void enableBinaryCache(String directory, long maxSizeInBytes);
+
+    public native static void disableBinaryCache();
+
+    /** Number of programs built from a cached binary */
+    public native static long getBinaryCacheHits();
+
+    /** Number of programs built from source while the binary cache was enabled */
+    public native static long getBinaryCacheMisses();
+
+    /** Total time in milliseconds spent building programs from cached binaries */
+    public native static double getBinaryCacheHitBuildTime();
+
+    /** Total time in milliseconds spent building programs from source while the cache was enabled */
+    public native static double getBinaryCacheMissBuildTime();
+
+    /**
+     * Sets the maximal number of built programs kept in memory and shared between all kernels
+     * created from the same source and build options. The least recently used programs are
+     * released first. 0 disables the in-memory program cache. Throws an IllegalArgumentException
+     * if maxPrograms is negative.
+     */
+    public native static void setProgramCacheCapacity(int maxPrograms);
+
+    /**
+     * Sets the number of threads building kernels in the background (see Kernel.buildAsync).
+     * Uses one thread per hardware thread if numThreads is 0. Throws an IllegalArgumentException if
+     * numThreads is negative.
+     */
+    public native static void setCompileThreads(int numThreads);
+
+    /**
+     * Lets executeInWorker use up to numWorkers processes of the executor-worker executable at
+     * workerPath (built and installed next to the executor library). Workers are started on
+     * demand and use the given platform and device. Throws an IllegalArgumentException if
+     * numWorkers is negative and an ExecutorFailureException on Windows, where worker processes
+     * are not supported.
+     */
+    public native static void startWorkers(String workerPath, int numWorkers,
+                                           int platformId, int deviceId);
+
+    /** Terminates all idle worker processes */
+    public native static void stopWorkers();
+
+    /**
+     * Starts recording a timeline of compilations, buffer creations, transfers, kernels and JNI
+     * calls, keeping at most eventsPerThread events per thread. Setting the environment variable
+     * LIFT_EXECUTOR_TRACE to a path enables tracing from the start and writes the trace there at
+     * shutdown. Throws an IllegalArgumentException if eventsPerThread is negative.
+     */
+    public native static void enableTracing(int eventsPerThread);
+
+    public native static void disableTracing();
+
+    /**
+     * Writes the recorded timeline as Chrome trace-event JSON (viewable in chrome://tracing or
+     * Perfetto) to path. Returns false if the file could not be written.
+     */
+    public native static boolean dumpTrace(String path);
+
+    /**
+     * Starts recording the metrics which need an OpenCL callback per command, i.e. the transfer
+     * latencies transfer.upload.latency_us and transfer.download.latency_us, measured from
+     * enqueueing the first until the end of the last command of a transfer. All other metrics
+     * are always recorded.
+     */
+    public native static void enableMetrics();
+
+    public native static void disableMetrics();
+
+    /**
+     * Returns the current value of every executor metric: counters (e.g. kernel.launches,
+     * transfer.upload.bytes), histograms reported as name.count, .mean, .p50, .p90, .p99 and .max
+     * (latencies in microseconds) and the statistics of the program, binary and buffer caches.
+     */
+    public native static Map<String, Double> getMetrics();
+
+    /**
+     * Appends the metrics as a JSON line to the file at path every intervalInSeconds seconds,
+     * until stopMetricsDump or shutdown is called. Enables the metrics (see enableMetrics).
+     * Throws an IllegalArgumentException if intervalInSeconds is not positive.
+     */
+    public native static void startMetricsDump(String path, double intervalInSeconds);
+
+    public native static void stopMetricsDump();
+
+    /** Releases all programs held by the in-memory program cache */
+    public native static void purgeProgramCache();
+
+    public native static long getProgramCacheHits();
+
+    public native static long getProgramCacheMisses();
+
+    /**
+     * Sets the maximal number of bytes of idle device buffers kept for reuse by the buffer pool of
+     * every device. Buffers released beyond this limit are freed. Throws an
+     * IllegalArgumentException if bytes is negative.
+     */
+    public native static void setBufferPoolHighWaterMark(long bytes);
+
+    /** Returns the statistics of the buffer pool of the device in use */
+    public native static BufferPoolStatistics getBufferPoolStatistics();
+
+    /**
+     * Stages all following uploads and downloads of at least chunkSize bytes through a ring of
+     * pinned host buffers. The host copy of one chunk overlaps with the DMA transfer of the
+     * previous chunk, which avoids the bounce buffer most drivers use for pageable memory.
+     *
+     * @param chunkSize The size of a single pinned chunk in bytes
+     * @param numChunks The number of pinned chunks in the ring (at least 2 to overlap copies)
+     * @throws IllegalArgumentException if chunkSize or numChunks is not positive
+     */
+    public native static void enableStagedTransfers(long chunkSize, int numChunks);
+
+    /** Transfer directly from and to pageable host memory again */
+    public native static void disableStagedTransfers();
+
+    /** Throughput of the most recent upload in GB/s, measured with OpenCL profiling events */
+    public native static double getLastUploadThroughput();
+
+    /** Throughput of the most recent download in GB/s, measured with OpenCL profiling events */
+    public native static double getLastDownloadThroughput();
+
+    /**
+     * Initializes the executor with several devices given as a comma separated list of
+     * platform:device pairs, e.g. "0:0,1:0". Devices are then selected by their index in
+     * this list.
+     */
+    public static void initDevices(String devices) {
+        String[] pairs = devices.split(",");
+        int[] platformIds = new int[pairs.length];
+        int[] deviceIds = new int[pairs.length];
+        for (int i = 0; i < pairs.length; i++) {
+            String[] ids = pairs[i].trim().split(":");
+            if (ids.length != 2)
+                throw new IllegalArgumentException("Invalid device specification: " + pairs[i]);
+            platformIds[i] = Integer.parseInt(ids[0].trim());
+            deviceIds[i] = Integer.parseInt(ids[1].trim());
+        }
+        initDevices(platformIds, deviceIds);
+    }
+
+    public native static void initDevices(int[] platformIds, int[] deviceIds);
+
+    /**
+     * Selects the device used by all following calls of the calling thread, including the
+     * getters for device properties. Different threads can use different devices at the
+     * same time.
+     */
+    public native static void selectDevice(int index);
+
+    public native static int getSelectedDevice();
+
+    public native static int getDeviceCount();
+
+    public static double execute(int device, Kernel kernel,
+                                 int localSize1, int localSize2, int localSize3,
+                                 int globalSize1, int globalSize2, int globalSize3,
+                                 KernelArg[] args)
+    {
+        int previous = getSelectedDevice();
+        selectDevice(device);
+        try {
+            return execute(kernel, localSize1, localSize2, localSize3,
+                    globalSize1, globalSize2, globalSize3, args);
+        } finally {
+            selectDevice(previous);
+        }
+    }
+
+    public static CompletableFuture<Double> executeAsync(int device, Kernel kernel,
+                                                         int localSize1, int localSize2, int localSize3,
+                                                         int globalSize1, int globalSize2, int globalSize3,
+                                                         KernelArg[] args)
+    {
+        int previous = getSelectedDevice();
+        selectDevice(device);
+        try {
+            return executeAsync(kernel, localSize1, localSize2, localSize3,
+                    globalSize1, globalSize2, globalSize3, args);
+        } finally {
+            selectDevice(previous);
+        }
+    }
+
+    public static double[] benchmark(int device, Kernel kernel,
+                                     int localSize1, int localSize2, int localSize3,
+                                     int globalSize1, int globalSize2, int globalSize3,
+                                     KernelArg[] args, int iterations, double timeOut)
+    {
+        int previous = getSelectedDevice();
+        selectDevice(device);
+        try {
+            return benchmark(kernel, localSize1, localSize2, localSize3,
+                    globalSize1, globalSize2, globalSize3, args, iterations, timeOut);
+        } finally {
+            selectDevice(previous);
+        }
+    }
+
+    public static double evaluate(int device, Kernel kernel,
+                                  int localSize1, int localSize2, int localSize3,
+                                  int globalSize1, int globalSize2, int globalSize3,
+                                  KernelArg[] args, int iterations, double timeOut)
+    {
+        int previous = getSelectedDevice();
+        selectDevice(device);
+        try {
+            return evaluate(kernel, localSize1, localSize2, localSize3,
+                    globalSize1, globalSize2, globalSize3, args, iterations, timeOut);
+        } finally {
+            selectDevice(previous);
+        }
+    }
+
     public static void init() {
         String platform = System.getenv("LIFT_PLATFORM");
         String device = System.getenv("LIFT_DEVICE");
@@ -159,7 +548,28 @@ public class Executor {
             }
         }
 
-        init(platformId, deviceId);
+        String devices = System.getenv("LIFT_DEVICES");
+        if (devices != null) {
+            initDevices(devices);
+        } else {
+            init(platformId, deviceId);
+        }
+
+        String binaryCache = System.getenv("LIFT_BINARY_CACHE");
+        if (binaryCache != null) {
+            long maxSize = 1L << 30;
+            String binaryCacheSize = System.getenv("LIFT_BINARY_CACHE_SIZE");
+            if (binaryCacheSize != null) {
+                try {
+                    maxSize = Long.parseLong(binaryCacheSize);
+                    if (maxSize < 0) throw new NumberFormatException();
+                } catch (NumberFormatException e) {
+                    System.err.println("Invalid binary cache size specified, using default.");
+                    maxSize = 1L << 30;
+                }
+            }
+            enableBinaryCache(binaryCache, maxSize);
+        }
     }
 
     public native static void shutdown();
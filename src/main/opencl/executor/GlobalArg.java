@@ -1,5 +1,8 @@
 package opencl.executor;
 
+import java.io.IOException;
+import java.nio.ByteBuffer;
+
 public class GlobalArg extends KernelArg {
     public static native GlobalArg createInput(byte[] array);
     public static native GlobalArg createInput(float[] array);
@@ -9,12 +12,89 @@ public class GlobalArg extends KernelArg {
 
     public static native GlobalArg createOutput(long size);
 
+    /**
+     * Creates an input argument which is uploaded straight from the memory of
+     * the given direct buffer, without copying it into a Java array first.
+     * The buffer must not be modified until the argument is disposed.
+     * Throws an IllegalArgumentException if the buffer is not direct or empty.
+     */
+    public static GlobalArg createInput(ByteBuffer buffer) {
+        GlobalArg arg = createInputFromDirectBuffer(buffer);
+        arg.directBuffer = buffer;
+        return arg;
+    }
+
+    /**
+     * Creates an output argument which is downloaded straight into the
+     * memory of the given direct buffer, which also provides the initial
+     * contents of the output. Throws an IllegalArgumentException if the
+     * buffer is not direct or empty.
+     */
+    public static GlobalArg createOutput(ByteBuffer buffer) {
+        GlobalArg arg = createOutputFromDirectBuffer(buffer);
+        arg.directBuffer = buffer;
+        return arg;
+    }
+
+    /**
+     * Creates an input argument which is uploaded straight from a memory
+     * mapping of length bytes of the file at path, starting at offset, or of
+     * the rest of the file if length is 0. The file is never modified and
+     * its contents never pass through the Java heap.
+     */
+    public static native GlobalArg createInputFromFile(String path, long offset, long length)
+            throws IOException;
+
+    /**
+     * Creates an output argument of size bytes which is downloaded straight
+     * into a memory mapping of the file at path. The file is created or
+     * truncated; it holds the output once the download has finished, at the
+     * latest once the argument has been disposed.
+     */
+    public static native GlobalArg createOutputToFile(String path, long size)
+            throws IOException;
+
+    private static native GlobalArg createInputFromDirectBuffer(ByteBuffer buffer);
+    private static native GlobalArg createOutputFromDirectBuffer(ByteBuffer buffer);
+
+    // keeps the memory used by the native side alive
+    private ByteBuffer directBuffer;
+
     GlobalArg(long handle) {
         super(handle);
     }
 
+    /** Throws an IndexOutOfBoundsException if index is outside of the argument */
     public native float at(long index);
 
+    /**
+     * Reads length bytes starting at offset. If the output has not been
+     * transferred to the host yet, only the requested range is downloaded.
+     * Throws an IndexOutOfBoundsException if the range exceeds the argument.
+     */
+    public native byte[] readBytes(long offset, long length);
+
+    /**
+     * Reads count floats starting at element index. If the output has not been
+     * transferred to the host yet, only the requested range is downloaded.
+     * Throws an IndexOutOfBoundsException if the range exceeds the argument.
+     */
+    public native float[] readFloats(long index, long count);
+
+    /**
+     * Overwrites the bytes starting at offset with data. Only the written range is uploaded again
+     * before the next launch.
+     * Throws an IndexOutOfBoundsException if the range exceeds the argument.
+     */
+    public native void writeBytes(long offset, byte[] data);
+
+    /**
+     * Overwrites the floats starting at element index with data. Only the written range is
+     * uploaded again before the next launch.
+     * Throws an IndexOutOfBoundsException if the range exceeds the argument.
+     */
+    public native void writeFloats(long index, float[] data);
+
     public native float[] asFloatArray();
     public native int[] asIntArray();
     public native double[] asDoubleArray();
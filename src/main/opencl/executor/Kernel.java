@@ -8,4 +8,11 @@ public class Kernel extends JNIHandle {
     }
 
     public native void build();
+
+    /**
+     * Starts building the kernel in the background and returns right away. Executing the kernel
+     * afterwards only waits for this kernel to be built, so that many kernels can be built
+     * concurrently while the device executes others.
+     */
+    public native void buildAsync();
 }
@@ -4,7 +4,9 @@ import java.awt.image.BufferedImage
 import java.io.{File, IOException}
 import javax.imageio.ImageIO
 
+import ir.Type
 import ir.ast.Lambda
+import lift.arithmetic.{ArithExpr, Cst}
 import org.junit.Assume
 
 object LongTestsEnabled {
@@ -302,8 +304,25 @@ object Utils {
               localSize1: Int, localSize2: Int, localSize3: Int,
               globalSize1: Int,  globalSize2: Int, globalSize3: Int,
               injectSizes: (Boolean, Boolean)) : String= {
-    val valueMap = Execute.createValueMap(f, values:_*)
+    compile(f, Execute.createValueMap(f, values:_*),
+      localSize1, localSize2, localSize3,
+      globalSize1, globalSize2, globalSize3, injectSizes)
+  }
+
+  /** Compiles f for being applied to a value of type argT, e.g. the output of another kernel */
+  def compile(f: Lambda, argT: Type,
+              localSize1: Int, localSize2: Int, localSize3: Int,
+              globalSize1: Int,  globalSize2: Int, globalSize3: Int,
+              injectSizes: (Boolean, Boolean)) : String= {
+    compile(f, Execute.createValueMap.fromType(f, argT),
+      localSize1, localSize2, localSize3,
+      globalSize1, globalSize2, globalSize3, injectSizes)
+  }
 
+  private def compile(f: Lambda, valueMap: scala.collection.immutable.Map[ArithExpr, Cst],
+                      localSize1: Int, localSize2: Int, localSize3: Int,
+                      globalSize1: Int,  globalSize2: Int, globalSize3: Int,
+                      injectSizes: (Boolean, Boolean)) : String= {
     if (injectSizes._1)
       if (injectSizes._2)
         Compile(f, localSize1, localSize2, localSize3,
@@ -0,0 +1,59 @@
+/**
+ * Test cases for benchmarking a kernel whose arguments are uploaded and bound only once.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestBenchmarkResident extends TestWithExecutor
+
+class TestBenchmarkResident {
+
+  private val size = 4096
+
+  private val accumulateKernel =
+    """kernel void accumulate(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] += in[i];
+      |}""".stripMargin
+
+  // Benchmarks accumulateKernel and returns the runtimes and the output
+  private def benchmark(iterations: Int, timeOut: Double,
+                        clearOutputs: Boolean): (Array[Double], Array[Float]) = {
+    val kernel = Kernel.create(accumulateKernel, "accumulate", "")
+    val input = GlobalArg.createInput(Array.fill(size)(1.0f))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val runtimes = Executor.benchmarkResident(kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output), iterations, timeOut, clearOutputs)
+      (runtimes, output.asFloatArray())
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def iterationsRunOnThePreviousOutputs(): Unit = {
+    val (runtimes, output) = benchmark(4, 0.0, clearOutputs = false)
+    assertEquals(4, runtimes.length)
+    assertEquals(4.0f, output(0), 0.0f)
+    assertEquals(4.0f, output(size - 1), 0.0f)
+  }
+
+  @Test
+  def outputsCanBeClearedBeforeEveryIteration(): Unit = {
+    val (runtimes, output) = benchmark(4, 0.0, clearOutputs = true)
+    assertEquals(4, runtimes.length)
+    assertEquals(1.0f, output(0), 0.0f)
+  }
+
+  @Test
+  def runExceedingTheTimeoutStopsTheBenchmark(): Unit = {
+    val (runtimes, _) = benchmark(10, 1.0e-9, clearOutputs = false)
+    assertEquals(1, runtimes.length)
+  }
+}
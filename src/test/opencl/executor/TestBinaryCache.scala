@@ -0,0 +1,76 @@
+/**
+ * Test cases for the on-disk cache of program binaries.
+ */
+
+package opencl.executor
+
+import java.io.File
+import java.nio.file.Files
+
+import org.junit.Assert._
+import org.junit._
+
+object TestBinaryCache extends TestWithExecutor
+
+class TestBinaryCache {
+
+  private var directory: File = _
+
+  // A kernel whose source has never been built before
+  private def uniqueSource(): String =
+    s"""// ${System.nanoTime()} ${util.Random.nextLong()}
+       |kernel void inc(global float* out) {
+       |  out[get_global_id(0)] += 1.0f;
+       |}""".stripMargin
+
+  private def build(source: String): Unit = {
+    val kernel = Kernel.create(source, "inc", "")
+    try kernel.build() finally kernel.dispose()
+  }
+
+  @Before
+  def enable(): Unit = {
+    directory = Files.createTempDirectory("executor-binary-cache").toFile
+    Executor.enableBinaryCache(directory.getPath, 0)
+  }
+
+  @After
+  def disable(): Unit = {
+    Executor.disableBinaryCache()
+    Option(directory.listFiles()).foreach(_.foreach(_.delete()))
+    directory.delete()
+  }
+
+  @Test
+  def programIsLoadedFromTheCacheAfterBeingPurged(): Unit = {
+    val source = uniqueSource()
+
+    val misses = Executor.getBinaryCacheMisses
+    build(source)
+    assertEquals(misses + 1, Executor.getBinaryCacheMisses)
+    assertTrue("no binary has been stored", directory.listFiles().nonEmpty)
+
+    // the in-memory cache would otherwise provide the program
+    Executor.purgeProgramCache()
+    val hits = Executor.getBinaryCacheHits
+    build(source)
+    assertEquals(hits + 1, Executor.getBinaryCacheHits)
+    assertEquals(misses + 1, Executor.getBinaryCacheMisses)
+  }
+
+  @Test
+  def differentBuildOptionsAreCachedSeparately(): Unit = {
+    val source = uniqueSource()
+    build(source)
+
+    Executor.purgeProgramCache()
+    val misses = Executor.getBinaryCacheMisses
+    val kernel = Kernel.create(source, "inc", "-cl-fast-relaxed-math")
+    try kernel.build() finally kernel.dispose()
+    assertEquals(misses + 1, Executor.getBinaryCacheMisses)
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def negativeSizeIsRejected(): Unit =
+    Executor.enableBinaryCache(directory.getPath, -1)
+}
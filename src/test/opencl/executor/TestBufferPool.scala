@@ -0,0 +1,108 @@
+/**
+ * Test cases for the pool recycling device buffers.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestBufferPool extends TestWithExecutor
+
+class TestBufferPool {
+
+  // the default high-water mark of the pool
+  private val highWaterMark = 256L * 1024 * 1024
+
+  private val touchKernel =
+    """kernel void touch(global float* out) {
+      |  out[get_global_id(0)] = 1.0f;
+      |}""".stripMargin
+
+  // Runs a kernel on output, so that its device buffer is acquired from the pool
+  private def allocate(output: GlobalArg): Unit = {
+    val kernel = Kernel.create(touchKernel, "touch", "")
+    try {
+      Executor.execute(kernel, 1, 1, 1, 1, 1, 1, Array[KernelArg](output))
+    } finally {
+      kernel.dispose()
+    }
+  }
+
+  @After
+  def restoreHighWaterMark(): Unit =
+    Executor.setBufferPoolHighWaterMark(highWaterMark)
+
+  @Test
+  def smallSizesAreRoundedToPowersOfTwo(): Unit = {
+    // no idle buffers, so that the request is served by a new buffer
+    Executor.setBufferPoolHighWaterMark(0)
+    val before = Executor.getBufferPoolStatistics
+
+    val output = GlobalArg.createOutput(1000)
+    try {
+      allocate(output)
+      val during = Executor.getBufferPoolStatistics
+      assertEquals(1000L, during.bytesInUse - before.bytesInUse)
+      assertEquals(1024L, during.bytesReserved - before.bytesReserved)
+      assertTrue(during.fragmentation > 0.0)
+    } finally {
+      output.dispose()
+    }
+
+    // a high-water mark of 0 frees released buffers right away
+    val after = Executor.getBufferPoolStatistics
+    assertEquals(before.bytesInUse, after.bytesInUse)
+    assertEquals(before.bytesReserved, after.bytesReserved)
+  }
+
+  @Test
+  def largeSizesAreRoundedToSlabs(): Unit = {
+    val slab = 16L * 1024 * 1024
+    Assume.assumeTrue("Device can't allocate two slabs at once",
+      Executor.getDeviceMaxMemAllocSize >= 2 * slab)
+
+    Executor.setBufferPoolHighWaterMark(0)
+    val before = Executor.getBufferPoolStatistics
+
+    val output = GlobalArg.createOutput(slab + 4)
+    try {
+      allocate(output)
+      val during = Executor.getBufferPoolStatistics
+      assertEquals(slab + 4, during.bytesInUse - before.bytesInUse)
+      assertEquals(2 * slab, during.bytesReserved - before.bytesReserved)
+    } finally {
+      output.dispose()
+    }
+  }
+
+  @Test
+  def releasedBuffersAreReusedForTheSameSizeClass(): Unit = {
+    Executor.setBufferPoolHighWaterMark(0)
+    Executor.setBufferPoolHighWaterMark(highWaterMark)
+
+    val first = GlobalArg.createOutput(3000)
+    allocate(first)
+    first.dispose()
+    val idle = Executor.getBufferPoolStatistics
+
+    // 3000 and 2500 bytes share the size class of 4096 bytes
+    val second = GlobalArg.createOutput(2500)
+    try {
+      allocate(second)
+      val reused = Executor.getBufferPoolStatistics
+      assertTrue(reused.hitRate > idle.hitRate)
+      assertEquals(idle.bytesReserved, reused.bytesReserved)
+      assertEquals(2500L, reused.bytesInUse - idle.bytesInUse)
+    } finally {
+      second.dispose()
+    }
+
+    // the buffer is kept idle below the high-water mark
+    assertEquals(idle.bytesReserved, Executor.getBufferPoolStatistics.bytesReserved)
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def negativeHighWaterMarkIsRejected(): Unit =
+    Executor.setBufferPoolHighWaterMark(-1)
+}
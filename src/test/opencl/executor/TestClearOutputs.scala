@@ -0,0 +1,57 @@
+/**
+ * Test cases for clearing the outputs on the device before every iteration of a benchmark.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestClearOutputs extends TestWithExecutor
+
+class TestClearOutputs {
+
+  private val size = 4096
+
+  private val accumulateKernel =
+    """kernel void accumulate(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] += in[i];
+      |}""".stripMargin
+
+  @Test
+  def everyIterationStartsFromZero(): Unit = {
+    val kernel = Kernel.create(accumulateKernel, "accumulate", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val runtimes = Executor.benchmark(kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output), 5, 0.0)
+      assertEquals(5, runtimes.length)
+      assertArrayEquals(Array.tabulate(size)(_.toFloat), output.asFloatArray(), 0.0f)
+      // inputs are not cleared
+      assertEquals(9.0f, input.at(9), 0.0f)
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def outputWrittenByTheHostIsCleared(): Unit = {
+    val kernel = Kernel.create(accumulateKernel, "accumulate", "")
+    val input = GlobalArg.createInput(Array.fill(size)(1.0f))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      output.writeFloats(0, Array.fill(size)(100.0f))
+      Executor.benchmark(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output), 2, 0.0)
+      assertEquals(1.0f, output.at(0), 0.0f)
+      assertEquals(1.0f, output.at(size - 1), 0.0f)
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+}
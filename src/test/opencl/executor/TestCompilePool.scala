@@ -0,0 +1,94 @@
+/**
+ * Test cases for building kernels in the background.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestCompilePool extends TestWithExecutor
+
+class TestCompilePool {
+
+  // A kernel whose source has never been built before
+  private def uniqueSource(): String =
+    s"""// ${System.nanoTime()} ${util.Random.nextLong()}
+       |kernel void fill(global float* out) {
+       |  out[get_global_id(0)] = 1.0f;
+       |}""".stripMargin
+
+  @After
+  def restoreCompileThreads(): Unit =
+    Executor.setCompileThreads(0)
+
+  @Test
+  def kernelsBuiltInTheBackgroundExecute(): Unit = {
+    Executor.setCompileThreads(4)
+
+    val kernels = (0 until 16).map(_ => Kernel.create(uniqueSource(), "fill", ""))
+    try {
+      kernels.foreach(_.buildAsync())
+      // executions only wait for the kernel they launch
+      kernels.foreach { kernel =>
+        val output = GlobalArg.createOutput(64 * 4)
+        try {
+          Executor.execute(kernel, 64, 1, 1, 64, 1, 1, Array[KernelArg](output))
+          assertEquals(1.0f, output.at(63), 0.0f)
+        } finally {
+          output.dispose()
+        }
+      }
+    } finally {
+      kernels.foreach(_.dispose())
+    }
+  }
+
+  @Test
+  def buildingTwiceBuildsOnce(): Unit = {
+    val kernel = Kernel.create(uniqueSource(), "fill", "")
+    try {
+      val misses = Executor.getProgramCacheMisses
+      kernel.buildAsync()
+      kernel.buildAsync()
+      kernel.build()
+      assertEquals(misses + 1, Executor.getProgramCacheMisses)
+    } finally {
+      kernel.dispose()
+    }
+  }
+
+  @Test
+  def buildErrorIsReportedWhenWaitingForTheKernel(): Unit = {
+    val kernel = Kernel.create("kernel void broken(global float* out) { out[0] = ; }", "broken", "")
+    try {
+      kernel.buildAsync()
+      for (_ <- 0 until 2) {
+        try {
+          kernel.build()
+          fail("the kernel must not compile")
+        } catch {
+          case _: Executor.ExecutorFailureException =>
+        }
+      }
+    } finally {
+      kernel.dispose()
+    }
+  }
+
+  @Test
+  def singleThreadBuildsAllKernels(): Unit = {
+    Executor.setCompileThreads(1)
+    val kernels = (0 until 4).map(_ => Kernel.create(uniqueSource(), "fill", ""))
+    try {
+      kernels.foreach(_.buildAsync())
+      kernels.foreach(_.build())
+    } finally {
+      kernels.foreach(_.dispose())
+    }
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def negativeNumberOfThreadsIsRejected(): Unit =
+    Executor.setCompileThreads(-1)
+}
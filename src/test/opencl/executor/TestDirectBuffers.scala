@@ -0,0 +1,78 @@
+/**
+ * Test cases for arguments using the memory of direct ByteBuffers without copying it.
+ */
+
+package opencl.executor
+
+import java.nio.{ByteBuffer, ByteOrder}
+
+import org.junit.Assert._
+import org.junit._
+
+object TestDirectBuffers extends TestWithExecutor
+
+class TestDirectBuffers {
+
+  private val size = 4096
+
+  private val scaleKernel =
+    """kernel void scale(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = 2.0f * in[i];
+      |}""".stripMargin
+
+  private def directFloats(count: Int): ByteBuffer =
+    ByteBuffer.allocateDirect(count * 4).order(ByteOrder.nativeOrder())
+
+  @Test
+  def kernelReadsAndWritesDirectBuffers(): Unit = {
+    val in = directFloats(size)
+    for (i <- 0 until size) in.putFloat(i * 4, i.toFloat)
+    val out = directFloats(size)
+
+    val kernel = Kernel.create(scaleKernel, "scale", "")
+    val input = GlobalArg.createInput(in)
+    val output = GlobalArg.createOutput(out)
+    try {
+      Executor.execute(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output))
+      // the output is downloaded straight into the buffer
+      assertEquals(2.0f * 7, out.getFloat(7 * 4), 0.0f)
+      assertEquals(2.0f * (size - 1), out.getFloat((size - 1) * 4), 0.0f)
+      assertEquals(2.0f * 7, output.at(7), 0.0f)
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def outputBufferIsUpdatedByEveryLaunch(): Unit = {
+    val out = directFloats(size)
+
+    val kernel = Kernel.create(scaleKernel, "scale", "")
+    val output = GlobalArg.createOutput(out)
+    try {
+      for (k <- 1 to 3) {
+        val input = GlobalArg.createInput(Array.fill(size)(k.toFloat))
+        try {
+          Executor.execute(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output))
+          assertEquals(2.0f * k, out.getFloat(0), 0.0f)
+        } finally {
+          input.dispose()
+        }
+      }
+    } finally {
+      kernel.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def heapBufferIsRejected(): Unit =
+    GlobalArg.createInput(ByteBuffer.allocate(16))
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def emptyBufferIsRejected(): Unit =
+    GlobalArg.createOutput(ByteBuffer.allocateDirect(0))
+}
@@ -0,0 +1,89 @@
+/**
+ * Test cases for partial uploads of modified ranges of GlobalArgs.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestDirtyRanges extends TestWithExecutor
+
+class TestDirtyRanges {
+
+  private val copyKernel =
+    """kernel void copy(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = in[i];
+      |}""".stripMargin
+
+  // Runs kernel on input and returns the output read back from the device
+  private def run(source: String, name: String, input: GlobalArg, size: Int): Array[Float] = {
+    val kernel = Kernel.create(source, name, "")
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      Executor.execute(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output))
+      output.asFloatArray()
+    } finally {
+      output.dispose()
+      kernel.dispose()
+    }
+  }
+
+  // Writes values at index into arg and into expected
+  private def write(arg: GlobalArg, expected: Array[Float], index: Int, values: Array[Float]): Unit = {
+    arg.writeFloats(index, values)
+    Array.copy(values, 0, expected, index, values.length)
+  }
+
+  @Test
+  def overlappingAndAdjacentWritesAreUploaded(): Unit = {
+    val size = 1024
+    val expected = Array.tabulate(size)(_.toFloat)
+    val input = GlobalArg.createInput(expected.clone())
+    try {
+      assertArrayEquals(expected, run(copyKernel, "copy", input, size), 0.0f)
+
+      // overlapping ranges
+      write(input, expected, 10, Array.fill(5)(-1.0f))
+      write(input, expected, 12, Array.fill(5)(-2.0f))
+      // adjacent ranges
+      write(input, expected, 30, Array.fill(5)(-3.0f))
+      write(input, expected, 35, Array.fill(5)(-4.0f))
+      // a range covering several ranges
+      write(input, expected, 100, Array(-5.0f))
+      write(input, expected, 104, Array(-6.0f))
+      write(input, expected, 99, Array.fill(8)(-7.0f))
+      // the last element
+      write(input, expected, size - 1, Array(-8.0f))
+
+      assertArrayEquals(expected, run(copyKernel, "copy", input, size), 0.0f)
+    } finally {
+      input.dispose()
+    }
+  }
+
+  @Test
+  def tooManyDisjointWritesAreUploadedAsAWhole(): Unit = {
+    val size = 1024
+    val expected = Array.tabulate(size)(_.toFloat)
+    val input = GlobalArg.createInput(expected.clone())
+    try {
+      assertArrayEquals(expected, run(copyKernel, "copy", input, size), 0.0f)
+
+      // more disjoint ranges than are tracked individually
+      for (k <- 0 until 40)
+        write(input, expected, 8 * k, Array(-k.toFloat))
+      // writes after the limit has been exceeded
+      write(input, expected, 500, Array.fill(3)(-100.0f))
+
+      assertArrayEquals(expected, run(copyKernel, "copy", input, size), 0.0f)
+
+      // tracking starts over once the input has been uploaded
+      write(input, expected, 600, Array(-200.0f))
+      assertArrayEquals(expected, run(copyKernel, "copy", input, size), 0.0f)
+    } finally {
+      input.dispose()
+    }
+  }
+}
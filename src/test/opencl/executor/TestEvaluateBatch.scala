@@ -0,0 +1,85 @@
+/**
+ * Test cases for evaluating many candidate kernels in a single call.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestEvaluateBatch extends TestWithExecutor
+
+class TestEvaluateBatch {
+
+  private val size = 1024
+
+  private val scaleKernel =
+    """kernel void scale(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = 3.0f * in[i];
+      |}""".stripMargin
+
+  private val brokenKernel =
+    """kernel void scale(const global float* restrict in, global float* out) {
+      |  out[get_global_id(0)] = undeclared * in[0];
+      |}""".stripMargin
+
+  private def ndRanges(numCandidates: Int): Array[Int] =
+    Array.fill(numCandidates)(Array(64, 1, 1, size, 1, 1)).flatten
+
+  private def withArgs[T](body: Array[KernelArg] => T): T = {
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      body(Array[KernelArg](input, output))
+    } finally {
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def candidatesAreEvaluated(): Unit = {
+    val kernels = Array(Kernel.create(scaleKernel, "scale", ""),
+                        Kernel.create(scaleKernel, "scale", "-cl-fast-relaxed-math"))
+    try {
+      withArgs { args =>
+        val results = Executor.evaluateBatch(kernels, ndRanges(kernels.length), args, 3, 0.0)
+        assertEquals(kernels.length, results.length)
+        results.foreach(r => assertTrue(r >= 0.0))
+        assertEquals(3.0f * 7.0f, args(1).asInstanceOf[GlobalArg].asFloatArray()(7), 0.0f)
+      }
+    } finally {
+      kernels.foreach(_.dispose())
+    }
+  }
+
+  @Test
+  def failedCandidateCanBeEvaluatedAgain(): Unit = {
+    val broken = Kernel.create(brokenKernel, "scale", "")
+    val good = Kernel.create(scaleKernel, "scale", "")
+    try {
+      withArgs { args =>
+        // the failed build is reported to every use of the same Kernel
+        val kernels = Array(broken, good, broken)
+        val first = Executor.evaluateBatch(kernels, ndRanges(kernels.length), args, 3, 0.0)
+        assertEquals(-1.0, first(0), 0.0)
+        assertTrue(first(1) >= 0.0)
+        assertEquals(-1.0, first(2), 0.0)
+
+        val second = Executor.evaluateBatch(Array(broken), ndRanges(1), args, 3, 0.0)
+        assertEquals(-1.0, second(0), 0.0)
+
+        try {
+          Executor.execute(broken, 64, 1, 1, size, 1, 1, args)
+          fail("executing a kernel which does not build must fail")
+        } catch {
+          case _: Executor.ExecutorFailureException =>
+        }
+      }
+    } finally {
+      broken.dispose()
+      good.dispose()
+    }
+  }
+}
@@ -0,0 +1,99 @@
+/**
+ * Test cases for evaluating candidate kernels with an early abort.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestEvaluateWithEarlyAbort extends TestWithExecutor
+
+class TestEvaluateWithEarlyAbort {
+
+  private val size = 64 * 1024
+
+  // A kernel whose source has never been built before
+  private def uniqueSource(): String =
+    s"""// ${System.nanoTime()} ${util.Random.nextLong()}
+       |kernel void scale(const global float* restrict in, global float* out) {
+       |  int i = get_global_id(0);
+       |  out[i] = 2.0f * in[i];
+       |}""".stripMargin
+
+  // Evaluates a new kernel and checks its output unless it has been aborted
+  private def evaluate(iterations: Int, bestRuntime: Double,
+                       sizesInjected: Boolean): EvaluationResult = {
+    val kernel = Kernel.create(uniqueSource(), "scale", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val result = Executor.evaluateWithEarlyAbort(kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output), iterations, 60000.0, bestRuntime, sizesInjected)
+      if (result.status != EvaluationResult.Status.ABORTED)
+        assertEquals(2.0f * (size - 1), output.at(size - 1), 0.0f)
+      result
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def withoutInjectedSizesThereIsNoProbe(): Unit = {
+    val misses = Executor.getProgramCacheMisses
+    val result = evaluate(5, 0.0, sizesInjected = false)
+
+    assertEquals(EvaluationResult.Status.COMPLETED, result.status)
+    assertEquals(5, result.runtimes.length)
+    assertEquals(0.0, result.probeFraction, 0.0)
+    assertEquals(0.0, result.estimate, 0.0)
+    assertTrue(result.runtime >= 0.0)
+    // no second program is built for a probe
+    assertEquals(misses + 1, Executor.getProgramCacheMisses)
+  }
+
+  @Test
+  def withInjectedSizesASlabIsProbed(): Unit = {
+    val result = evaluate(5, 0.0, sizesInjected = true)
+
+    assertEquals(EvaluationResult.Status.COMPLETED, result.status)
+    assertEquals(5, result.runtimes.length)
+    assertTrue(result.probeFraction > 0.0 && result.probeFraction <= 1.0)
+    assertTrue(result.estimate >= 0.0)
+  }
+
+  @Test
+  def candidatesFarSlowerThanTheBestAreAborted(): Unit = {
+    val result = evaluate(5, 1.0e-9, sizesInjected = true)
+
+    assertEquals(EvaluationResult.Status.ABORTED, result.status)
+    assertEquals(0, result.runtimes.length)
+    assertEquals(result.estimate, result.runtime, 0.0)
+  }
+
+  @Test
+  def bestRuntimeIsIgnoredWithoutInjectedSizes(): Unit = {
+    val result = evaluate(3, 1.0e-9, sizesInjected = false)
+    assertEquals(EvaluationResult.Status.COMPLETED, result.status)
+    assertEquals(3, result.runtimes.length)
+  }
+
+  @Test
+  def evaluateReturnsTheMedianRuntime(): Unit = {
+    val kernel = Kernel.create(uniqueSource(), "scale", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val runtime = Executor.evaluate(kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output), 3, 60000.0)
+      assertTrue(runtime >= 0.0)
+      assertEquals(6.0f, output.at(3), 0.0f)
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+}
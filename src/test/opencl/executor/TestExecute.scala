@@ -4,6 +4,7 @@ import ir._
 import ir.ast._
 import lift.arithmetic._
 import core.generator.GenericAST.ArithExpression
+import opencl.generator.NDRange
 import opencl.ir._
 import opencl.ir.pattern._
 import org.junit.Assert._
@@ -265,6 +266,31 @@ class TestExecute {
     assertEquals(inputA.sum + inputB._2, floatSum, 0.0001f)
   }
 
+  @Test
+  def pipeline(): Unit = {
+    val size = 1024
+    val input = Array.fill(size)(util.Random.nextFloat() * 10)
+
+    val f = \(ArrayTypeWSWC(Float, N),
+      MapGlb(plusOne) $ _
+    )
+    val g = \(ArrayTypeWSWC(Float, N),
+      MapGlb(plusOne) $ _
+    )
+
+    val local = NDRange(128)
+    val global = NDRange(size)
+    val stages = Seq(
+      Execute.PipelineStage(Compile(f), f, local, global),
+      Execute.PipelineStage(Compile(g), g, local, global)
+    )
+
+    val (output, runtimes) = Execute.pipeline[Array[Float]](stages, input)
+
+    assertEquals(2, runtimes.length)
+    assertArrayEquals(input.map(_+2), output, 0.001f)
+  }
+
   @Test
   def allocateMoreThan2GB(): Unit = {
     val size = 268435456 // 2^28
@@ -0,0 +1,81 @@
+/**
+ * Test cases for executing kernels asynchronously.
+ */
+
+package opencl.executor
+
+import java.util.concurrent.TimeUnit
+
+import org.junit.Assert._
+import org.junit._
+
+object TestExecuteAsync extends TestWithExecutor
+
+class TestExecuteAsync {
+
+  private val size = 1024
+
+  private val incKernel =
+    """kernel void inc(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = in[i] + 1.0f;
+      |}""".stripMargin
+
+  @Test
+  def futureIsCompletedWithTheRuntime(): Unit = {
+    val kernel = Kernel.create(incKernel, "inc", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val runtime = Executor.executeAsync(kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output)).get(60, TimeUnit.SECONDS)
+      assertTrue(runtime >= 0.0)
+      assertArrayEquals(Array.tabulate(size)(_ + 1.0f), output.asFloatArray(), 0.0f)
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def manyExecutionsAreCompleted(): Unit = {
+    val kernel = Kernel.create(incKernel, "inc", "")
+    val inputs = (0 until 16).map(k => GlobalArg.createInput(Array.fill(size)(k.toFloat)))
+    val outputs = inputs.map(_ => GlobalArg.createOutput(size * 4))
+    try {
+      val futures = inputs.zip(outputs).map { case (input, output) =>
+        Executor.executeAsync(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output))
+      }
+      futures.foreach(_.get(60, TimeUnit.SECONDS))
+      outputs.zipWithIndex.foreach { case (output, k) =>
+        assertEquals(k + 1.0f, output.asFloatArray()(size - 1), 0.0f)
+      }
+    } finally {
+      kernel.dispose()
+      inputs.foreach(_.dispose())
+      outputs.foreach(_.dispose())
+    }
+  }
+
+  @Test
+  def failedExecutionThrowsAndLeavesTheExecutorUsable(): Unit = {
+    val broken = Kernel.create("kernel void broken(global float* out) { out[0] = ; }", "broken", "")
+    val output = GlobalArg.createOutput(4)
+    try {
+      // the references of the completion are released without a callback
+      for (_ <- 0 until 8) {
+        try {
+          Executor.executeAsync(broken, 1, 1, 1, 1, 1, 1, Array[KernelArg](output))
+          fail("the kernel must not compile")
+        } catch {
+          case _: Executor.ExecutorFailureException =>
+        }
+      }
+    } finally {
+      broken.dispose()
+      output.dispose()
+    }
+    futureIsCompletedWithTheRuntime()
+  }
+}
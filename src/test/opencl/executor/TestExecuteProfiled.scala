@@ -0,0 +1,75 @@
+/**
+ * Test cases for the profile of a single execution.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestExecuteProfiled extends TestWithExecutor
+
+class TestExecuteProfiled {
+
+  private val size = 16 * 1024
+
+  private val copyKernel =
+    """kernel void copy(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = in[i];
+      |}""".stripMargin
+
+  @Test
+  def profileContainsEveryCommandInOrder(): Unit = {
+    val kernel = Kernel.create(copyKernel, "copy", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val profile = Executor.executeProfiled(kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output))
+      assertEquals(42.0f, output.at(42), 0.0f)
+
+      val uploads = profile.commands.filter(_.kind == ExecutionProfile.Kind.UPLOAD)
+      val kernels = profile.commands.filter(_.kind == ExecutionProfile.Kind.KERNEL)
+      val downloads = profile.commands.filter(_.kind == ExecutionProfile.Kind.DOWNLOAD)
+      assertEquals(1, kernels.length)
+      assertTrue(uploads.map(_.bytes).sum >= size * 4L)
+      assertEquals(size * 4L, downloads.map(_.bytes).sum)
+      assertEquals(0L, kernels.head.bytes)
+
+      profile.commands.foreach { c =>
+        assertTrue(c.toString, c.queued <= c.submit && c.submit <= c.start && c.start <= c.end)
+      }
+      // the kernel waits for the upload, the download for the kernel
+      uploads.foreach(u => assertTrue(u.end <= kernels.head.start))
+      downloads.foreach(d => assertTrue(kernels.head.end <= d.start))
+      assertEquals(profile.commands.map(_.start).sorted.toSeq, profile.commands.map(_.start).toSeq)
+
+      assertTrue(profile.buildTime >= 0.0)
+      assertTrue(profile.hostTime >= profile.buildTime)
+      assertTrue(Set("compute", "transfer", "launch").contains(profile.bound()))
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def inputsAreOnlyUploadedOnce(): Unit = {
+    val kernel = Kernel.create(copyKernel, "copy", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val args = Array[KernelArg](input, output)
+      Executor.executeProfiled(kernel, 64, 1, 1, size, 1, 1, args)
+      val profile = Executor.executeProfiled(kernel, 64, 1, 1, size, 1, 1, args)
+      assertTrue(profile.commands.forall(_.kind != ExecutionProfile.Kind.UPLOAD))
+      assertEquals(1, profile.commands.count(_.kind == ExecutionProfile.Kind.KERNEL))
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+}
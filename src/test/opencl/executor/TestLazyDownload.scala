@@ -0,0 +1,68 @@
+/**
+ * Test cases for outputs which are only downloaded once the host reads them.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestLazyDownload extends TestWithExecutor
+
+class TestLazyDownload {
+
+  private val size = 64 * 1024
+
+  private val indexKernel =
+    """kernel void index(global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = (float) i;
+      |}""".stripMargin
+
+  // Runs indexKernel on a new output and passes the output to body
+  private def withOutput(body: GlobalArg => Unit): Unit = {
+    val kernel = Kernel.create(indexKernel, "index", "")
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      Executor.execute(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](output))
+      body(output)
+    } finally {
+      kernel.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def rangesAreReadWithoutTheWholeOutput(): Unit = withOutput { output =>
+    assertArrayEquals(Array(100.0f, 101.0f, 102.0f), output.readFloats(100, 3), 0.0f)
+    assertEquals(size - 1.0f, output.at(size - 1), 0.0f)
+
+    val bytes = output.readBytes(4, 4)
+    assertEquals(4, bytes.length)
+    assertEquals(1.0f, java.nio.ByteBuffer.wrap(bytes)
+      .order(java.nio.ByteOrder.nativeOrder()).getFloat, 0.0f)
+  }
+
+  @Test
+  def wholeOutputIsReadAfterRanges(): Unit = withOutput { output =>
+    output.readFloats(10, 10)
+    assertArrayEquals(Array.tabulate(size)(_.toFloat), output.asFloatArray(), 0.0f)
+    // served from the host copy now
+    assertEquals(12.0f, output.at(12), 0.0f)
+  }
+
+  @Test
+  def emptyRangeAtTheEndIsValid(): Unit = withOutput { output =>
+    assertEquals(0, output.readFloats(size, 0).length)
+  }
+
+  @Test(expected = classOf[IndexOutOfBoundsException])
+  def rangeBeyondTheOutputIsRejected(): Unit = withOutput { output =>
+    output.readFloats(size - 1, 2)
+  }
+
+  @Test(expected = classOf[IndexOutOfBoundsException])
+  def negativeIndexIsRejected(): Unit = withOutput { output =>
+    output.at(-1)
+  }
+}
@@ -0,0 +1,73 @@
+/**
+ * Test cases for GlobalArgs mapping files.
+ */
+
+package opencl.executor
+
+import java.nio.file.Files
+import java.nio.{ByteBuffer, ByteOrder}
+
+import org.junit.Assert._
+import org.junit._
+
+object TestMappedFile extends TestWithExecutor
+
+class TestMappedFile {
+
+  private val doubleKernel =
+    """kernel void twice(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = 2.0f * in[i];
+      |}""".stripMargin
+
+  @Test
+  def mappedFileRoundTrip(): Unit = {
+    val size = 4096
+    // skipped elements at the start of the input file
+    val offset = 256
+    val values = Array.tabulate(offset + size)(_.toFloat)
+
+    val inputFile = Files.createTempFile("executor-input", ".bin")
+    val outputFile = Files.createTempFile("executor-output", ".bin")
+    try {
+      val bytes = ByteBuffer.allocate(values.length * 4).order(ByteOrder.nativeOrder())
+      bytes.asFloatBuffer().put(values)
+      Files.write(inputFile, bytes.array())
+
+      val input = GlobalArg.createInputFromFile(inputFile.toString, offset * 4, size * 4)
+      val output = GlobalArg.createOutputToFile(outputFile.toString, size * 4)
+      val kernel = Kernel.create(doubleKernel, "twice", "")
+      try {
+        Executor.execute(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output))
+      } finally {
+        kernel.dispose()
+        input.dispose()
+        // waits for the download into the file
+        output.dispose()
+      }
+
+      val written = ByteBuffer.wrap(Files.readAllBytes(outputFile)).order(ByteOrder.nativeOrder())
+      assertEquals(size * 4, written.capacity())
+      val result = new Array[Float](size)
+      written.asFloatBuffer().get(result)
+      assertArrayEquals(values.drop(offset).map(_ * 2.0f), result, 0.0f)
+
+      // the input file is never modified
+      assertArrayEquals(bytes.array(), Files.readAllBytes(inputFile))
+    } finally {
+      Files.deleteIfExists(inputFile)
+      Files.deleteIfExists(outputFile)
+    }
+  }
+
+  @Test(expected = classOf[java.io.IOException])
+  def mappingBeyondTheEndOfTheFileFails(): Unit = {
+    val file = Files.createTempFile("executor-input", ".bin")
+    try {
+      Files.write(file, new Array[Byte](16))
+      GlobalArg.createInputFromFile(file.toString, 8, 16)
+    } finally {
+      Files.deleteIfExists(file)
+    }
+  }
+}
@@ -0,0 +1,112 @@
+/**
+ * Test cases for the counters, histograms and gauges of the executor.
+ */
+
+package opencl.executor
+
+import java.io.File
+import java.nio.charset.StandardCharsets
+import java.nio.file.Files
+
+import org.junit.Assert._
+import org.junit._
+
+object TestMetrics extends TestWithExecutor
+
+class TestMetrics {
+
+  private val size = 1024
+
+  private val copyKernel =
+    """kernel void copy(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = in[i];
+      |}""".stripMargin
+
+  private def execute(): Unit = {
+    val kernel = Kernel.create(copyKernel, "copy", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      Executor.execute(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output))
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  private def metric(name: String): Double = {
+    val metrics = Executor.getMetrics
+    assertTrue(name + " is missing", metrics.containsKey(name))
+    metrics.get(name)
+  }
+
+  // The latencies are recorded by callbacks, which may run after execute has returned
+  private def awaitDownloadLatencies(count: Double): Unit = {
+    val deadline = System.currentTimeMillis() + 10000
+    while (metric("transfer.download.latency_us.count") < count &&
+           System.currentTimeMillis() < deadline) Thread.sleep(10)
+    assertEquals(count, metric("transfer.download.latency_us.count"), 0.0)
+  }
+
+  @After
+  def disable(): Unit = {
+    Executor.stopMetricsDump()
+    Executor.disableMetrics()
+  }
+
+  @Test
+  def countersAreUpdated(): Unit = {
+    execute()
+    val launches = metric("kernel.launches")
+    val uploads = metric("transfer.upload.count")
+    val downloadBytes = metric("transfer.download.bytes")
+
+    execute()
+    assertEquals(launches + 1, metric("kernel.launches"), 0.0)
+    assertTrue(metric("transfer.upload.count") >= uploads + 1)
+    assertEquals(downloadBytes + size * 4, metric("transfer.download.bytes"), 0.0)
+    assertTrue(metric("build.count") >= 1)
+    assertTrue(metric("buffer.allocations") >= 1)
+    assertTrue(metric("kernel.enqueue_us.count") >= 2)
+  }
+
+  @Test
+  def latenciesAreOnlyRecordedWhileEnabled(): Unit = {
+    execute()
+    val count = metric("transfer.download.latency_us.count")
+    execute()
+    assertEquals(count, metric("transfer.download.latency_us.count"), 0.0)
+
+    Executor.enableMetrics()
+    execute()
+    awaitDownloadLatencies(count + 1)
+    assertTrue(metric("transfer.download.latency_us.max") > 0.0)
+  }
+
+  @Test
+  def metricsAreDumpedPeriodically(): Unit = {
+    val file = File.createTempFile("executor-metrics", ".json")
+    try {
+      Executor.startMetricsDump(file.getPath, 0.05)
+      val deadline = System.currentTimeMillis() + 10000
+      while (file.length() == 0 && System.currentTimeMillis() < deadline) Thread.sleep(10)
+      Executor.stopMetricsDump()
+
+      val lines = new String(Files.readAllBytes(file.toPath), StandardCharsets.UTF_8).trim.split("\n")
+      assertTrue(lines.head.startsWith("{"))
+      assertTrue(lines.head.contains("\"kernel.launches\""))
+    } finally {
+      file.delete()
+    }
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def nonPositiveIntervalIsRejected(): Unit =
+    Executor.startMetricsDump("metrics.json", 0.0)
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def nanIntervalIsRejected(): Unit =
+    Executor.startMetricsDump("metrics.json", Double.NaN)
+}
@@ -0,0 +1,104 @@
+/**
+ * Test cases for selecting one of several devices per thread and for executing kernels from
+ * several threads at the same time.
+ */
+
+package opencl.executor
+
+import java.util.concurrent.ConcurrentLinkedQueue
+
+import org.junit.Assert._
+import org.junit._
+
+object TestMultipleDevices extends TestWithExecutor
+
+class TestMultipleDevices {
+
+  private val size = 4096
+
+  private val addKernel =
+    """kernel void add(const global float* restrict in, global float* out, float value) {
+      |  int i = get_global_id(0);
+      |  out[i] = in[i] + value;
+      |}""".stripMargin
+
+  // Adds value to the indices on the given device and returns the output
+  private def add(device: Int, value: Float): Array[Float] = {
+    val kernel = Kernel.create(addKernel, "add", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      Executor.execute(device, kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output, ValueArg.create(value)))
+      output.asFloatArray()
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  // Runs body on numThreads threads at once and fails with the first exception thrown
+  private def concurrently(numThreads: Int)(body: Int => Unit): Unit = {
+    val failures = new ConcurrentLinkedQueue[Throwable]()
+    val threads = (0 until numThreads).map(t => new Thread(new Runnable {
+      override def run(): Unit =
+        try body(t) catch {
+          case e: Throwable => failures.add(e)
+        }
+    }))
+    threads.foreach(_.start())
+    threads.foreach(_.join())
+    if (!failures.isEmpty) throw failures.peek()
+  }
+
+  @Test
+  def everyDeviceExecutesKernels(): Unit = {
+    assertTrue(Executor.getDeviceCount >= 1)
+    for (device <- 0 until Executor.getDeviceCount) {
+      val output = add(device, device + 1.0f)
+      assertEquals(10.0f + device + 1.0f, output(10), 0.0f)
+    }
+    // the selection is restored afterwards
+    assertEquals(0, Executor.getSelectedDevice)
+  }
+
+  @Test
+  def selectionIsPerThread(): Unit = {
+    val last = Executor.getDeviceCount - 1
+    Executor.selectDevice(last)
+    try {
+      concurrently(1) { _ =>
+        assertEquals(0, Executor.getSelectedDevice)
+      }
+      assertEquals(last, Executor.getSelectedDevice)
+    } finally {
+      Executor.selectDevice(0)
+    }
+  }
+
+  @Test
+  def threadsExecuteConcurrently(): Unit = {
+    val numDevices = Executor.getDeviceCount
+    concurrently(8) { t =>
+      for (k <- 0 until 16) {
+        val output = add(t % numDevices, t.toFloat)
+        assertEquals(t.toFloat, output(0), 0.0f)
+        assertEquals(size - 1.0f + t, output(size - 1), 0.0f)
+      }
+    }
+  }
+
+  @Test
+  def threadsBuildTheSameSourceConcurrently(): Unit = {
+    val source = s"// ${System.nanoTime()}\n" + addKernel
+    concurrently(8) { _ =>
+      val kernel = Kernel.create(source, "add", "")
+      try kernel.build() finally kernel.dispose()
+    }
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def invalidDeviceIsRejected(): Unit =
+    Executor.selectDevice(Executor.getDeviceCount)
+}
@@ -0,0 +1,90 @@
+/**
+ * Test cases for the separate upload, compute and download queues of a device, whose commands
+ * are ordered by event dependencies only.
+ */
+
+package opencl.executor
+
+import java.util.concurrent.TimeUnit
+
+import org.junit.Assert._
+import org.junit._
+
+object TestOverlappedQueues extends TestWithExecutor
+
+class TestOverlappedQueues {
+
+  private val size = 64 * 1024
+
+  private val scaleKernel =
+    """kernel void scale(const global float* restrict in, global float* out, float factor) {
+      |  int i = get_global_id(0);
+      |  out[i] = factor * in[i];
+      |}""".stripMargin
+
+  @Test
+  def backToBackExecutionsSeeTheirOwnInputs(): Unit = {
+    val kernel = Kernel.create(scaleKernel, "scale", "")
+    try {
+      for (k <- 0 until 32) {
+        val input = GlobalArg.createInput(Array.fill(size)(k.toFloat))
+        val output = GlobalArg.createOutput(size * 4)
+        try {
+          Executor.execute(kernel, 128, 1, 1, size, 1, 1,
+            Array[KernelArg](input, output, ValueArg.create(2.0f)))
+          val result = output.asFloatArray()
+          assertEquals(2.0f * k, result(0), 0.0f)
+          assertEquals(2.0f * k, result(size - 1), 0.0f)
+        } finally {
+          input.dispose()
+          output.dispose()
+        }
+      }
+    } finally {
+      kernel.dispose()
+    }
+  }
+
+  @Test
+  def writesBetweenExecutionsAreUploaded(): Unit = {
+    val kernel = Kernel.create(scaleKernel, "scale", "")
+    val input = GlobalArg.createInput(Array.fill(size)(1.0f))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val args = Array[KernelArg](input, output, ValueArg.create(3.0f))
+      Executor.execute(kernel, 128, 1, 1, size, 1, 1, args)
+      assertEquals(3.0f, output.at(size / 2), 0.0f)
+
+      input.writeFloats(size / 2, Array(5.0f))
+      Executor.execute(kernel, 128, 1, 1, size, 1, 1, args)
+      assertEquals(15.0f, output.at(size / 2), 0.0f)
+      assertEquals(3.0f, output.at(size / 2 + 1), 0.0f)
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def asyncExecutionsSharingAnInputOverlap(): Unit = {
+    val kernel = Kernel.create(scaleKernel, "scale", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val outputs = (0 until 8).map(_ => GlobalArg.createOutput(size * 4))
+    try {
+      val futures = outputs.zipWithIndex.map { case (output, k) =>
+        Executor.executeAsync(kernel, 128, 1, 1, size, 1, 1,
+          Array[KernelArg](input, output, ValueArg.create(k.toFloat)))
+      }
+      futures.foreach(_.get(60, TimeUnit.SECONDS))
+      outputs.zipWithIndex.foreach { case (output, k) =>
+        assertEquals(k * 7.0f, output.at(7), 0.0f)
+        assertEquals(k * (size - 1).toFloat, output.at(size - 1), 0.0f)
+      }
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      outputs.foreach(_.dispose())
+    }
+  }
+}
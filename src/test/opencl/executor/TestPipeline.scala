@@ -0,0 +1,77 @@
+/**
+ * Test cases for executing several kernels one after another with their intermediate results
+ * kept on the device.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestPipeline extends TestWithExecutor
+
+class TestPipeline {
+
+  private val size = 4096
+
+  private val scaleKernel =
+    """kernel void scale(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = 2.0f * in[i];
+      |}""".stripMargin
+
+  private val incKernel =
+    """kernel void inc(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = in[i] + 1.0f;
+      |}""".stripMargin
+
+  private def sizes(local: Int, global: Int): Array[Int] = Array(local, 1, 1, global, 1, 1)
+
+  @Test
+  def intermediateResultIsPassedOnTheDevice(): Unit = {
+    val scale = Kernel.create(scaleKernel, "scale", "")
+    val inc = Kernel.create(incKernel, "inc", "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val intermediate = GlobalArg.createOutput(size * 4)
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      val runtimes = Executor.executePipeline(Array(scale, inc),
+        sizes(64, size) ++ sizes(64, size),
+        Array(Array[KernelArg](input, intermediate), Array[KernelArg](intermediate, output)))
+
+      assertEquals(2, runtimes.length)
+      assertTrue(runtimes.forall(_ >= 0.0))
+      assertArrayEquals(Array.tabulate(size)(i => 2.0f * i + 1.0f), output.asFloatArray(), 0.0f)
+      assertEquals(2.0f * 5, intermediate.at(5), 0.0f)
+    } finally {
+      scale.dispose()
+      inc.dispose()
+      input.dispose()
+      intermediate.dispose()
+      output.dispose()
+    }
+  }
+
+  @Test
+  def stagesCanUseDifferentSizes(): Unit = {
+    val inc = Kernel.create(incKernel, "inc", "")
+    val input = GlobalArg.createInput(Array.fill(size)(0.0f))
+    val first = GlobalArg.createOutput(size * 4)
+    val second = GlobalArg.createOutput(size * 4)
+    try {
+      // the second stage only covers the first half
+      Executor.executePipeline(Array(inc, inc),
+        sizes(64, size) ++ sizes(32, size / 2),
+        Array(Array[KernelArg](input, first), Array[KernelArg](first, second)))
+
+      assertEquals(2.0f, second.at(0), 0.0f)
+      assertEquals(2.0f, second.at(size / 2 - 1), 0.0f)
+    } finally {
+      inc.dispose()
+      input.dispose()
+      first.dispose()
+      second.dispose()
+    }
+  }
+}
@@ -0,0 +1,83 @@
+/**
+ * Test cases for the in-memory cache of built programs shared between Kernel handles.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestProgramCache extends TestWithExecutor
+
+class TestProgramCache {
+
+  // the default capacity of the cache
+  private val capacity = 256
+
+  // A kernel whose source has never been built before
+  private def uniqueSource(): String =
+    s"""// ${System.nanoTime()} ${util.Random.nextLong()}
+       |kernel void inc(global float* out) {
+       |  out[get_global_id(0)] += 1.0f;
+       |}""".stripMargin
+
+  private def build(source: String): Unit = {
+    val kernel = Kernel.create(source, "inc", "")
+    try kernel.build() finally kernel.dispose()
+  }
+
+  @After
+  def restoreCapacity(): Unit =
+    Executor.setProgramCacheCapacity(capacity)
+
+  @Test
+  def kernelsWithTheSameSourceShareTheProgram(): Unit = {
+    val source = uniqueSource()
+
+    val misses = Executor.getProgramCacheMisses
+    build(source)
+    assertEquals(misses + 1, Executor.getProgramCacheMisses)
+
+    val hits = Executor.getProgramCacheHits
+    build(source)
+    assertEquals(hits + 1, Executor.getProgramCacheHits)
+    assertEquals(misses + 1, Executor.getProgramCacheMisses)
+  }
+
+  @Test
+  def purgedProgramsAreBuiltAgain(): Unit = {
+    val source = uniqueSource()
+    build(source)
+
+    Executor.purgeProgramCache()
+    val misses = Executor.getProgramCacheMisses
+    build(source)
+    assertEquals(misses + 1, Executor.getProgramCacheMisses)
+  }
+
+  @Test
+  def leastRecentlyUsedProgramIsEvicted(): Unit = {
+    Executor.purgeProgramCache()
+    Executor.setProgramCacheCapacity(2)
+    val first = uniqueSource()
+    val second = uniqueSource()
+    val third = uniqueSource()
+    build(first)
+    build(second)
+    build(first)
+    // evicts the second program, which has been used least recently
+    build(third)
+
+    val hits = Executor.getProgramCacheHits
+    build(first)
+    assertEquals(hits + 1, Executor.getProgramCacheHits)
+
+    val misses = Executor.getProgramCacheMisses
+    build(second)
+    assertEquals(misses + 1, Executor.getProgramCacheMisses)
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def negativeCapacityIsRejected(): Unit =
+    Executor.setProgramCacheCapacity(-1)
+}
@@ -0,0 +1,77 @@
+/**
+ * Test cases for uploads and downloads staged through pinned host memory.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestStagedTransfers extends TestWithExecutor
+
+class TestStagedTransfers {
+
+  private val incKernel =
+    """kernel void inc(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = in[i] + 1.0f;
+      |}""".stripMargin
+
+  // Runs incKernel on values and returns the output
+  private def inc(values: Array[Float]): Array[Float] = {
+    val kernel = Kernel.create(incKernel, "inc", "")
+    val input = GlobalArg.createInput(values)
+    val output = GlobalArg.createOutput(values.length * 4)
+    try {
+      Executor.execute(kernel, 64, 1, 1, values.length, 1, 1, Array[KernelArg](input, output))
+      output.asFloatArray()
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @After
+  def disable(): Unit =
+    Executor.disableStagedTransfers()
+
+  @Test
+  def transfersSpanningManyChunks(): Unit = {
+    Executor.enableStagedTransfers(4096, 3)
+
+    // not a multiple of the chunk size
+    val values = Array.tabulate(64 * 1024 + 64)(_.toFloat)
+    assertArrayEquals(values.map(_ + 1.0f), inc(values), 0.0f)
+    assertTrue(Executor.getLastUploadThroughput > 0.0)
+    assertTrue(Executor.getLastDownloadThroughput > 0.0)
+  }
+
+  @Test
+  def smallTransfersAreNotStaged(): Unit = {
+    Executor.enableStagedTransfers(1 << 20, 2)
+
+    val values = Array.tabulate(1024)(_.toFloat)
+    assertArrayEquals(values.map(_ + 1.0f), inc(values), 0.0f)
+  }
+
+  @Test
+  def stagingCanBeReplacedAndDisabled(): Unit = {
+    val values = Array.tabulate(16 * 1024)(_.toFloat)
+
+    Executor.enableStagedTransfers(4096, 2)
+    assertArrayEquals(values.map(_ + 1.0f), inc(values), 0.0f)
+    Executor.enableStagedTransfers(8192, 4)
+    assertArrayEquals(values.map(_ + 1.0f), inc(values), 0.0f)
+    Executor.disableStagedTransfers()
+    assertArrayEquals(values.map(_ + 1.0f), inc(values), 0.0f)
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def chunkSizeMustBePositive(): Unit =
+    Executor.enableStagedTransfers(0, 2)
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def numChunksMustBePositive(): Unit =
+    Executor.enableStagedTransfers(4096, -1)
+}
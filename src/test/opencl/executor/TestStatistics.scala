@@ -0,0 +1,83 @@
+/**
+ * Test cases for the summary statistics of benchmark runtimes.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestStatistics extends TestWithExecutor
+
+class TestStatistics {
+
+  private val delta = 1e-9
+
+  @Test
+  def outliersAreRejected(): Unit = {
+    val runtimes = Array(10.0, 10.2, 9.8, 10.1, 9.9, 10.0, 10.3, 9.7, 10.0, 50.0)
+    val stats = Executor.summarize(runtimes, 0.95, 3.5)
+
+    // all runtimes are reported, but the outlier is not summarized
+    assertArrayEquals(runtimes, stats.runtimes, 0.0)
+    assertEquals(1, stats.outliers)
+    assertEquals(10.0, stats.mean, delta)
+    assertEquals(10.0, stats.median, delta)
+    assertTrue(stats.p95 < 50.0)
+    assertFalse(stats.converged)
+  }
+
+  @Test
+  def outlierRejectionCanBeDisabled(): Unit = {
+    val runtimes = Array(10.0, 10.2, 9.8, 10.1, 9.9, 10.0, 10.3, 9.7, 10.0, 50.0)
+    val stats = Executor.summarize(runtimes, 0.95, 0.0)
+
+    assertEquals(0, stats.outliers)
+    assertEquals(14.0, stats.mean, delta)
+  }
+
+  @Test
+  def identicalRuntimesHaveNoOutliers(): Unit = {
+    // the median absolute deviation is 0
+    val stats = Executor.summarize(Array(5.0, 5.0, 5.0, 5.0, 7.0), 0.95, 3.5)
+
+    assertEquals(0, stats.outliers)
+    assertEquals(5.4, stats.mean, delta)
+  }
+
+  @Test
+  def confidenceIntervalFollowsTheStudentTDistribution(): Unit = {
+    val stats = Executor.summarize(Array(1.0, 2.0, 3.0, 4.0, 5.0), 0.95, 0.0)
+
+    assertEquals(3.0, stats.mean, delta)
+    assertEquals(math.sqrt(2.5), stats.stdDev, delta)
+    // t(0.975, 4) = 2.776
+    val halfWidth = 2.776 * math.sqrt(2.5) / math.sqrt(5.0)
+    assertEquals(3.0 - halfWidth, stats.ciLow, 0.01)
+    assertEquals(3.0 + halfWidth, stats.ciHigh, 0.01)
+  }
+
+  @Test
+  def singleRuntimeHasAnUnboundedConfidenceInterval(): Unit = {
+    val stats = Executor.summarize(Array(3.0), 0.95, 3.5)
+
+    assertEquals(3.0, stats.mean, delta)
+    assertEquals(0.0, stats.stdDev, delta)
+    assertEquals(Double.NegativeInfinity, stats.ciLow, 0.0)
+    assertEquals(Double.PositiveInfinity, stats.ciHigh, 0.0)
+  }
+
+  @Test
+  def percentilesInterpolateBetweenRanks(): Unit = {
+    val stats = Executor.summarize(Array.tabulate(21)(_.toDouble), 0.95, 0.0)
+
+    assertEquals(10.0, stats.median, delta)
+    assertEquals(1.0, stats.p5, delta)
+    assertEquals(19.0, stats.p95, delta)
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def invalidConfidenceLevel(): Unit = {
+    Executor.summarize(Array(1.0, 2.0), 1.0, 3.5)
+  }
+}
@@ -0,0 +1,102 @@
+/**
+ * Test cases for recording a timeline of host spans and device commands.
+ */
+
+package opencl.executor
+
+import java.io.File
+import java.nio.charset.StandardCharsets
+import java.nio.file.Files
+
+import org.junit.Assert._
+import org.junit._
+
+object TestTracing extends TestWithExecutor
+
+class TestTracing {
+
+  private val size = 1024
+
+  private def kernelSource(name: String): String =
+    s"""kernel void $name(const global float* restrict in, global float* out) {
+       |  int i = get_global_id(0);
+       |  out[i] = in[i] * 2.0f;
+       |}""".stripMargin
+
+  private def execute(name: String): Unit = {
+    val kernel = Kernel.create(kernelSource(name), name, "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      Executor.executeProfiled(kernel, 64, 1, 1, size, 1, 1, Array[KernelArg](input, output))
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  // Writes the trace to a temporary file and returns its contents
+  private def dump(): String = {
+    val file = File.createTempFile("executor-trace", ".json")
+    try {
+      assertTrue(Executor.dumpTrace(file.getPath))
+      new String(Files.readAllBytes(file.toPath), StandardCharsets.UTF_8)
+    } finally {
+      file.delete()
+    }
+  }
+
+  @After
+  def disable(): Unit =
+    Executor.disableTracing()
+
+  @Test
+  def hostSpansAndDeviceCommandsAreWritten(): Unit = {
+    Executor.enableTracing(1024)
+    execute("tracedKernel")
+
+    val trace = dump()
+    assertTrue(trace.startsWith("{\"traceEvents\":["))
+    assertTrue(trace.trim.endsWith("}"))
+    assertTrue(trace.contains("\"name\":\"Executor.executeProfiled\""))
+    // the kernel is drawn in the lane of the device
+    assertTrue(trace.contains("\"name\":\"tracedKernel\",\"cat\":\"kernel\",\"ph\":\"X\""))
+    assertTrue(trace.contains("\"name\":\"upload\""))
+    assertTrue(trace.contains("\"name\":\"download\""))
+  }
+
+  @Test
+  def fullRingsKeepTheLatestEvents(): Unit = {
+    Executor.enableTracing(16)
+    for (k <- 0 until 64) execute("ringKernel" + k)
+
+    val trace = dump()
+    assertTrue(trace.contains("ringKernel63"))
+    assertFalse(trace.contains("ringKernel0\""))
+  }
+
+  @Test
+  def eventsOfExitedThreadsAreReleased(): Unit = {
+    Executor.enableTracing(1024)
+    val thread = new Thread(new Runnable {
+      override def run(): Unit = execute("exitedThreadKernel")
+    })
+    thread.start()
+    thread.join()
+
+    assertFalse(dump().contains("exitedThreadKernel"))
+  }
+
+  @Test
+  def reenablingDiscardsEvents(): Unit = {
+    Executor.enableTracing(1024)
+    execute("discardedKernel")
+    Executor.enableTracing(1024)
+    assertFalse(dump().contains("discardedKernel"))
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def negativeCapacityIsRejected(): Unit =
+    Executor.enableTracing(-1)
+}
@@ -0,0 +1,107 @@
+/**
+ * Test cases for executing kernels in executor-worker processes. The path of the executor-worker
+ * executable is taken from the system property executor.worker; the tests are skipped without it.
+ */
+
+package opencl.executor
+
+import org.junit.Assert._
+import org.junit._
+
+object TestWorkerPool extends TestWithExecutor
+
+class TestWorkerPool {
+
+  private val size = 1024
+
+  private val scaleKernel =
+    """kernel void scale(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  out[i] = 3.0f * in[i];
+      |}""".stripMargin
+
+  private val slowKernel =
+    """kernel void slow(const global float* restrict in, global float* out) {
+      |  int i = get_global_id(0);
+      |  float x = in[i];
+      |  for (long k = 0; k < (1L << 40); ++k) x = x * 0.999f + 1.0f;
+      |  out[i] = x;
+      |}""".stripMargin
+
+  private def workerPath: String = {
+    val path = System.getProperty("executor.worker")
+    Assume.assumeTrue("executor.worker is not set", path != null)
+    Assume.assumeFalse("Worker processes are not supported on Windows",
+      System.getProperty("os.name").toLowerCase.contains("windows"))
+    path
+  }
+
+  // Executes source in a worker and returns the output
+  private def executeInWorker(source: String, name: String, deadline: Double): Array[Float] = {
+    val kernel = Kernel.create(source, name, "")
+    val input = GlobalArg.createInput(Array.tabulate(size)(_.toFloat))
+    val output = GlobalArg.createOutput(size * 4)
+    try {
+      Executor.executeInWorker(kernel, 64, 1, 1, size, 1, 1,
+        Array[KernelArg](input, output), deadline)
+      output.asFloatArray()
+    } finally {
+      kernel.dispose()
+      input.dispose()
+      output.dispose()
+    }
+  }
+
+  @After
+  def stop(): Unit =
+    Executor.stopWorkers()
+
+  @Test
+  def outputsAreCopiedBack(): Unit = {
+    Executor.startWorkers(workerPath, 1, 0, 0)
+    val output = executeInWorker(scaleKernel, "scale", 0.0)
+    assertArrayEquals(Array.tabulate(size)(_ * 3.0f), output, 0.0f)
+  }
+
+  @Test
+  def workerExceedingTheDeadlineIsReplaced(): Unit = {
+    Executor.startWorkers(workerPath, 1, 0, 0)
+    try {
+      executeInWorker(slowKernel, "slow", 500.0)
+      fail("the kernel must exceed the deadline")
+    } catch {
+      case _: Executor.WorkerTimeoutException =>
+    }
+    // a fresh worker takes over
+    val output = executeInWorker(scaleKernel, "scale", 0.0)
+    assertEquals(3.0f * 5.0f, output(5), 0.0f)
+  }
+
+  @Test
+  def concurrentJobsAndStopDoNotHang(): Unit = {
+    val numThreads = 4
+    Executor.startWorkers(workerPath, numThreads, 0, 0)
+
+    // workers are spawned concurrently and must not inherit each others sockets
+    val failures = new java.util.concurrent.ConcurrentLinkedQueue[Throwable]()
+    val threads = (0 until numThreads).map(_ => new Thread(new Runnable {
+      override def run(): Unit =
+        try {
+          val output = executeInWorker(scaleKernel, "scale", 60000.0)
+          assertEquals(3.0f * 7.0f, output(7), 0.0f)
+        } catch {
+          case t: Throwable => failures.add(t)
+        }
+    }))
+    threads.foreach(_.start())
+    threads.foreach(_.join())
+    assertTrue(failures.toString, failures.isEmpty)
+
+    // returns once all workers have exited
+    Executor.stopWorkers()
+  }
+
+  @Test(expected = classOf[IllegalArgumentException])
+  def negativeNumberOfWorkers(): Unit =
+    Executor.startWorkers("executor-worker", -1, 0, 0)
+}